@@ -59,6 +59,8 @@ unix:QMAKE_CXXFLAGS_WARN_ON += "-Wno-unused-parameter"
 macx:QMAKE_MAC_SDK=macosx10.12
 # define the NGL_DEBUG flag for the graphics lib
 DEFINES += NGL_DEBUG
+# define this to build the NGL_PROFILE_SCOPE timers into NGL, see CPUProfiler.h
+#DEFINES += NGL_PROFILE
 # if you install boost to /usr/local/include/ we can find it from this line
 # basically all you need to do is copy the headers from the boost source to this
 # location cp -R boost_1_49_0/boost /usr/local/include under linux use apt-get install
@@ -83,6 +85,8 @@ INCLUDEPATH +=$$BASE_DIR/include/fmt
 
 unix:LIBS += -L/usr/local/lib
 LIBS+= -lboost_system
+# the parallel helpers use std::thread
+unix:LIBS+= -lpthread
 # set the SRC_DIR so we can find the project files
 SRC_DIR = $$BASE_DIR/src
 
@@ -170,7 +174,28 @@ SOURCES += $$SRC_DIR/Vec4.cpp \
     $$SRC_DIR/AbstractVAO.cpp \
     $$SRC_DIR/MultiBufferVAO.cpp \
     $$SRC_DIR/SimpleVAO.cpp \
-    $$SRC_DIR/SimpleIndexVAO.cpp
+    $$SRC_DIR/SimpleIndexVAO.cpp \
+    $$SRC_DIR/StreamingVAO.cpp \
+    $$SRC_DIR/InstancedVAO.cpp \
+    $$SRC_DIR/DynamicAABBTree.cpp \
+    $$SRC_DIR/SpatialHashGrid.cpp \
+    $$SRC_DIR/ParticleSystem.cpp \
+    $$SRC_DIR/OcclusionCuller.cpp \
+    $$SRC_DIR/LODManager.cpp \
+    $$SRC_DIR/PagedPointBake.cpp \
+    $$SRC_DIR/CompressedPointBake.cpp \
+    $$SRC_DIR/GeometryPool.cpp \
+    $$SRC_DIR/GLState.cpp \
+    $$SRC_DIR/UniformBuffer.cpp \
+    $$SRC_DIR/ProgramBinaryCache.cpp \
+    $$SRC_DIR/ShaderPreprocessor.cpp \
+    $$SRC_DIR/StringID.cpp \
+    $$SRC_DIR/GLDispatch.cpp \
+    $$SRC_DIR/GLMock.cpp \
+    $$SRC_DIR/GPUProfiler.cpp \
+    $$SRC_DIR/CPUProfiler.cpp \
+    $$SRC_DIR/FrameStats.cpp \
+    $$SRC_DIR/ResourceTracker.cpp
 
 #exclude this from iOS
 win32|unix|macx:{
@@ -228,10 +253,33 @@ HEADERS += $$INC_DIR/Vec4.h \
     $$INC_DIR/AbstractVAO.h \
     $$INC_DIR/SimpleVAO.h \
     $$INC_DIR/SimpleIndexVAO.h \
+    $$INC_DIR/StreamingVAO.h \
+    $$INC_DIR/InstancedVAO.h \
     $$INC_DIR/MultiBufferVAO.h \
     $$INC_DIR/AbstractSerializer.h \
 		$$INC_DIR/XMLSerializer.h \
 		$$INC_DIR/NGLStream.h \
+		$$INC_DIR/DynamicAABBTree.h \
+		$$INC_DIR/SpatialHashGrid.h \
+		$$INC_DIR/ParallelFor.h \
+		$$INC_DIR/ParticleSystem.h \
+		$$INC_DIR/OcclusionCuller.h \
+		$$INC_DIR/LODManager.h \
+		$$INC_DIR/PagedPointBake.h \
+		$$INC_DIR/CompressedPointBake.h \
+		$$INC_DIR/GeometryPool.h \
+		$$INC_DIR/GLState.h \
+		$$INC_DIR/UniformHandle.h \
+		$$INC_DIR/UniformBuffer.h \
+		$$INC_DIR/ProgramBinaryCache.h \
+		$$INC_DIR/ShaderPreprocessor.h \
+		$$INC_DIR/StringID.h \
+		$$INC_DIR/GLDispatch.h \
+		$$INC_DIR/GLMock.h \
+		$$INC_DIR/GPUProfiler.h \
+		$$INC_DIR/CPUProfiler.h \
+		$$INC_DIR/FrameStats.h \
+		$$INC_DIR/ResourceTracker.h \
 		$$SRC_DIR/shaders/TextShaders.h \
 		$$SRC_DIR/shaders/ColourShaders.h \
 		$$SRC_DIR/shaders/DiffuseShaders.h \
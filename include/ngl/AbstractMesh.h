@@ -34,6 +34,7 @@
 
 namespace ngl
 {
+class GeometryPool;
 //----------------------------------------------------------------------------------------------------------------------
 /// @class Face  "include/Obj.h"
 /// @brief simple class used to encapsulate a single face of an abstract mesh file
@@ -162,6 +163,13 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   virtual void createVAO() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy the mesh into a GeometryPool so it can be batched with other meshes, the VAO is
+  /// created first if needed and the data is read back from it
+  /// @param[in] _pool the pool to add to
+  /// @returns the id of the mesh in the pool or GeometryPool::INVALID
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addToPool(GeometryPool &_pool) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief get the texture id
   /// @returns the texture id
   //----------------------------------------------------------------------------------------------------------------------
@@ -172,6 +180,12 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   Real *mapVAOVerts() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief map the VBO vertex data write only, the old contents are discarded so the whole
+  /// buffer must be written but the driver doesn't have to read back or wait for the GPU
+  /// @returns a pointer to the VBO vertex data
+  //----------------------------------------------------------------------------------------------------------------------
+  Real *mapVAOVertsWrite() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief unmap the VBO based
   //----------------------------------------------------------------------------------------------------------------------
   void unMapVAO() noexcept;
@@ -260,6 +274,12 @@ public :
 
 protected :
   friend class NCCAPointBake;
+  friend class OcclusionCuller;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief tell ResourceTracker how much memory the mesh arrays use
+  /// @param[in] _tag what the mesh is, empty keeps the current tag
+  //----------------------------------------------------------------------------------------------------------------------
+  void trackMemory(const std::string &_tag=std::string()) const;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief The number of vertices in the object
   unsigned int m_nVerts;
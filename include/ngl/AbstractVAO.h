@@ -63,6 +63,12 @@ class NGL_DLLEXPORT AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     virtual void draw()const =0;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw _instances copies of the VAO in one call, the default uses glDrawArraysInstanced
+    /// VAO's that draw differently should override this along with draw
+    /// @param _instances the number of instances to draw
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void drawInstanced(unsigned int _instances) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is used to set the data in the VAO, we have a base data type of
     /// VertexData above, but the user can extend this to create custom data types
     //----------------------------------------------------------------------------------------------------------------------
@@ -83,7 +89,7 @@ class NGL_DLLEXPORT AbstractVAO
     /// @param _normalise specifies whether fixed-point data values should be normalized (GL_TRUE) or converted directly as
     /// fixed-point values (GL_FALSE) when they are accessed.
     //----------------------------------------------------------------------------------------------------------------------
-    void setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise=false );
+    virtual void setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise=false );
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief the number of indices to draw in the array. It may be that the draw routine can overide this at another time.
     /// @param _s the number of indices to draw (from 0)
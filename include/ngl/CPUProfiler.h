@@ -0,0 +1,186 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CPUPROFILER_H_
+#define CPUPROFILER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CPUProfiler.h
+/// @brief scoped CPU timers collected per thread and written as a Chrome trace
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class CPUProfiler "include/ngl/CPUProfiler.h"
+/// @brief collects timed scopes from any number of threads. Each thread writes into its own fixed size
+/// buffer with no locking, the only lock is taken once per thread when its buffer is created. When a
+/// thread exits its buffer is handed on to the next new thread, so short lived workers such as those
+/// started by parallelFor share rows in the trace rather than each keeping a buffer. When a
+/// buffer is full further events on that thread are counted as dropped. The events can be written as
+/// Chrome trace JSON (load it in chrome://tracing) where nested scopes show as a call tree per thread.
+/// NGL's own loading, VAO creation, shader, texture, point bake and transform code is timed with
+/// NGL_PROFILE_SCOPE, which is only compiled in when NGL is built with NGL_PROFILE defined, otherwise it
+/// is nothing at all
+/// @code
+/// NGL_PROFILE_SCOPE("update");
+/// ...
+/// ngl::CPUProfiler::instance()->writeChromeTrace("trace.json");
+/// @endcode
+/// This isn't a Singleton<> as threads may still be recording when statics are destroyed
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT CPUProfiler
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of events each thread can hold before they are dropped
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t EVENTSPERTHREAD=1<<16;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a timed scope, the name must be a string literal (or otherwise outlive the profiler) and
+  /// the times are nanoseconds from when the profiler was created
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Event
+  {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the profiler
+  //----------------------------------------------------------------------------------------------------------------------
+  static CPUProfiler *instance() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the current time in nanoseconds from when the profiler was created
+  //----------------------------------------------------------------------------------------------------------------------
+  static uint64_t now() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief turn recording on or off, defaults to on
+  //----------------------------------------------------------------------------------------------------------------------
+  void setEnabled(bool _state) noexcept{m_enabled.store(_state,std::memory_order_relaxed);}
+  bool isEnabled() const noexcept{return m_enabled.load(std::memory_order_relaxed);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an event for the calling thread
+  //----------------------------------------------------------------------------------------------------------------------
+  void record(const char *_name, uint64_t _start, uint64_t _end) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief name the calling thread in the trace, by default threads are numbered in order of first use,
+  /// a name lasts until the thread exits
+  //----------------------------------------------------------------------------------------------------------------------
+  void setThreadName(const std::string &_name);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of thread buffers, threads that exited share their buffer with later threads
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getNumThreads() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy out the events recorded so far by a thread, in the order the scopes ended
+  /// @param[in] _thread the thread index, 0 to getNumThreads()-1
+  /// @param[out] o_events the events
+  //----------------------------------------------------------------------------------------------------------------------
+  void getEvents(size_t _thread, std::vector<Event> &o_events) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the total events held / dropped as buffers were full
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getNumEvents() const;
+  uint64_t getNumDropped() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write every thread's events as Chrome trace JSON
+  /// @returns false if the file can't be written
+  //----------------------------------------------------------------------------------------------------------------------
+  bool writeChromeTrace(const std::string &_fname) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief throw away all the events, no other thread must be recording while this runs
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear();
+
+private :
+  CPUProfiler()=default;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the events of one thread, only the owning thread writes and it publishes through count
+  //----------------------------------------------------------------------------------------------------------------------
+  struct ThreadBuffer
+  {
+    unsigned int id;
+    std::string name;
+    std::unique_ptr<Event[]> events;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> dropped{0};
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the calling thread's buffer, creating it on first use
+  //----------------------------------------------------------------------------------------------------------------------
+  ThreadBuffer &threadBuffer();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief put an exiting thread's buffer on the free list for the next new thread
+  //----------------------------------------------------------------------------------------------------------------------
+  void releaseBuffer(ThreadBuffer *_buffer);
+
+  std::atomic<bool> m_enabled{true};
+  mutable std::mutex m_threadsMutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+  std::vector<ThreadBuffer *> m_freeBuffers;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class CPUProfileScope "include/ngl/CPUProfiler.h"
+/// @brief records its lifetime with the CPUProfiler, normally used through NGL_PROFILE_SCOPE
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT CPUProfileScope
+{
+public :
+  explicit CPUProfileScope(const char *_name) noexcept :
+    m_name(_name),m_active(CPUProfiler::instance()->isEnabled()),m_start(m_active ? CPUProfiler::now() : 0){}
+  ~CPUProfileScope() noexcept
+  {
+    if(m_active)
+    {
+      CPUProfiler::instance()->record(m_name,m_start,CPUProfiler::now());
+    }
+  }
+  CPUProfileScope(const CPUProfileScope &)=delete;
+  CPUProfileScope & operator=(const CPUProfileScope &)=delete;
+
+private :
+  const char *m_name;
+  bool m_active;
+  uint64_t m_start;
+};
+
+} // end ngl namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief time the rest of the enclosing scope, _name must be a string literal. Only compiled in when
+/// NGL_PROFILE is defined
+//----------------------------------------------------------------------------------------------------------------------
+#if defined(NGL_PROFILE)
+  #define NGL_PROFILE_CONCAT_(A,B) A##B
+  #define NGL_PROFILE_CONCAT(A,B) NGL_PROFILE_CONCAT_(A,B)
+  #define NGL_PROFILE_SCOPE(_name) ngl::CPUProfileScope NGL_PROFILE_CONCAT(nglProfileScope,__LINE__)(_name)
+#else
+  #define NGL_PROFILE_SCOPE(_name)
+#endif
+
+#endif
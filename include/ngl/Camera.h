@@ -31,6 +31,7 @@
 
 namespace ngl
 {
+class Std140Writer;
 //----------------------------------------------------------------------------------------------------------------------
 /// @enum used to describe intercects with fustrum
 enum  class CameraIntercept : char {OUTSIDE, INTERSECT, INSIDE};
@@ -199,6 +200,22 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   Mat4  getVPMatrix()const  noexcept{return m_viewMatrix*m_projectionMatrix;}
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the per frame camera values to a std140 uniform block as
+  /// layout(std140) uniform Camera
+  /// {
+  ///   mat4 view;
+  ///   mat4 projection;
+  ///   mat4 viewProjection;
+  ///   vec4 eye;
+  /// };
+  /// @param[in] _w the writer for the block
+  //----------------------------------------------------------------------------------------------------------------------
+  void writeStd140(Std140Writer &_w) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size in bytes of the camera block
+  //----------------------------------------------------------------------------------------------------------------------
+  static size_t getStd140Size() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief get the eye position
   /// @returns the current eye pos
   //----------------------------------------------------------------------------------------------------------------------
@@ -284,6 +301,11 @@ public :
   /// @returns the result of the test (inside outside intercept)
   //----------------------------------------------------------------------------------------------------------------------
   CameraIntercept boxInFrustum(const AABB &b) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accesor to the frustum planes calculated by calculateFrustum
+  /// @returns a pointer to the 6 planes in the order top,bottom,left,right,near,far
+  //----------------------------------------------------------------------------------------------------------------------
+  const Plane * getFrustumPlanes() const noexcept{return &m_planes[0];}
 
 protected :
 
@@ -0,0 +1,180 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COMPRESSEDPOINTBAKE_H_
+#define COMPRESSEDPOINTBAKE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CompressedPointBake.h
+/// @brief quantised and delta coded point bake caches
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace ngl
+{
+class NCCAPointBake;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class CompressedPointBake "include/ngl/CompressedPointBake.h"
+/// @brief a compressed point bake format. Each frame is quantised to a fixed number of bits
+/// relative to its own bounding box, the integer positions are then predicted from the previous frame
+/// (or the previous vertex on keyframes) and the residuals are bit packed in blocks of 128 values
+/// using the smallest width that fits the block. As the prediction is done on the integers there
+/// is no drift, the only error is the quantisation error of half a step of the frame bounds.
+/// Decoding the next frame only needs the previous frame's integers so forward playback costs one frame,
+/// going back a frame subtracts the same residuals and random access decodes forward from the nearest keyframe.
+/// The whole compressed file is kept in memory.
+/// @code
+/// ngl::NCCAPointBake bake("anim.xml");
+/// ngl::CompressedPointBake::save("anim.pbc",bake);
+/// ngl::CompressedPointBake compressed("anim.pbc");
+/// const std::vector<ngl::Vec3> &verts=compressed.getFrame(frame);
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT CompressedPointBake
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of values bit packed together with one width
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr unsigned int BLOCKSIZE=128;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  //----------------------------------------------------------------------------------------------------------------------
+  CompressedPointBake() noexcept=default;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor loading a file
+  /// @param[in] _fileName the file to load
+  //----------------------------------------------------------------------------------------------------------------------
+  CompressedPointBake(const std::string &_fileName) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief load a compressed point bake file into memory
+  /// @param[in] _fileName the file to load
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  bool load(const std::string &_fileName) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief decode a frame, stepping a frame either way from the last decoded frame is cheapest
+  /// @param[in] _frame the frame index (0 to getNumFrames()-1 regardless of the start frame)
+  /// @returns the decoded vertices, valid until the next call
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<Vec3> &getFrame(unsigned int _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief decode a frame into a user buffer
+  /// @param[in] _frame the frame index
+  /// @param[out] o_verts getNumVerts() vertices to write to
+  //----------------------------------------------------------------------------------------------------------------------
+  void decodeFrame(unsigned int _frame, Vec3 *o_verts) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of frames in the file
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getNumFrames() const noexcept{return m_numFrames;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of vertices per frame
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getNumVerts() const noexcept{return m_numVerts;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the start frame of the original export
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getStartFrame() const noexcept{return m_startFrame;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of quantisation bits per component
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getBits() const noexcept{return m_bits;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the compressed data in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getCompressedSize() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size the same frames take as raw x,y,z Reals
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getRawSize() const noexcept{return static_cast<size_t>(m_numFrames)*m_numVerts*3*sizeof(Real);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief raw size / compressed size
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getCompressionRatio() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compress frames and write them to a file
+  /// @param[in] _fileName the file to write
+  /// @param[in] _frames the vertex data per frame, all frames must be the same size
+  /// @param[in] _startFrame the start frame to store in the header
+  /// @param[in] _bits quantisation bits per component (1-24)
+  /// @param[in] _keyframeInterval how often a frame is coded without reference to the previous one
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool save(const std::string &_fileName, const std::vector<std::vector<Vec3>> &_frames, unsigned int _startFrame,
+                   unsigned int _bits=16, unsigned int _keyframeInterval=32) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compress a loaded NCCAPointBake and write it to a file
+  /// @param[in] _fileName the file to write
+  /// @param[in] _bake the loaded bake data
+  /// @param[in] _bits quantisation bits per component (1-24)
+  /// @param[in] _keyframeInterval how often a frame is coded without reference to the previous one
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool save(const std::string &_fileName, NCCAPointBake &_bake, unsigned int _bits=16, unsigned int _keyframeInterval=32) noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief decode the integer positions of _frame into m_q, m_q must hold _frame-1 unless it is a keyframe
+  //----------------------------------------------------------------------------------------------------------------------
+  void decodeIntegers(unsigned int _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief step m_q back one frame by subtracting the residuals of the current frame
+  //----------------------------------------------------------------------------------------------------------------------
+  void undoIntegers() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief decode m_q to _frame taking the shortest route
+  //----------------------------------------------------------------------------------------------------------------------
+  void seek(unsigned int _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the whole file
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<char> m_data;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the offset of each frame in m_data
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint64_t> m_frameOffset;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the header values
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int m_numFrames=0;
+  unsigned int m_numVerts=0;
+  unsigned int m_startFrame=0;
+  unsigned int m_bits=16;
+  unsigned int m_keyframeInterval=32;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the integer positions of the last decoded frame, x then y then z
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_q;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the frame held in m_q, -1 if none
+  //----------------------------------------------------------------------------------------------------------------------
+  long m_decodedFrame=-1;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the dequantised frame returned by getFrame
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Vec3> m_frame;
+};
+
+} // end ngl namespace
+#endif
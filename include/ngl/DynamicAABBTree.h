@@ -0,0 +1,237 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DYNAMICAABBTREE_H_
+#define DYNAMICAABBTREE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DynamicAABBTree.h
+/// @brief a dynamic bounding volume hierarchy for scene level culling and queries
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include <vector>
+
+namespace ngl
+{
+class BBox;
+class Camera;
+class Plane;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class DynamicAABBTree "include/ngl/DynamicAABBTree.h"
+/// @brief a dynamic AABB tree (in the style of the Box2D / Bullet broadphase) used to index many moving
+/// objects in a scene. Each object is stored as a leaf with a "fat" box (the real box grown by a margin)
+/// so small movements don't need the tree to be modified, when an object leaves its fat box it is removed
+/// and re-inserted using the surface area heuristic, and the tree is kept balanced with rotations.
+/// Queries return the user data value stored with each proxy (usually an index into the users object array)
+/// @note the queries share an internal traversal stack so one tree must not be queried from several threads at once
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT DynamicAABBTree
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief value used to represent an empty link in the tree / invalid proxy
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr int NULLNODE=-1;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _margin the amount each leaf box is grown by so small movements don't touch the tree
+  /// @param[in] _displacementScale how far along the movement vector the fat box is predicted when updating
+  //----------------------------------------------------------------------------------------------------------------------
+  DynamicAABBTree(Real _margin=0.1f, Real _displacementScale=2.0f) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief insert a new object into the tree
+  /// @param[in] _min the min extent of the object
+  /// @param[in] _max the max extent of the object
+  /// @param[in] _userData value returned by the queries for this object
+  /// @returns the proxy id used to update / remove the object
+  //----------------------------------------------------------------------------------------------------------------------
+  int insert(const Vec3 &_min, const Vec3 &_max, size_t _userData) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief insert a new object into the tree using a world space BBox
+  /// @param[in] _box the bounding box of the object
+  /// @param[in] _userData value returned by the queries for this object
+  /// @returns the proxy id used to update / remove the object
+  //----------------------------------------------------------------------------------------------------------------------
+  int insert(const BBox &_box, size_t _userData) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove an object from the tree, the id may be re-used by a later insert
+  /// @param[in] _id the proxy id returned from insert
+  //----------------------------------------------------------------------------------------------------------------------
+  void remove(int _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief move an object, if the new box is still inside the fat box nothing is done
+  /// @param[in] _id the proxy id returned from insert
+  /// @param[in] _min the new min extent of the object
+  /// @param[in] _max the new max extent of the object
+  /// @param[in] _displacement the movement since the last update used to predict the fat box
+  /// @returns true if the proxy was re-inserted
+  //----------------------------------------------------------------------------------------------------------------------
+  bool update(int _id, const Vec3 &_min, const Vec3 &_max, const Vec3 &_displacement=Vec3::zero()) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief move an object driven by a transform, the local box is transformed and the world AABB
+  /// of the result is used (this is the matrix from Transformation::getMatrix())
+  /// @param[in] _id the proxy id returned from insert
+  /// @param[in] _localBox the object space bounding box
+  /// @param[in] _tx the object to world transform
+  /// @returns true if the proxy was re-inserted
+  //----------------------------------------------------------------------------------------------------------------------
+  bool update(int _id, const BBox &_localBox, const Mat4 &_tx) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all objects from the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the user data for a proxy
+  /// @param[in] _id the proxy id returned from insert
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getUserData(int _id) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the fat box stored for a proxy
+  /// @param[in] _id the proxy id returned from insert
+  /// @param[out] o_min the min extent
+  /// @param[out] o_max the max extent
+  //----------------------------------------------------------------------------------------------------------------------
+  void getFatBounds(int _id, Vec3 &o_min, Vec3 &o_max) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find all objects whose box overlaps the region
+  /// @param[in] _min the min extent of the region
+  /// @param[in] _max the max extent of the region
+  /// @param[out] o_results the user data of the objects found (appended to)
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryRegion(const Vec3 &_min, const Vec3 &_max, std::vector<size_t> &o_results) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find all objects inside or intersecting the Camera frustum, Camera::calculateFrustum must have
+  /// been called for the current view
+  /// @param[in] _cam the camera to cull against
+  /// @param[out] o_results the user data of the objects found (appended to)
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryFrustum(const Camera &_cam, std::vector<size_t> &o_results) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find all objects inside or intersecting a set of planes (normals pointing inwards)
+  /// @param[in] _planes the planes to test against
+  /// @param[in] _numPlanes the number of planes (max 32)
+  /// @param[out] o_results the user data of the objects found (appended to)
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryFrustum(const Plane *_planes, size_t _numPlanes, std::vector<size_t> &o_results) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find all objects whose box is hit by a ray
+  /// @param[in] _origin the start of the ray
+  /// @param[in] _dir the direction of the ray (doesn't need to be normalized, _maxT is in units of _dir)
+  /// @param[in] _maxT the max distance along the ray to test
+  /// @param[out] o_results the user data of the objects found (appended to)
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryRay(const Vec3 &_origin, const Vec3 &_dir, Real _maxT, std::vector<size_t> &o_results) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of objects in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_proxyCount;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the height of the tree (0 for a single leaf, -1 empty)
+  //----------------------------------------------------------------------------------------------------------------------
+  int getHeight() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief debug function to check the structure of the tree is correct
+  /// @returns true if valid
+  //----------------------------------------------------------------------------------------------------------------------
+  bool validate() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compute the world axis aligned extents of a transformed box
+  /// @param[in] _min the local min extent
+  /// @param[in] _max the local max extent
+  /// @param[in] _tx the transform to apply
+  /// @param[out] o_min the world min extent
+  /// @param[out] o_max the world max extent
+  //----------------------------------------------------------------------------------------------------------------------
+  static void transformBounds(const Vec3 &_min, const Vec3 &_max, const Mat4 &_tx, Vec3 &o_min, Vec3 &o_max) noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a node of the tree, leaves have child1 == NULLNODE, the parent field is used as the next link
+  /// when the node is in the free list
+  //----------------------------------------------------------------------------------------------------------------------
+  struct TreeNode
+  {
+    Vec3 m_min;
+    Vec3 m_max;
+    size_t m_userData=0;
+    int m_parent=NULLNODE;
+    int m_child1=NULLNODE;
+    int m_child2=NULLNODE;
+    int m_height=-1;
+    bool isLeaf() const noexcept {return m_child1==NULLNODE;}
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get a node from the free list growing the pool if needed
+  //----------------------------------------------------------------------------------------------------------------------
+  int allocateNode();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief return a node to the free list
+  //----------------------------------------------------------------------------------------------------------------------
+  void freeNode(int _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief insert an allocated leaf into the tree choosing the sibling with the SAH
+  //----------------------------------------------------------------------------------------------------------------------
+  void insertLeaf(int _leaf) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief detach a leaf from the tree (the node is not freed)
+  //----------------------------------------------------------------------------------------------------------------------
+  void removeLeaf(int _leaf) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief perform a left or right rotation if node A is imbalanced
+  /// @returns the new root of the sub tree
+  //----------------------------------------------------------------------------------------------------------------------
+  int balance(int _a) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief recursive helper for validate
+  //----------------------------------------------------------------------------------------------------------------------
+  bool validateNode(int _id) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the node pool, nodes are referenced by index so the pool can grow
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<TreeNode> m_nodes;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief traversal stack re-used by the queries to avoid allocation
+  //----------------------------------------------------------------------------------------------------------------------
+  mutable std::vector<int> m_stack;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the root node of the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  int m_root=NULLNODE;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief head of the free list
+  //----------------------------------------------------------------------------------------------------------------------
+  int m_freeList=NULLNODE;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of leaves in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_proxyCount=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the fat box margin
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_margin;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the scale applied to the displacement when predicting motion
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_displacementScale;
+};
+
+} // end ngl namespace
+#endif
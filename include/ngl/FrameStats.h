@@ -0,0 +1,137 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameStats.h
+/// @brief per frame counts of the draw and upload work NGL issues
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class FrameStats "include/ngl/FrameStats.h"
+/// @brief counts the work NGL sends to GL. The VAO draw functions add draw calls and triangles, GLState
+/// adds the vertex array binds and program switches that actually reach GL, the ShaderProgram setters and
+/// UniformHandle add the uniform uploads that aren't skipped by the shadow values, and the VAO, uniform
+/// buffer, GeometryPool and texture code add the bytes they upload. The counters are atomic so loading
+/// threads can add to them. beginFrame clears the current counts so work done between frames isn't
+/// counted, endFrame keeps them as the last frame's and adds them to the totals
+/// @code
+/// ngl::FrameStats *stats=ngl::FrameStats::instance();
+/// stats->beginFrame();
+/// draw();
+/// stats->endFrame();
+/// std::cout<<stats->getLastFrame(ngl::FrameStats::DRAWCALLS)<<" draws\n";
+/// @endcode
+/// This isn't a Singleton<> as the VAO destructors and GLState use it when the program exits
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT FrameStats
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the things counted, triangles include every instance and strips / fans are counted as the
+  /// triangles they make
+  //----------------------------------------------------------------------------------------------------------------------
+  enum Counter{DRAWCALLS=0,TRIANGLES,INSTANCES,VAOBINDS,PROGRAMSWITCHES,UNIFORMUPLOADS,BUFFERUPLOADS,BUFFERBYTES,
+               TEXTUREBYTES,NUMCOUNTERS};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the counters of a frame
+  //----------------------------------------------------------------------------------------------------------------------
+  typedef std::array<uint64_t,NUMCOUNTERS> Snapshot;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the statistics
+  //----------------------------------------------------------------------------------------------------------------------
+  static FrameStats *instance() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add to a counter
+  //----------------------------------------------------------------------------------------------------------------------
+  void add(Counter _counter, uint64_t _amount=1) noexcept
+  {
+    m_current[_counter].fetch_add(_amount,std::memory_order_relaxed);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a draw call
+  /// @param[in] _mode the primitive mode
+  /// @param[in] _count the number of vertices / indices drawn
+  /// @param[in] _instances the number of instances
+  //----------------------------------------------------------------------------------------------------------------------
+  void addDraw(GLenum _mode, size_t _count, size_t _instances=1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a buffer upload of _bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  void addBufferUpload(size_t _bytes) noexcept
+  {
+    add(BUFFERUPLOADS);
+    add(BUFFERBYTES,_bytes);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start a frame, the current counts are cleared
+  //----------------------------------------------------------------------------------------------------------------------
+  void beginFrame() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief end a frame, the current counts become the last frame's and are added to the totals
+  //----------------------------------------------------------------------------------------------------------------------
+  void endFrame() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the count so far this frame / in the last frame / over all ended frames
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t get(Counter _counter) const noexcept{return m_current[_counter].load(std::memory_order_relaxed);}
+  uint64_t getLastFrame(Counter _counter) const noexcept{return m_last[_counter];}
+  uint64_t getTotal(Counter _counter) const noexcept{return m_total[_counter];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief all the counters of the last frame / the most seen in one frame / the totals
+  //----------------------------------------------------------------------------------------------------------------------
+  const Snapshot &getLastFrame() const noexcept{return m_last;}
+  const Snapshot &getPeak() const noexcept{return m_peak;}
+  const Snapshot &getTotals() const noexcept{return m_total;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of frames ended
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getNumFrames() const noexcept{return m_frames;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the name of a counter, for printing
+  //----------------------------------------------------------------------------------------------------------------------
+  static const char *getName(Counter _counter) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the last frame, peak and average per frame of every counter through Logger
+  //----------------------------------------------------------------------------------------------------------------------
+  void report() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clear everything
+  //----------------------------------------------------------------------------------------------------------------------
+  void reset() noexcept;
+
+private :
+  FrameStats() noexcept;
+  std::array<std::atomic<uint64_t>,NUMCOUNTERS> m_current;
+  Snapshot m_last;
+  Snapshot m_peak;
+  Snapshot m_total;
+  uint64_t m_frames=0;
+};
+
+} // end ngl namespace
+#endif
@@ -0,0 +1,158 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLDISPATCH_H_
+#define GLDISPATCH_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLDispatch.h
+/// @brief a replaceable table for the GL 1.1 entry points NGL calls
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the GL 1.1 functions NGL uses. Everything newer is already called through the GLEW function
+/// pointers so can be replaced by assigning those, these are exported directly by the GL library so
+/// need a table of their own
+//----------------------------------------------------------------------------------------------------------------------
+struct GLCoreFunctions
+{
+  void (GLAPIENTRY *bindTexture)(GLenum _target, GLuint _texture);
+  void (GLAPIENTRY *blendFunc)(GLenum _src, GLenum _dst);
+  void (GLAPIENTRY *deleteTextures)(GLsizei _n, const GLuint *_textures);
+  void (GLAPIENTRY *disable)(GLenum _cap);
+  void (GLAPIENTRY *drawArrays)(GLenum _mode, GLint _first, GLsizei _count);
+  void (GLAPIENTRY *drawElements)(GLenum _mode, GLsizei _count, GLenum _type, const void *_indices);
+  void (GLAPIENTRY *enable)(GLenum _cap);
+  void (GLAPIENTRY *genTextures)(GLsizei _n, GLuint *_textures);
+  GLenum (GLAPIENTRY *getError)();
+  void (GLAPIENTRY *getIntegerv)(GLenum _name, GLint *_params);
+  const GLubyte *(GLAPIENTRY *getString)(GLenum _name);
+  void (GLAPIENTRY *pointSize)(GLfloat _size);
+  void (GLAPIENTRY *polygonMode)(GLenum _face, GLenum _mode);
+  void (GLAPIENTRY *readPixels)(GLint _x, GLint _y, GLsizei _width, GLsizei _height, GLenum _format, GLenum _type,
+                                void *_pixels);
+  void (GLAPIENTRY *texImage2D)(GLenum _target, GLint _level, GLint _internalFormat, GLsizei _width, GLsizei _height,
+                                GLint _border, GLenum _format, GLenum _type, const void *_pixels);
+  void (GLAPIENTRY *texParameteri)(GLenum _target, GLenum _name, GLint _param);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GLDispatch "include/ngl/GLDispatch.h"
+/// @brief holds the GLCoreFunctions NGL calls, by default the GL library's own. GLMock swaps this table
+/// and the GLEW pointers for its recording versions so NGL can run without a GPU
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT GLDispatch
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the table in use
+  //----------------------------------------------------------------------------------------------------------------------
+  static const GLCoreFunctions &core() noexcept{return s_core;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief replace the table
+  //----------------------------------------------------------------------------------------------------------------------
+  static void setCoreFunctions(const GLCoreFunctions &_functions) noexcept{s_core=_functions;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the GL library's functions, the default table
+  //----------------------------------------------------------------------------------------------------------------------
+  static GLCoreFunctions getGLFunctions() noexcept;
+
+private :
+  static GLCoreFunctions s_core;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief NGL's sources pull these into the ngl namespace with a using directive so their unqualified
+/// GL 1.1 calls resolve here rather than to the GL library. They aren't brought in by using namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
+namespace dispatch
+{
+  inline void glBindTexture(GLenum _target, GLuint _texture)
+  {
+    GLDispatch::core().bindTexture(_target,_texture);
+  }
+  inline void glBlendFunc(GLenum _src, GLenum _dst)
+  {
+    GLDispatch::core().blendFunc(_src,_dst);
+  }
+  inline void glDeleteTextures(GLsizei _n, const GLuint *_textures)
+  {
+    GLDispatch::core().deleteTextures(_n,_textures);
+  }
+  inline void glDisable(GLenum _cap)
+  {
+    GLDispatch::core().disable(_cap);
+  }
+  inline void glDrawArrays(GLenum _mode, GLint _first, GLsizei _count)
+  {
+    GLDispatch::core().drawArrays(_mode,_first,_count);
+  }
+  inline void glDrawElements(GLenum _mode, GLsizei _count, GLenum _type, const void *_indices)
+  {
+    GLDispatch::core().drawElements(_mode,_count,_type,_indices);
+  }
+  inline void glEnable(GLenum _cap)
+  {
+    GLDispatch::core().enable(_cap);
+  }
+  inline void glGenTextures(GLsizei _n, GLuint *_textures)
+  {
+    GLDispatch::core().genTextures(_n,_textures);
+  }
+  inline GLenum glGetError()
+  {
+    return GLDispatch::core().getError();
+  }
+  inline void glGetIntegerv(GLenum _name, GLint *_params)
+  {
+    GLDispatch::core().getIntegerv(_name,_params);
+  }
+  inline const GLubyte *glGetString(GLenum _name)
+  {
+    return GLDispatch::core().getString(_name);
+  }
+  inline void glPointSize(GLfloat _size)
+  {
+    GLDispatch::core().pointSize(_size);
+  }
+  inline void glPolygonMode(GLenum _face, GLenum _mode)
+  {
+    GLDispatch::core().polygonMode(_face,_mode);
+  }
+  inline void glReadPixels(GLint _x, GLint _y, GLsizei _width, GLsizei _height, GLenum _format, GLenum _type,
+                           void *_pixels)
+  {
+    GLDispatch::core().readPixels(_x,_y,_width,_height,_format,_type,_pixels);
+  }
+  inline void glTexImage2D(GLenum _target, GLint _level, GLint _internalFormat, GLsizei _width, GLsizei _height,
+                           GLint _border, GLenum _format, GLenum _type, const void *_pixels)
+  {
+    GLDispatch::core().texImage2D(_target,_level,_internalFormat,_width,_height,_border,_format,_type,_pixels);
+  }
+  inline void glTexParameteri(GLenum _target, GLenum _name, GLint _param)
+  {
+    GLDispatch::core().texParameteri(_target,_name,_param);
+  }
+}
+
+} // end ngl namespace
+#endif
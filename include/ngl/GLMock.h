@@ -0,0 +1,192 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMOCK_H_
+#define GLMOCK_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLMock.h
+/// @brief a CPU only GL backend that counts and records calls for headless testing
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "GLDispatch.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GLMock "include/ngl/GLMock.h"
+/// @brief install replaces the GLEW function pointers and the GLDispatch table with functions that run
+/// on the CPU, so NGL's VAO, shader and texture code runs without a context. Every call is counted, in
+/// total and for the current frame, and can be recorded. Buffers, vertex arrays, textures, shaders and
+/// programs are created and deleted for real so their lifetimes and sizes can be checked, buffer data is
+/// kept so glMapBuffer and glGetBufferSubData work. Shaders always compile and programs always link with
+/// no active uniforms, and glGetUniformLocation hands out a new location per program and name. Only one
+/// mock can be installed at a time, and it must be installed after NGLInit as glewInit resets the GLEW
+/// pointers
+/// @code
+/// ngl::GLMock mock;
+/// mock.install();
+/// ngl::VAOPrimitives::instance()->draw("teapot");
+/// mock.endFrame();
+/// assert(mock.getLastFrameCallCount("glDrawArrays")==1);
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT GLMock
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a recorded call, replay calls the same function with the same arguments through whatever is
+  /// installed at the time. Buffer and texture data are copied, calls taking any other pointer are
+  /// recorded by name only and replay is empty for them
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Call
+  {
+    const char *name;
+    std::function<void()> replay;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the kinds of object tracked
+  //----------------------------------------------------------------------------------------------------------------------
+  enum ObjectType{BUFFER=0,VERTEXARRAY,TEXTURE,SHADER,PROGRAM,NUMOBJECTTYPES};
+
+  GLMock()=default;
+  GLMock(const GLMock &)=delete;
+  GLMock & operator=(const GLMock &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor, uninstalls if installed
+  //----------------------------------------------------------------------------------------------------------------------
+  ~GLMock() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief swap in the mock functions and invalidate the GLState cache
+  /// @returns false if another mock is installed
+  //----------------------------------------------------------------------------------------------------------------------
+  bool install() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief put back the functions there were before install
+  //----------------------------------------------------------------------------------------------------------------------
+  void uninstall() noexcept;
+  bool isInstalled() const noexcept{return s_installed == this;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of calls to a function by its GL name (say "glDrawArrays") in total, in the current
+  /// frame and in the last frame ended by endFrame
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getCallCount(const std::string &_name) const noexcept;
+  uint64_t getFrameCallCount(const std::string &_name) const noexcept;
+  uint64_t getLastFrameCallCount(const std::string &_name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of draw calls of any kind, in total / the current frame / the last frame
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getNumDrawCalls() const noexcept{return m_draws;}
+  uint64_t getFrameDrawCalls() const noexcept{return m_frameDraws;}
+  uint64_t getLastFrameDrawCalls() const noexcept{return m_lastFrameDraws;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief end the current frame, its counts become the last frame's
+  //----------------------------------------------------------------------------------------------------------------------
+  void endFrame() noexcept;
+  unsigned int getFrame() const noexcept{return m_frame;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clear all the counts and the recording
+  //----------------------------------------------------------------------------------------------------------------------
+  void resetCounters() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief keep every call in getCalls
+  //----------------------------------------------------------------------------------------------------------------------
+  void setRecording(bool _state) noexcept{m_recording=_state;}
+  const std::vector<Call> &getCalls() const noexcept{return m_calls;}
+  void clearCalls() noexcept{m_calls.clear();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief replay the recorded calls in order through the functions installed now
+  //----------------------------------------------------------------------------------------------------------------------
+  void replay() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of live objects of a type
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getNumObjects(ObjectType _type) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief deletes of names that were never created (or already deleted), zero is ignored as in GL
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getNumBadDeletes() const noexcept{return m_badDeletes;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the data store of a buffer, empty if it has none or doesn't exist
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<unsigned char> &getBufferData(GLuint _buffer) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the total size of all buffers / the level 0 images of all textures in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getBufferBytes() const noexcept;
+  size_t getTextureBytes() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bytes passed to glBufferData / glBufferSubData / glTexImage2D in total
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getUploadBytes() const noexcept{return m_uploadBytes;}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the mock GL functions, defined in GLMock.cpp
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Functions;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief count a call and record it if recording
+  //----------------------------------------------------------------------------------------------------------------------
+  void called(const char *_name, std::function<void()> &&_replay);
+  bool isRecording() const noexcept{return m_recording;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief swap a GLEW pointer, remembering the old one for uninstall
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class F>
+  void hook(F &_pointer, F _function)
+  {
+    F old=_pointer;
+    m_restore.push_back([&_pointer,old](){_pointer=old;});
+    _pointer=_function;
+  }
+  static GLMock *s_installed;
+  std::vector<std::function<void()>> m_restore;
+  GLCoreFunctions m_oldCore;
+
+  std::unordered_map<std::string,uint64_t> m_counts;
+  std::unordered_map<std::string,uint64_t> m_frameCounts;
+  std::unordered_map<std::string,uint64_t> m_lastFrameCounts;
+  uint64_t m_draws=0;
+  uint64_t m_frameDraws=0;
+  uint64_t m_lastFrameDraws=0;
+  unsigned int m_frame=0;
+  bool m_recording=false;
+  std::vector<Call> m_calls;
+
+  GLuint m_nextName=1;
+  uint64_t m_badDeletes=0;
+  uint64_t m_uploadBytes=0;
+  std::unordered_map<GLuint,std::vector<unsigned char>> m_buffers;
+  std::unordered_map<GLuint,bool> m_vertexArrays;
+  std::unordered_map<GLuint,size_t> m_textures;
+  std::unordered_map<GLuint,std::string> m_shaders;
+  std::unordered_map<GLuint,std::unordered_map<std::string,GLint>> m_programs;
+  std::unordered_map<GLenum,GLuint> m_boundBuffers;
+  GLuint m_boundTextures[32]={0};
+  unsigned int m_activeTexture=0;
+};
+
+} // end ngl namespace
+#endif
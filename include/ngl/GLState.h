@@ -0,0 +1,159 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLSTATE_H_
+#define GLSTATE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLState.h
+/// @brief a cache of the bound GL objects used to skip redundant state changes
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include <array>
+#include <cstdint>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GLState "include/ngl/GLState.h"
+/// @brief tracks the current program, vertex array, array / element buffers, 2D textures per unit and
+/// the common enable flags and only calls GL when the value actually changes. ShaderLib, the VAO classes,
+/// Texture and AbstractMesh all go through here so drawing the same mesh with the same shader and texture
+/// repeatedly costs one draw call. The element buffer binding belongs to the vertex array so it is
+/// forgotten when the vertex array changes. Any code calling GL directly for the tracked state must
+/// call invalidate afterwards. The counters are kept per frame, call newFrame once a frame and read the
+/// totals of the last complete frame back with getIssued / getElided
+/// @code
+/// ngl::GLState *state=ngl::GLState::instance();
+/// state->newFrame();
+/// std::cout<<state->getElided(ngl::GLState::VERTEXARRAY)<<" vao binds skipped\n";
+/// @endcode
+/// This isn't a Singleton<> as the ShaderLib and VAO destructors use it when the program exits
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT GLState
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the types of call counted
+  //----------------------------------------------------------------------------------------------------------------------
+  enum StateCall{PROGRAM=0,VERTEXARRAY,BUFFER,TEXTURE,CAPABILITY,NUMSTATECALLS};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of texture units tracked, binds to higher units always go to GL
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr unsigned int MAXTEXTUREUNITS=32;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the state of the current context
+  //----------------------------------------------------------------------------------------------------------------------
+  static GLState *instance() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glUseProgram
+  //----------------------------------------------------------------------------------------------------------------------
+  void useProgram(GLuint _program) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glBindVertexArray
+  //----------------------------------------------------------------------------------------------------------------------
+  void bindVertexArray(GLuint _vao) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glBindBuffer, only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are cached
+  //----------------------------------------------------------------------------------------------------------------------
+  void bindBuffer(GLenum _target, GLuint _buffer) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glActiveTexture
+  /// @param[in] _unit the unit as GL_TEXTURE0+n
+  //----------------------------------------------------------------------------------------------------------------------
+  void activeTexture(GLenum _unit) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glBindTexture on the active unit, only GL_TEXTURE_2D is cached
+  //----------------------------------------------------------------------------------------------------------------------
+  void bindTexture(GLenum _target, GLuint _texture) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glEnable / glDisable, GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST,
+  /// GL_MULTISAMPLE and GL_PROGRAM_POINT_SIZE are cached
+  //----------------------------------------------------------------------------------------------------------------------
+  void enable(GLenum _cap) noexcept;
+  void disable(GLenum _cap) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the delete calls, GL resets bindings of deleted objects so these keep the cache in step
+  //----------------------------------------------------------------------------------------------------------------------
+  void deleteProgram(GLuint _program) noexcept;
+  void deleteVertexArrays(GLsizei _n, const GLuint *_vaos) noexcept;
+  void deleteBuffers(GLsizei _n, const GLuint *_buffers) noexcept;
+  void deleteTextures(GLsizei _n, const GLuint *_textures) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the cached values, UNKNOWN if not known
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr GLuint UNKNOWN=~GLuint(0);
+  GLuint getProgram() const noexcept{return m_program;}
+  GLuint getVertexArray() const noexcept{return m_vao;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief forget everything so the next call of each type goes to GL, use after calling GL directly
+  /// or after a context change
+  //----------------------------------------------------------------------------------------------------------------------
+  void invalidate() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief end the current frame's counters, the getters then return its totals
+  //----------------------------------------------------------------------------------------------------------------------
+  void newFrame() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the calls passed to GL / skipped in the last frame
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getIssued(StateCall _call) const noexcept{return m_lastIssued[_call];}
+  uint64_t getElided(StateCall _call) const noexcept{return m_lastElided[_call];}
+  uint64_t getTotalIssued() const noexcept;
+  uint64_t getTotalElided() const noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  //----------------------------------------------------------------------------------------------------------------------
+  GLState() noexcept;
+  GLState(const GLState &)=delete;
+  GLState & operator=(const GLState &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a flag
+  //----------------------------------------------------------------------------------------------------------------------
+  void setCapability(GLenum _cap, bool _state) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of enable flags tracked
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr unsigned int NUMCAPABILITIES=7;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief bound objects
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_program;
+  GLuint m_vao;
+  GLuint m_arrayBuffer;
+  GLuint m_elementBuffer;
+  GLuint m_activeUnit;
+  std::array<GLuint,MAXTEXTUREUNITS> m_textures;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief enable flags 0 off, 1 on, -1 unknown
+  //----------------------------------------------------------------------------------------------------------------------
+  std::array<int8_t,NUMCAPABILITIES> m_capabilities;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief counters for the current and last frame
+  //----------------------------------------------------------------------------------------------------------------------
+  std::array<uint64_t,NUMSTATECALLS> m_issued;
+  std::array<uint64_t,NUMSTATECALLS> m_elided;
+  std::array<uint64_t,NUMSTATECALLS> m_lastIssued;
+  std::array<uint64_t,NUMSTATECALLS> m_lastElided;
+};
+
+} // end ngl namespace
+#endif
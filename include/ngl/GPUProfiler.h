@@ -0,0 +1,233 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GPUPROFILER_H_
+#define GPUPROFILER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GPUProfiler.h
+/// @brief GPU timing of named scopes using timer queries
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "StringID.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GPUProfiler "include/ngl/GPUProfiler.h"
+/// @brief times named scopes on the GPU with a GL_TIMESTAMP query at each end, so scopes can nest. The
+/// queries come from a pool and a frame's results are read FRAMELATENCY frames later, by which time the
+/// GPU has finished with them, so reading back never stalls the pipeline. Each scope keeps rolling
+/// statistics over the last STATSWINDOW frames which can be written out through Logger with report, and
+/// the individual timings can be kept and written as a Chrome trace (chrome://tracing) with writeTrace.
+/// Under GLMock the queries all return zero so the scopes report 0 ms
+/// @code
+/// ngl::GPUProfiler *gpu=ngl::GPUProfiler::instance();
+/// gpu->beginFrame();
+/// {
+///   ngl::GPUScope scope("shadow pass");
+///   drawShadows();
+/// }
+/// gpu->endFrame();
+/// @endcode
+/// This isn't a Singleton<> as the queries must not be deleted after the context has gone at exit
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT GPUProfiler
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief how many frames later the results of a frame are read
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr unsigned int FRAMELATENCY=2;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of frames the rolling statistics cover
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr unsigned int STATSWINDOW=64;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the timing of a scope, times are in milliseconds and min / max / average are over the last
+  /// STATSWINDOW samples. Depth is the nesting level the scope was last seen at
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Stats
+  {
+    std::string name;
+    unsigned int depth=0;
+    uint64_t samples=0;
+    double lastMs=0.0;
+    double averageMs=0.0;
+    double minMs=0.0;
+    double maxMs=0.0;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the profiler for the current context
+  //----------------------------------------------------------------------------------------------------------------------
+  static GPUProfiler *instance() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if the GL has timer queries (GL 3.3 or ARB_timer_query)
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isSupported() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief turn the profiler on or off, when off begin and end do nothing. Defaults to on
+  //----------------------------------------------------------------------------------------------------------------------
+  void setEnabled(bool _state) noexcept{m_enabled=_state;}
+  bool isEnabled() const noexcept{return m_enabled;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start a frame, this reads back the results of the frame FRAMELATENCY frames ago if ready
+  //----------------------------------------------------------------------------------------------------------------------
+  void beginFrame();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief end the frame, any scopes left open are closed
+  //----------------------------------------------------------------------------------------------------------------------
+  void endFrame();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start timing a scope, only between beginFrame and endFrame
+  /// @param[in] _name the name of the scope, scopes with the same name are combined
+  /// @returns true if a timer was started and end must be called
+  //----------------------------------------------------------------------------------------------------------------------
+  bool begin(const char *_name);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief stop timing the innermost scope
+  //----------------------------------------------------------------------------------------------------------------------
+  void end();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief read back every outstanding frame now, waiting for the GPU
+  //----------------------------------------------------------------------------------------------------------------------
+  void flush();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the statistics of a scope
+  /// @returns nullptr if the scope has no results yet
+  //----------------------------------------------------------------------------------------------------------------------
+  const Stats *getStats(const std::string &_name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the statistics of every scope in the order they were first seen
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Stats> getAllStats() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the statistics of every scope through Logger
+  //----------------------------------------------------------------------------------------------------------------------
+  void report() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief keep each timing for writeTrace, up to _maxEvents of them after which the oldest are dropped
+  //----------------------------------------------------------------------------------------------------------------------
+  void setTraceCapture(bool _state, size_t _maxEvents=100000) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the captured timings as Chrome trace JSON
+  /// @returns false if the file can't be written
+  //----------------------------------------------------------------------------------------------------------------------
+  bool writeTrace(const std::string &_fname) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief throw away all the results, the trace and the queries. Outstanding frames are dropped
+  //----------------------------------------------------------------------------------------------------------------------
+  void reset();
+
+private :
+  GPUProfiler()=default;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a timed scope, begin and end are the timestamp queries
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Sample
+  {
+    StringID id;
+    unsigned int depth;
+    GLuint begin;
+    GLuint end;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the samples of a frame waiting to be read back
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Frame
+  {
+    std::vector<Sample> samples;
+    /// the last timestamp issued in the frame, nested scopes end out of sample order so this is
+    /// the one to check to know the whole frame is ready
+    GLuint lastQuery=0;
+    bool pending=false;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a scope's statistics and its window of recent times
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Scope
+  {
+    Stats stats;
+    std::array<double,STATSWINDOW> window;
+    unsigned int next=0;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a single timing kept for the trace, in nanoseconds
+  //----------------------------------------------------------------------------------------------------------------------
+  struct TraceEvent
+  {
+    StringID id;
+    uint64_t start;
+    uint64_t duration;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief read back a frame's queries into the statistics
+  /// @param[in] _wait wait for the GPU if the results aren't ready
+  /// @returns false if the results weren't ready
+  //----------------------------------------------------------------------------------------------------------------------
+  bool resolve(Frame &_frame, bool _wait);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a time to a scope's statistics
+  //----------------------------------------------------------------------------------------------------------------------
+  void addSample(const Sample &_sample, double _ms);
+  GLuint getQuery();
+
+  bool m_enabled=true;
+  bool m_inFrame=false;
+  uint64_t m_frame=0;
+  std::array<Frame,FRAMELATENCY+1> m_frames;
+  std::vector<size_t> m_open;
+  std::vector<GLuint> m_freeQueries;
+  std::vector<GLuint> m_allQueries;
+  std::unordered_map<StringID,Scope> m_scopes;
+  std::vector<StringID> m_order;
+  bool m_tracing=false;
+  size_t m_maxTraceEvents=0;
+  std::vector<TraceEvent> m_trace;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GPUScope "include/ngl/GPUProfiler.h"
+/// @brief times its lifetime with the GPUProfiler
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT GPUScope
+{
+public :
+  explicit GPUScope(const char *_name) : m_started(GPUProfiler::instance()->begin(_name)){}
+  ~GPUScope()
+  {
+    if(m_started)
+    {
+      GPUProfiler::instance()->end();
+    }
+  }
+  GPUScope(const GPUScope &)=delete;
+  GPUScope & operator=(const GPUScope &)=delete;
+
+private :
+  bool m_started;
+};
+
+} // end ngl namespace
+#endif
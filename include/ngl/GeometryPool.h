@@ -0,0 +1,241 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GEOMETRYPOOL_H_
+#define GEOMETRYPOOL_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GeometryPool.h
+/// @brief shared vertex and index buffers for many meshes drawn with multi draw indirect
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Mat4.h"
+#include <vector>
+#include <cstdint>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class RangeAllocator "include/ngl/GeometryPool.h"
+/// @brief first fit free list allocator handing out [offset,offset+size) ranges of an abstract
+/// capacity, free ranges are kept sorted and merged with their neighbours when released
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT RangeAllocator
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief returned when a range can't be allocated
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t INVALID=~size_t(0);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _capacity the initial capacity all of which is free
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit RangeAllocator(size_t _capacity=0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief allocate a range
+  /// @param[in] _size the size of the range
+  /// @returns the offset of the range or INVALID if there is no free range large enough
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t allocate(size_t _size) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief release a range returned by allocate
+  //----------------------------------------------------------------------------------------------------------------------
+  void release(size_t _offset, size_t _size) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief grow the capacity, the new space is added to the free list
+  //----------------------------------------------------------------------------------------------------------------------
+  void grow(size_t _capacity) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief reset to a single allocated range of _used at the start and the rest free
+  //----------------------------------------------------------------------------------------------------------------------
+  void reset(size_t _capacity, size_t _used) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accessors
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getCapacity() const noexcept{return m_capacity;}
+  size_t getFree() const noexcept;
+  size_t getLargestFree() const noexcept;
+  size_t getNumFreeRanges() const noexcept{return m_free.size();}
+
+private :
+  struct Range
+  {
+    size_t offset;
+    size_t size;
+  };
+  std::vector<Range> m_free;
+  size_t m_capacity;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GeometryPool "include/ngl/GeometryPool.h"
+/// @brief a pool of meshes sharing one VAO, one vertex buffer and one index buffer. Meshes are
+/// sub-allocated from the buffers with a RangeAllocator, the buffers grow by copying on the GPU when full
+/// and defragment packs the live meshes back together. A frame's draws are queued with addDraw and sent
+/// with submit as a single glMultiDrawElementsIndirect (or a loop of base vertex draws on contexts
+/// without GL 4.3 / ARB_multi_draw_indirect) so thousands of meshes cost one VAO bind.
+/// The vertex layout is the same as VAOPrimitives and AbstractMesh u,v,nx,ny,nz,x,y,z with the position
+/// at attribute 0, uv at 1 and normal at 2. Each draw can carry a transform which is fed to a mat4
+/// instance attribute (setTransformAttribute, 3 by default) so the shader looks like
+/// @code
+/// layout (location=0) in vec3 inVert;
+/// layout (location=3) in mat4 inModel;
+/// void main(){ gl_Position=VP*inModel*vec4(inVert,1.0); }
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT GeometryPool
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of Reals per vertex
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t VERTEXSIZE=8;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief returned by addMesh on failure
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t INVALID=~size_t(0);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor, no GL calls are made until the first mesh is added
+  /// @param[in] _vertexCapacity the initial number of vertices
+  /// @param[in] _indexCapacity the initial number of indices
+  //----------------------------------------------------------------------------------------------------------------------
+  GeometryPool(size_t _vertexCapacity=1<<16, size_t _indexCapacity=1<<18) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor removes the GL objects
+  //----------------------------------------------------------------------------------------------------------------------
+  ~GeometryPool() noexcept;
+  GeometryPool(const GeometryPool &)=delete;
+  GeometryPool & operator=(const GeometryPool &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an indexed triangle mesh
+  /// @param[in] _verts packed u,v,nx,ny,nz,x,y,z vertices
+  /// @param[in] _numVerts the number of vertices
+  /// @param[in] _indices triangle indices relative to the first vertex, nullptr for an un-indexed triangle list
+  /// @param[in] _numIndices the number of indices (ignored if _indices is nullptr)
+  /// @returns the id of the mesh or INVALID
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addMesh(const Real *_verts, size_t _numVerts, const GLuint *_indices, size_t _numIndices) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove a mesh, its ranges are returned to the free lists
+  //----------------------------------------------------------------------------------------------------------------------
+  void removeMesh(size_t _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief pack all the live meshes to the start of the buffers, ids stay the same
+  //----------------------------------------------------------------------------------------------------------------------
+  void defragment() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief queue a draw of a mesh
+  /// @param[in] _id the mesh to draw
+  /// @param[in] _transform the transform passed to the transform attribute
+  //----------------------------------------------------------------------------------------------------------------------
+  void addDraw(size_t _id, const Mat4 &_transform=Mat4()) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief draw everything queued with addDraw in one call and clear the queue, a shader must be active
+  //----------------------------------------------------------------------------------------------------------------------
+  void submit() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the first of the four attribute locations used for the per draw mat4
+  //----------------------------------------------------------------------------------------------------------------------
+  void setTransformAttribute(GLuint _attrib) noexcept{m_transformAttribute=_attrib;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is multi draw indirect being used
+  //----------------------------------------------------------------------------------------------------------------------
+  bool usingMultiDrawIndirect() const noexcept{return m_multiDraw;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief stats
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getNumMeshes() const noexcept{return m_numMeshes;}
+  size_t getVertexCapacity() const noexcept{return m_vertexAlloc.getCapacity();}
+  size_t getIndexCapacity() const noexcept{return m_indexAlloc.getCapacity();}
+  size_t getFreeVertices() const noexcept{return m_vertexAlloc.getFree();}
+  size_t getFreeIndices() const noexcept{return m_indexAlloc.getFree();}
+  size_t getNumVertexFreeRanges() const noexcept{return m_vertexAlloc.getNumFreeRanges();}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create the GL objects
+  //----------------------------------------------------------------------------------------------------------------------
+  void createGL() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief replace a buffer with a new one of _newSize bytes, _ranges lists {srcOffset,dstOffset,size}
+  /// byte ranges to copy across
+  //----------------------------------------------------------------------------------------------------------------------
+  void reallocate(GLuint &io_buffer, GLenum _target, size_t _newSize, const std::vector<size_t> &_ranges) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief grow the vertex or index buffer so _size more can be allocated
+  //----------------------------------------------------------------------------------------------------------------------
+  void growVertices(size_t _size) noexcept;
+  void growIndices(size_t _size) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the vertex attributes for the vertex buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  void setVertexAttributes() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief tell ResourceTracker the size of all the buffers
+  //----------------------------------------------------------------------------------------------------------------------
+  void trackMemory() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a mesh in the pool
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Mesh
+  {
+    size_t firstVertex;
+    size_t numVerts;
+    size_t firstIndex;
+    size_t numIndices;
+    bool live;
+  };
+  std::vector<Mesh> m_meshes;
+  std::vector<size_t> m_freeIDs;
+  size_t m_numMeshes=0;
+  RangeAllocator m_vertexAlloc;
+  RangeAllocator m_indexAlloc;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the layout of a glMultiDrawElementsIndirect command
+  //----------------------------------------------------------------------------------------------------------------------
+  struct DrawCommand
+  {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+  };
+  std::vector<DrawCommand> m_commands;
+  std::vector<Mat4> m_transforms;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief GL objects
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_vao=0;
+  GLuint m_vertexBuffer=0;
+  GLuint m_indexBuffer=0;
+  GLuint m_indirectBuffer=0;
+  GLuint m_transformBuffer=0;
+  size_t m_indirectSize=0;
+  size_t m_transformSize=0;
+  GLuint m_transformAttribute=3;
+  bool m_multiDraw=false;
+};
+
+} // end ngl namespace
+#endif
@@ -0,0 +1,146 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef INSTANCEDVAO_H_
+#define INSTANCEDVAO_H_
+#include "AbstractVAO.h"
+#include "Mat4.h"
+#include "Vec4.h"
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class InstancedVAO "include/InstancedVAO.h"
+/// @brief non indexed vao with one buffer of per vertex data (as SimpleVAO) plus separate per instance
+/// buffers. Each instance stream has its own buffer so matrices can be updated every frame without
+/// touching the colours or the mesh. Per instance attributes use glVertexAttribDivisor and the whole
+/// set is drawn with one glDrawArraysInstanced call. draw() still draws a single copy.
+/// @code
+/// // shader : layout(location=3) in mat4 inModel; layout(location=7) in vec4 inColour;
+/// ngl::InstancedVAO *vao=ngl::VAOPrimitives::instance()->getInstancedVAO("cube");
+/// vao->bind();
+/// vao->setInstanceMatrices(transforms,3);
+/// vao->setInstanceColours(colours,7);
+/// vao->drawInstanced(transforms.size());
+/// vao->unbind();
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT InstancedVAO : public AbstractVAO
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instance streams used by the helpers, CUSTOM and above are free for the user
+    //----------------------------------------------------------------------------------------------------------------------
+    enum InstanceStream : unsigned int {MATRIX=0,COLOUR=1,CUSTOM=2};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the max number of instance streams
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr unsigned int MAXSTREAMS=8;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief creator method for the factory
+    /// @param _mode the mode to draw with.
+    /// @returns a new AbstractVAO * object
+    //----------------------------------------------------------------------------------------------------------------------
+    static AbstractVAO *create(GLenum _mode=GL_TRIANGLES) { return new InstancedVAO(_mode); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw a single copy using glDrawArrays
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void draw() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor clears the VAO data
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual ~InstancedVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief remove the VAO and all buffers created
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void removeVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the per vertex data, if data has already been set it will be replaced
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void setData(const VertexData &_data);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the data for an instance stream, the buffer is re-used if the data fits
+    /// @param _stream the stream to set (MATRIX, COLOUR or CUSTOM+n)
+    /// @param _size the size in bytes of the data
+    /// @param _data the data to copy
+    /// @param _usage the usage hint when the buffer needs allocating
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceData(unsigned int _stream, size_t _size, const GLvoid *_data, GLenum _usage=GL_DYNAMIC_DRAW);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set a per instance attribute reading from an instance stream, the VAO must be bound
+    /// @param _stream the stream buffer to read from
+    /// @param _id the attribute location
+    /// @param _size the number of components
+    /// @param _type the data type of the components
+    /// @param _stride the step in bytes between instances
+    /// @param _dataOffset the offset of the first component in Reals (as setVertexAttributePointer)
+    /// @param _divisor the number of instances that share each value
+    /// @param _normalise normalise fixed point values
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceAttributePointer(unsigned int _stream, GLuint _id, GLint _size, GLenum _type, GLsizei _stride,
+                                     unsigned int _dataOffset, GLuint _divisor=1, bool _normalise=false);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set one matrix per instance in the MATRIX stream, the mat4 uses attributes _firstAttrib to _firstAttrib+3
+    /// this also sets the number of instances
+    /// @param _matrices the instance transforms
+    /// @param _firstAttrib the location of the mat4 attribute
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceMatrices(const std::vector<Mat4> &_matrices, GLuint _firstAttrib);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set one colour per instance in the COLOUR stream
+    /// @param _colours the instance colours
+    /// @param _attrib the location of the vec4 attribute
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceColours(const std::vector<Vec4> &_colours, GLuint _attrib);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of instances, set by setInstanceMatrices for use as drawInstanced(getNumInstances())
+    //----------------------------------------------------------------------------------------------------------------------
+    void setNumInstances(unsigned int _n){m_numInstances=_n;}
+    unsigned int getNumInstances() const {return m_numInstances;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief return the id of a buffer, 0 is the vertex buffer 1 onwards are the instance streams
+    /// @param _buffer the buffer index
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual GLuint getBufferID(unsigned int _buffer=0);
+  protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor calles parent ctor to allocate vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    InstancedVAO(GLenum _mode)  : AbstractVAO(_mode)
+    {
+    }
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the id of the per vertex buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_buffer=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instance stream buffers and their allocated sizes
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_instanceBuffers[MAXSTREAMS]={0,0,0,0,0,0,0,0};
+    size_t m_instanceSize[MAXSTREAMS]={0,0,0,0,0,0,0,0};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of instances set by the helpers
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_numInstances=0;
+};
+
+} // end namespace
+#endif
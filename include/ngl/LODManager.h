@@ -0,0 +1,138 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LODMANAGER_H_
+#define LODMANAGER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file LODManager.h
+/// @brief level of detail selection from projected screen space error
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include <vector>
+
+namespace ngl
+{
+class Camera;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class LODManager "include/ngl/LODManager.h"
+/// @brief picks a level of detail for many objects each frame. Each LOD group describes a set of meshes,
+/// level 0 being the most detailed, by the geometric error (in object units) of each level. Objects are
+/// bounding spheres that use a group, the error of each level is projected onto the screen using the
+/// camera and the coarsest level whose error is below the allowed pixel error is chosen.
+/// To stop objects popping back and forth at a switch distance a level only gets coarser once the
+/// camera is past the switch distance by the hysteresis fraction, and only gets finer once it is
+/// closer by the same fraction.
+/// The switch distances are worked out once per group per frame so the per object work is a distance
+/// and a few compares over SoA arrays, this is vectorised and split over all cores.
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT LODManager
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the max number of levels in a group
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr int MAXLODS=8;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _pixelError the max allowed projected error in pixels
+  /// @param[in] _hysteresis the fraction of the switch distance to wait before changing level
+  //----------------------------------------------------------------------------------------------------------------------
+  LODManager(Real _pixelError=1.0f, Real _hysteresis=0.1f) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a group of levels
+  /// @param[in] _errors the geometric error of each level, finest first, must not decrease and
+  /// only the first MAXLODS are used
+  /// @returns the id of the group to pass to addObject
+  //----------------------------------------------------------------------------------------------------------------------
+  int addLODGroup(const std::vector<Real> &_errors);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an object, it starts at level 0
+  /// @param[in] _center the center of the bounding sphere
+  /// @param[in] _radius the radius of the bounding sphere
+  /// @param[in] _group the LOD group used by the object
+  /// @returns the id of the object
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addObject(const Vec3 &_center, Real _radius, int _group);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief move an object
+  /// @param[in] _id the object
+  /// @param[in] _center the new center
+  //----------------------------------------------------------------------------------------------------------------------
+  void setObjectPosition(size_t _id, const Vec3 &_center) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief choose the level for every object
+  /// @param[in] _cam the camera, the eye, FOV and near plane are used
+  /// @param[in] _viewportHeight the height of the viewport in pixels
+  //----------------------------------------------------------------------------------------------------------------------
+  void update(const Camera &_cam, int _viewportHeight);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the level chosen for an object by the last update
+  /// @param[in] _id the object
+  //----------------------------------------------------------------------------------------------------------------------
+  int getLOD(size_t _id) const noexcept{return m_lod[_id];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the level of every object in id order
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<int> &getLODs() const noexcept{return m_lod;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the max allowed projected error in pixels
+  //----------------------------------------------------------------------------------------------------------------------
+  void setPixelError(Real _pixelError) noexcept{m_pixelError=_pixelError;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the hysteresis as a fraction of the switch distance (0 none)
+  //----------------------------------------------------------------------------------------------------------------------
+  void setHysteresis(Real _hysteresis) noexcept{m_hysteresis=_hysteresis;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of objects
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_lod.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all the objects and groups
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the allowed pixel error and hysteresis
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_pixelError;
+  Real m_hysteresis;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief MAXLODS errors per group, unused levels are set to infinity so they are never chosen
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_groupError;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief MAXLODS switch distances per group worked out each update
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_switchDistance;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the object data in SoA form
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_x;
+  std::vector<Real> m_y;
+  std::vector<Real> m_z;
+  std::vector<Real> m_radius;
+  std::vector<int> m_group;
+  std::vector<int> m_lod;
+};
+
+} // end ngl namespace
+#endif
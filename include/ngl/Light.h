@@ -24,11 +24,14 @@
 #include "Vec4.h"
 #include "Vec3.h"
 #include "Mat4.h"
+#include "UniformHandle.h"
 #include <string>
 
 
 namespace ngl
 {
+class ShaderProgram;
+class Std140Writer;
 //----------------------------------------------------------------------------------------------------------------------
 ///  @enum LIGHTMODES used to flag if a light is local or remote to the scene
 ///
@@ -163,11 +166,59 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   void loadToShader(std::string _uniformName )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the uniform handles for a light struct in a shader
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Uniforms
+  {
+    UniformHandle<Vec4> position;
+    UniformHandle<Colour> ambient;
+    UniformHandle<Colour> diffuse;
+    UniformHandle<Colour> specular;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief resolve the handles for a light struct in the current shader
+  /// @param[in] _uniformName name of the struct uniform
+  //----------------------------------------------------------------------------------------------------------------------
+  static Uniforms getUniforms(const std::string &_uniformName) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief load the current light values using handles resolved with getUniforms
+  /// @param[in] _uniforms the handles for the active shader
+  //----------------------------------------------------------------------------------------------------------------------
+  void loadToShader(const Uniforms &_uniforms)const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the light to a std140 uniform block, Light and SpotLight share the layout
+  /// struct Light
+  /// {
+  ///   vec4 position;
+  ///   vec4 ambient;
+  ///   vec4 diffuse;
+  ///   vec4 specular;
+  ///   vec4 direction;
+  ///   float spotCosCutoff;
+  ///   float spotCosInnerCutoff;
+  ///   float spotExponent;
+  ///   float constantAttenuation;
+  ///   float linearAttenuation;
+  ///   float quadraticAttenuation;
+  /// };
+  /// call it for each light in turn to fill an array of lights
+  /// @param[in] _w the writer for the block
+  //----------------------------------------------------------------------------------------------------------------------
+  virtual void writeStd140(Std140Writer &_w) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size in bytes of one light in a std140 block
+  //----------------------------------------------------------------------------------------------------------------------
+  static size_t getStd140Size() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief set a transform so that the light position is multiplied by this value (default is identity matrix)
   /// @param[in] _t the transform matrix
   //----------------------------------------------------------------------------------------------------------------------
   void setTransform( Mat4 &_t ) noexcept;
 protected :
+   //----------------------------------------------------------------------------------------------------------------------
+   /// @brief write the shared std140 light struct with the spot values given
+   //----------------------------------------------------------------------------------------------------------------------
+   void writeStd140Light(Std140Writer &_w, const Vec4 &_dir, Real _innerCutoff, Real _exponent) const noexcept;
    //----------------------------------------------------------------------------------------------------------------------
    /// @brief m_pos is used to store the light position w used for point / dir light values
    //----------------------------------------------------------------------------------------------------------------------
@@ -215,6 +266,12 @@ protected :
    /// is left for the Application to calculate and pass for easier implementation of different light models
    //----------------------------------------------------------------------------------------------------------------------
    Mat4 m_transform;
+   //----------------------------------------------------------------------------------------------------------------------
+   /// @brief the handles used by loadToShader(name), resolved again if the program or name changes
+   //----------------------------------------------------------------------------------------------------------------------
+   mutable const ShaderProgram *m_uniformProgram=nullptr;
+   mutable std::string m_uniformName;
+   mutable Uniforms m_uniforms;
 
 
 private:
@@ -36,6 +36,7 @@
 
 namespace ngl
 {
+class Std140Writer;
 //----------------------------------------------------------------------------------------------------------------------
 /// @class Material "include/Material.h"
 /// @brief a simple OpenGL material class and set the parameters
@@ -180,6 +181,25 @@ public :
   /// @param[in] _uniformName
   //----------------------------------------------------------------------------------------------------------------------
   void loadToShader( std::string _uniformName )const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the material to a std140 uniform block as
+  /// struct Material
+  /// {
+  ///  vec4 ambient;
+  ///  vec4 diffuse;
+  ///  vec4 specular;
+  ///  float shininess;
+  ///  float transparency;
+  ///  float roughness;
+  /// };
+  /// a table of materials is a UniformBuffer with one block per material bound per draw
+  /// @param[in] _w the writer for the block
+  //----------------------------------------------------------------------------------------------------------------------
+  void writeStd140(Std140Writer &_w) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size in bytes of a material in a std140 block
+  //----------------------------------------------------------------------------------------------------------------------
+  static size_t getStd140Size() noexcept;
 
 protected :
   //----------------------------------------------------------------------------------------------------------------------
@@ -107,6 +107,18 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   void setMeshToFrame( const unsigned int _frame) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  set the attached mesh to a fractional frame, the positions are linearly interpolated
+  /// between the two nearest frames
+  /// @param[in] _frame the frame to set the mesh to
+  //----------------------------------------------------------------------------------------------------------------------
+  void setMeshToSubFrame( Real _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  if set the vertex normals are rebuilt from the animated positions each time the mesh
+  /// is updated otherwise the normals from the mesh are used
+  /// @param[in] _state true to recompute normals
+  //----------------------------------------------------------------------------------------------------------------------
+  void setRecomputeNormals(bool _state) noexcept{m_recomputeNormals=_state;}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  return the number of Frames loaded from the PointBake file
   /// @returns the number of frames
   //----------------------------------------------------------------------------------------------------------------------
@@ -117,6 +129,11 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   unsigned int getNumVerts() const  noexcept{return m_nVerts;}
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  return the start frame from the PointBake file
+  /// @returns the start frame
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getStartFrame() const  noexcept{return m_startFrame;}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  get a Raw data pointer to the un-sorted PointBake data
   /// @returns a pointer to the data
   //----------------------------------------------------------------------------------------------------------------------
@@ -136,6 +153,21 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
     void reorderVerts() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief parse the vertex data of one xml Frame element into m_data, called from many threads at once
+  /// @param[in] _begin the start of the Frame element
+  /// @param[in] _end the end of the Frame element
+  /// @param[in] _frame the index into m_data, each frame is parsed by only one thread
+  /// @returns false if the frame is badly formed
+  //----------------------------------------------------------------------------------------------------------------------
+  bool parseFrame(const char *_begin, const char *_end, unsigned int _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the attached mesh's VBO with the positions lerped between two frames
+  /// @param[in] _a the first frame
+  /// @param[in] _b the second frame
+  /// @param[in] _t the interpolation value 0 is all _a
+  //----------------------------------------------------------------------------------------------------------------------
+  void updateMesh(unsigned int _a, unsigned int _b, Real _t) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief the number of frames in the clip file
   //----------------------------------------------------------------------------------------------------------------------
   unsigned int m_numFrames;
@@ -169,6 +201,32 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   AbstractMesh *m_mesh;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the vertex index for each corner of the mesh VBO built by attachMesh
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_cornerVert;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the mesh's uv (2 per corner) and normal (3 per corner) values so the VBO can be
+  /// rewritten without reading it back
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_cornerUV;
+  std::vector<Real> m_cornerNormal;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the faces using each vertex (m_vertFaces[m_vertFaceStart[v]] to m_vertFaces[m_vertFaceStart[v+1]])
+  /// used to gather the vertex normals
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_vertFaceStart;
+  std::vector<uint32_t> m_vertFaces;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scratch space for interpolated positions and recomputed normals
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Vec3> m_framePos;
+  std::vector<Vec3> m_faceNormal;
+  std::vector<Vec3> m_vertNormal;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief flag to indicate normals should be rebuilt on update
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_recomputeNormals;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief flag to indicate if we have a binary or xml based file loaded
   //----------------------------------------------------------------------------------------------------------------------
   bool m_binFile;
@@ -41,6 +41,8 @@ namespace ngl
 constexpr auto simpleVAO="simpleVAO";
 constexpr auto multiBufferVAO="multiBufferVAO";
 constexpr auto simpleIndexVAO="simpleIndexVAO";
+constexpr auto streamingVAO="streamingVAO";
+constexpr auto instancedVAO="instancedVAO";
 
 class   NGL_DLLEXPORT NGLInit : public  Singleton<NGLInit>
 {
@@ -0,0 +1,230 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OCCLUSIONCULLER_H_
+#define OCCLUSIONCULLER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OcclusionCuller.h
+/// @brief CPU occlusion culling using a low resolution software depth buffer
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include "Vec4.h"
+#include <vector>
+#include <cstdint>
+
+namespace ngl
+{
+class BBox;
+class AbstractMesh;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class OcclusionCuller "include/ngl/OcclusionCuller.h"
+/// @brief a software occlusion culler, a few large occluders (walls, floors, low LOD versions of big meshes)
+/// are rasterised on the CPU into a small depth buffer and then the bounding boxes of objects are tested
+/// against it, anything completely behind the occluders can be skipped before it is sent to the GPU.
+/// The depth buffer is stored in 8x8 pixel tiles with the farthest depth of each tile kept as a
+/// hierarchical level, most tests are resolved at the tile level and the rasteriser skips tiles the
+/// triangle can't improve. The rows of a tile are fixed width loops with no branches so the compiler
+/// vectorises them and both the rasterisation (by bands of tiles) and the box tests run over all cores.
+/// No GL calls are made so this can be used and tested without a context. A frame looks like
+/// @code
+/// culler.clear();
+/// culler.setViewProjection(cam.getVPMatrix());
+/// culler.addOccluder(wallMesh,wallTx);
+/// culler.rasterise();
+/// if(culler.isVisible(box,tx)) draw();
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT OcclusionCuller
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the width and height of the depth buffer tiles
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr int TILESIZE=8;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _width the width of the depth buffer (rounded up to a multiple of TILESIZE)
+  /// @param[in] _height the height of the depth buffer (rounded up to a multiple of TILESIZE)
+  //----------------------------------------------------------------------------------------------------------------------
+  OcclusionCuller(int _width=320, int _height=192);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief change the size of the depth buffer, this clears it
+  /// @param[in] _width the width of the depth buffer (rounded up to a multiple of TILESIZE)
+  /// @param[in] _height the height of the depth buffer (rounded up to a multiple of TILESIZE)
+  //----------------------------------------------------------------------------------------------------------------------
+  void resize(int _width, int _height);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the view projection matrix used for both the occluders and occludees, usually Camera::getVPMatrix
+  /// @param[in] _vp the view * projection matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  void setViewProjection(const Mat4 &_vp) noexcept{m_viewProject=_vp;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief reset the depth buffer to the far plane and remove all the occluders
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an indexed triangle list occluder, the triangles are transformed and set up ready for rasterise
+  /// @param[in] _verts the vertices
+  /// @param[in] _indices the triangle indices (3 per triangle)
+  /// @param[in] _numIndices the number of indices
+  /// @param[in] _tx the model transform for the occluder
+  //----------------------------------------------------------------------------------------------------------------------
+  void addOccluder(const Vec3 *_verts, const uint32_t *_indices, size_t _numIndices, const Mat4 &_tx);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an indexed triangle list occluder
+  /// @param[in] _verts the vertices
+  /// @param[in] _indices the triangle indices (3 per triangle)
+  /// @param[in] _tx the model transform for the occluder
+  //----------------------------------------------------------------------------------------------------------------------
+  void addOccluder(const std::vector<Vec3> &_verts, const std::vector<uint32_t> &_indices, const Mat4 &_tx)
+  {
+    addOccluder(_verts.data(),_indices.data(),_indices.size(),_tx);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a mesh as an occluder, polygon faces are fanned into triangles. Use a low poly version of the
+  /// mesh that sits inside the real one so the culling stays conservative
+  /// @param[in] _mesh the mesh
+  /// @param[in] _tx the model transform for the occluder
+  //----------------------------------------------------------------------------------------------------------------------
+  void addOccluder(const AbstractMesh &_mesh, const Mat4 &_tx);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rasterise all the added occluders into the depth buffer and build the tile depths,
+  /// this must be called before any of the visibility tests
+  //----------------------------------------------------------------------------------------------------------------------
+  void rasterise();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test a world space box against the depth buffer, safe to call from many threads
+  /// @param[in] _min the min corner of the box
+  /// @param[in] _max the max corner of the box
+  /// @returns false if the box is hidden by the occluders or off screen, true otherwise
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isVisible(const Vec3 &_min, const Vec3 &_max) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test a world space BBox against the depth buffer
+  /// @param[in] _box the box to test
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isVisible(const BBox &_box) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test a local space BBox transformed by _tx, the corners are projected directly so this
+  /// is tighter than testing the world space box around the transformed object
+  /// @param[in] _box the box to test
+  /// @param[in] _tx the model transform of the box
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isVisible(const BBox &_box, const Mat4 &_tx) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test a batch of world space boxes split over all the cores
+  /// @param[in] _min the min corner of each box
+  /// @param[in] _max the max corner of each box
+  /// @param[in] _size the number of boxes
+  /// @param[out] o_visible set to 1 for each visible box and 0 for each hidden one
+  //----------------------------------------------------------------------------------------------------------------------
+  void testVisibility(const Vec3 *_min, const Vec3 *_max, size_t _size, std::vector<uint8_t> &o_visible) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the depth (NDC z -1 near to 1 far) stored at a pixel, y is 0 at the bottom
+  /// @param[in] _x the pixel x
+  /// @param[in] _y the pixel y
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getDepth(int _x, int _y) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy the depth buffer out as a linear width*height array (useful for debug display)
+  /// @param[out] o_depth the depth values
+  //----------------------------------------------------------------------------------------------------------------------
+  void getDepthBuffer(std::vector<Real> &o_depth) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the width of the depth buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  int width() const noexcept{return m_width;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the height of the depth buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  int height() const noexcept{return m_height;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of occluder triangles waiting to be (or that were) rasterised after clipping
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getNumTriangles() const noexcept{return m_triangles.size();}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a screen space triangle ready to rasterise, each edge is E(x,y)=a*x+b*y+c which is >=0 inside
+  /// and depth is the plane z=za*x+zb*y+zc
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Triangle
+  {
+    Real ea[3];
+    Real eb[3];
+    Real ec[3];
+    Real za;
+    Real zb;
+    Real zc;
+    Real zMin;
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clip a clip space triangle against the near plane and set up the resulting triangles
+  //----------------------------------------------------------------------------------------------------------------------
+  void addClipTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set up a triangle with all its vertices in front of the near plane
+  //----------------------------------------------------------------------------------------------------------------------
+  void setupTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rasterise every triangle that touches the tile rows [_tileY0,_tileY1)
+  //----------------------------------------------------------------------------------------------------------------------
+  void rasteriseBand(int _tileY0, int _tileY1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test 8 clip space corners against the depth buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  bool testCorners(const Vec4 *_corners) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief project a box by _mvp and test it
+  //----------------------------------------------------------------------------------------------------------------------
+  bool testBox(const Vec3 &_min, const Vec3 &_max, const Mat4 &_mvp) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the buffer in pixels and tiles
+  //----------------------------------------------------------------------------------------------------------------------
+  int m_width;
+  int m_height;
+  int m_tilesX;
+  int m_tilesY;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the depth buffer stored tile by tile, each tile is TILESIZE*TILESIZE contiguous values
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_depth;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the farthest depth in each tile
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_tileMax;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the set up occluder triangles
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Triangle> m_triangles;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the view project matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 m_viewProject;
+};
+
+} // end ngl namespace
+#endif
@@ -0,0 +1,185 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PAGEDPOINTBAKE_H_
+#define PAGEDPOINTBAKE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PagedPointBake.h
+/// @brief memory mapped point bake playback with a bounded number of resident frames
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace ngl
+{
+class NCCAPointBake;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class PagedPointBake "include/ngl/PagedPointBake.h"
+/// @brief plays back a version 2 binary point bake straight from a memory mapped file so caches
+/// larger than RAM can be used. In the v2 layout every frame is a contiguous block of x,y,z Reals
+/// starting on a 16k boundary so frames can be paged in and out on their own.
+/// Only a fixed budget of frames is kept resident, when the budget is exceeded the least recently used
+/// frame is dropped back to the OS. A background thread pages in the next few frames in the
+/// direction playback is moving so scrubbing forwards or backwards doesn't stall on disk.
+/// The whole file stays mapped so pointers returned by getFrame are always valid while the file is open,
+/// eviction only means the data will be read from disk again when next touched.
+/// @code
+/// ngl::NCCAPointBake bake("anim.xml");
+/// ngl::PagedPointBake::save("anim.pb2",bake);
+/// ngl::PagedPointBake paged(32,4);
+/// paged.open("anim.pb2");
+/// const ngl::Vec3 *verts=paged.getFrame(frame);
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT PagedPointBake
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _residentFrames the max number of frames to keep in memory
+  /// @param[in] _prefetchFrames the number of frames to read ahead of playback
+  //----------------------------------------------------------------------------------------------------------------------
+  PagedPointBake(unsigned int _residentFrames=32, unsigned int _prefetchFrames=4) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor closes the file
+  //----------------------------------------------------------------------------------------------------------------------
+  ~PagedPointBake() noexcept;
+  PagedPointBake(const PagedPointBake &)=delete;
+  PagedPointBake & operator=(const PagedPointBake &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief map a v2 point bake file and start the prefetch thread
+  /// @param[in] _fileName the file to open
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  bool open(const std::string &_fileName) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief stop the prefetch thread and unmap the file
+  //----------------------------------------------------------------------------------------------------------------------
+  void close() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is a file open
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isOpen() const noexcept{return m_data!=nullptr;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the vertices for a frame, this marks the frame as used and triggers prefetch
+  /// @param[in] _frame the frame index (0 to getNumFrames()-1 regardless of the start frame)
+  /// @returns a pointer to getNumVerts() vertices
+  //----------------------------------------------------------------------------------------------------------------------
+  const Vec3 *getFrame(unsigned int _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of frames in the file
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getNumFrames() const noexcept{return m_numFrames;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of vertices per frame
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getNumVerts() const noexcept{return m_numVerts;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the start frame of the original export
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getStartFrame() const noexcept{return m_startFrame;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the resident frame budget (at least 1)
+  //----------------------------------------------------------------------------------------------------------------------
+  void setResidentFrames(unsigned int _frames) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the number of frames to prefetch, 0 disables prefetch
+  //----------------------------------------------------------------------------------------------------------------------
+  void setPrefetchFrames(unsigned int _frames) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of frames currently counted as resident
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getNumResidentFrames() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write frames in the v2 layout
+  /// @param[in] _fileName the file to write
+  /// @param[in] _frames the vertex data per frame, all frames must be the same size
+  /// @param[in] _startFrame the start frame to store in the header
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool save(const std::string &_fileName, const std::vector<std::vector<Vec3>> &_frames, unsigned int _startFrame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write a loaded NCCAPointBake in the v2 layout
+  /// @param[in] _fileName the file to write
+  /// @param[in] _bake the loaded bake data
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool save(const std::string &_fileName, NCCAPointBake &_bake) noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the start of a frame in the mapping
+  //----------------------------------------------------------------------------------------------------------------------
+  const char *frameData(unsigned int _frame) const noexcept{return m_data+m_dataOffset+_frame*m_frameStride;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief count a frame as resident evicting the least recently used frames over budget, m_mutex must be held
+  //----------------------------------------------------------------------------------------------------------------------
+  void makeResident(unsigned int _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the prefetch thread function
+  //----------------------------------------------------------------------------------------------------------------------
+  void prefetchLoop() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the file mapping
+  //----------------------------------------------------------------------------------------------------------------------
+  const char *m_data=nullptr;
+  size_t m_mappedSize=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the header values
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int m_numFrames=0;
+  unsigned int m_numVerts=0;
+  unsigned int m_startFrame=0;
+  size_t m_frameStride=0;
+  size_t m_dataOffset=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief residency and LRU state, 0 is not resident otherwise the use stamp
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint64_t> m_lastUse;
+  uint64_t m_useCounter=0;
+  unsigned int m_numResident=0;
+  unsigned int m_residentBudget;
+  unsigned int m_prefetchFrames;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the frame last returned by getFrame, never evicted
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int m_currentFrame=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief playback direction +1 or -1
+  //----------------------------------------------------------------------------------------------------------------------
+  int m_direction=1;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief prefetch thread and its work queue
+  //----------------------------------------------------------------------------------------------------------------------
+  std::thread m_prefetchThread;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::vector<unsigned int> m_prefetchQueue;
+  bool m_quit=false;
+};
+
+} // end ngl namespace
+#endif
@@ -0,0 +1,100 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PARALLELFOR_H_
+#define PARALLELFOR_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ParallelFor.h
+/// @brief simple std::thread based helpers to split loops over the available cores
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the number of threads the helpers will use (at least 1)
+//----------------------------------------------------------------------------------------------------------------------
+inline unsigned int numWorkerThreads() noexcept
+{
+  unsigned int n=std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief split the range [_begin,_end) into _numChunks contiguous blocks and run them in parallel,
+/// the calling thread runs the first block. The function is called as _func(chunk,begin,end) so
+/// per chunk storage (for example histograms) can be indexed by chunk.
+/// @param[in] _begin the start of the range
+/// @param[in] _end one past the end of the range
+/// @param[in] _numChunks the number of blocks to split into (clamped to the size of the range)
+/// @param[in] _func the function to call for each block
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Func>
+void parallelForChunks(size_t _begin, size_t _end, size_t _numChunks, const Func &_func)
+{
+  if(_end <= _begin)
+  {
+    return;
+  }
+  size_t size=_end-_begin;
+  _numChunks=std::max<size_t>(1,std::min(_numChunks,size));
+  size_t chunkSize=(size+_numChunks-1)/_numChunks;
+  std::vector<std::thread> threads;
+  threads.reserve(_numChunks);
+  for(size_t c=1; c<_numChunks; ++c)
+  {
+    size_t b=_begin+c*chunkSize;
+    size_t e=std::min(_end,b+chunkSize);
+    if(b >= e)
+    {
+      break;
+    }
+    threads.emplace_back([&_func,c,b,e](){ _func(c,b,e); });
+  }
+  _func(size_t(0),_begin,std::min(_end,_begin+chunkSize));
+  for(auto &t : threads)
+  {
+    t.join();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief run _func(begin,end) over sub ranges of [_begin,_end) using all cores, small ranges
+/// (less than _grainSize per thread) are run on fewer threads to avoid the thread start up cost.
+/// @param[in] _begin the start of the range
+/// @param[in] _end one past the end of the range
+/// @param[in] _func the function to call for each sub range
+/// @param[in] _grainSize the minimum number of elements worth giving to a thread
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Func>
+void parallelFor(size_t _begin, size_t _end, const Func &_func, size_t _grainSize=4096)
+{
+  if(_end <= _begin)
+  {
+    return;
+  }
+  size_t chunks=std::min<size_t>(numWorkerThreads(),(_end-_begin+_grainSize-1)/_grainSize);
+  parallelForChunks(_begin,_end,chunks,[&_func](size_t ,size_t _b,size_t _e){ _func(_b,_e); });
+}
+
+} // end ngl namespace
+#endif
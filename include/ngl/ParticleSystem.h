@@ -0,0 +1,189 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ParticleSystem.h
+/// @brief a simple SoA particle system drawn with a single instanced draw call
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include <vector>
+#include <string>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ParticleSystem "include/ngl/ParticleSystem.h"
+/// @brief a particle system storing the particles as structure of arrays (one array per component) so the
+/// update loops vectorise, the update is also split across all cores. The storage is allocated once for the
+/// max number of particles and dead particles are compacted in place by moving the last live particle into
+/// the gap so no allocation happens after construction.
+/// Particles are drawn as instances of one of the VAOPrimitives meshes with a single glDrawArraysInstanced call,
+/// the per instance data is a vec4 of the position in xyz and the normalised age (0 born 1 dead) in w, bound
+/// to the generic attribute set by setInstanceAttribute (3 by default) so the shader will look like
+/// @code
+/// layout (location=0) in vec3 inVert;
+/// layout (location=3) in vec4 inParticle;
+/// void main(){ gl_Position=MVP*vec4(inVert*scale+inParticle.xyz,1.0); }
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT ParticleSystem
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor allocates storage for all the particles, no GL calls are made until draw
+  /// @param[in] _maxParticles the max number of live particles
+  /// @param[in] _emitterPos the position particles are born at
+  //----------------------------------------------------------------------------------------------------------------------
+  ParticleSystem(size_t _maxParticles, const Vec3 &_emitterPos=Vec3::zero());
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor removes the instance buffer if created
+  //----------------------------------------------------------------------------------------------------------------------
+  ~ParticleSystem();
+  ParticleSystem(const ParticleSystem &)=delete;
+  ParticleSystem & operator=(const ParticleSystem &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief spawn new particles at the emitter, the random values are seeded from ngl::Random so
+  /// Random::setSeed gives repeatable results
+  /// @param[in] _count the number to emit (clamped to the free space)
+  /// @returns the number of particles actually emitted
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t emit(size_t _count);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief integrate all the particles, age them and remove the dead ones
+  /// @param[in] _dt the time step
+  //----------------------------------------------------------------------------------------------------------------------
+  void update(Real _dt);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief draw all the particles as instances of a VAOPrimitives mesh, a shader must be active
+  /// @param[in] _primitive the name of the primitive to use e.g. "sphere" or "cube"
+  //----------------------------------------------------------------------------------------------------------------------
+  void draw(const std::string &_primitive);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief kill all the particles
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept{m_numParticles=0;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of live particles
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_numParticles;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the max number of particles
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t capacity() const noexcept{return m_maxParticles;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the emitter position
+  //----------------------------------------------------------------------------------------------------------------------
+  void setEmitterPosition(const Vec3 &_pos) noexcept{m_emitterPos=_pos;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the emit direction and the spread (0 all along the direction, 1 fully random)
+  //----------------------------------------------------------------------------------------------------------------------
+  void setEmitDirection(const Vec3 &_dir, Real _spread) noexcept{m_emitDir=_dir; m_spread=_spread;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the range of the initial speed
+  //----------------------------------------------------------------------------------------------------------------------
+  void setSpeed(Real _min, Real _max) noexcept{m_minSpeed=_min; m_maxSpeed=_max;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the range of the life span in seconds
+  //----------------------------------------------------------------------------------------------------------------------
+  void setLifeSpan(Real _min, Real _max) noexcept{m_minLife=_min; m_maxLife=_max;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the constant acceleration (gravity / wind etc)
+  //----------------------------------------------------------------------------------------------------------------------
+  void setAcceleration(const Vec3 &_a) noexcept{m_acceleration=_a;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the linear drag coefficient
+  //----------------------------------------------------------------------------------------------------------------------
+  void setDrag(Real _drag) noexcept{m_drag=_drag;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the generic attribute used for the per instance data in draw
+  //----------------------------------------------------------------------------------------------------------------------
+  void setInstanceAttribute(GLuint _id) noexcept{m_instanceAttribute=_id;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief raw access to the SoA data, valid for [0,size())
+  //----------------------------------------------------------------------------------------------------------------------
+  const Real *getPositionX() const noexcept{return m_px.data();}
+  const Real *getPositionY() const noexcept{return m_py.data();}
+  const Real *getPositionZ() const noexcept{return m_pz.data();}
+  Real *getVelocityX() noexcept{return m_vx.data();}
+  Real *getVelocityY() noexcept{return m_vy.data();}
+  Real *getVelocityZ() noexcept{return m_vz.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the position of a single particle
+  /// @param[in] _i the index of the particle
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 getPosition(size_t _i) const noexcept{return Vec3(m_px[_i],m_py[_i],m_pz[_i]);}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove dead particles by moving live ones from the end into the gaps
+  //----------------------------------------------------------------------------------------------------------------------
+  void compact() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the SoA particle data
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_px;
+  std::vector<Real> m_py;
+  std::vector<Real> m_pz;
+  std::vector<Real> m_vx;
+  std::vector<Real> m_vy;
+  std::vector<Real> m_vz;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remaining life of each particle
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_life;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 1/total life of each particle used to work out the normalised age
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_invLifeSpan;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief number of live particles
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_numParticles=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief max number of particles
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_maxParticles;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief emitter settings
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_emitterPos;
+  Vec3 m_emitDir=Vec3(0.0f,1.0f,0.0f);
+  Real m_spread=0.3f;
+  Real m_minSpeed=1.0f;
+  Real m_maxSpeed=2.0f;
+  Real m_minLife=1.0f;
+  Real m_maxLife=3.0f;
+  Vec3 m_acceleration=Vec3(0.0f,-9.81f,0.0f);
+  Real m_drag=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the per instance buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_instanceBuffer=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the attribute the instance data is bound to
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_instanceAttribute=3;
+};
+
+} // end ngl namespace
+#endif
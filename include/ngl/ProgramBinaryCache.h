@@ -0,0 +1,99 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PROGRAMBINARYCACHE_H_
+#define PROGRAMBINARYCACHE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ProgramBinaryCache.h
+/// @brief an on disk cache of linked program binaries and their uniforms
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include <cstdint>
+#include <string>
+
+namespace ngl
+{
+class ShaderProgram;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ProgramBinaryCache "include/ngl/ProgramBinaryCache.h"
+/// @brief stores linked programs with glGetProgramBinary and restores them with glProgramBinary so the
+/// compile, link and uniform lookups are skipped on the next run. Each entry is keyed by a hash of the
+/// driver (vendor, renderer and version strings), the bound attribute / frag data locations, the shader
+/// sources and any defines, and holds the registered uniforms alongside the binary. A missing entry, a
+/// key mismatch or a binary the driver rejects (say after a driver update) is a miss and the program is
+/// built from source and saved again. Enable it with ShaderLib::setProgramCache
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT ProgramBinaryCache
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor, reads the driver strings so needs a current context
+  /// @param[in] _directory an existing directory to keep the binaries in
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit ProgramBinaryCache(const std::string &_directory) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief does the driver support program binaries
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool isSupported() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the key of a program with its shaders' sources loaded
+  /// @param[in] _program the program
+  /// @param[in] _defines anything else the build depends on
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getKey(const ShaderProgram &_program, const std::string &_defines=std::string()) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ask the driver to keep the binary, call before linking a program that will be saved
+  //----------------------------------------------------------------------------------------------------------------------
+  void prepare(const ShaderProgram &_program) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief load a program from the cache
+  /// @param[in,out] io_program the program, on success it is linked and its uniforms registered
+  /// @param[in] _key the key from getKey
+  /// @returns false on a miss
+  //----------------------------------------------------------------------------------------------------------------------
+  bool load(ShaderProgram &io_program, uint64_t _key) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief save a linked program to the cache
+  /// @returns false if the binary couldn't be got or written
+  //----------------------------------------------------------------------------------------------------------------------
+  bool save(const ShaderProgram &_program, uint64_t _key) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accessors
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::string &getDirectory() const noexcept{return m_directory;}
+  unsigned int getNumHits() const noexcept{return m_hits;}
+  unsigned int getNumMisses() const noexcept{return m_misses;}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the file holding a key
+  //----------------------------------------------------------------------------------------------------------------------
+  std::string getFileName(uint64_t _key) const;
+  std::string m_directory;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the driver strings, a new driver can't load old binaries
+  //----------------------------------------------------------------------------------------------------------------------
+  std::string m_driver;
+  unsigned int m_hits=0;
+  unsigned int m_misses=0;
+};
+
+} // end ngl namespace
+#endif
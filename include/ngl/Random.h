@@ -24,6 +24,7 @@
 #include "Colour.h"
 #include "Singleton.h"
 #include "Vec4.h"
+#include "StringID.h"
 
 #include <unordered_map>
 #include <random>
@@ -91,6 +92,10 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   Real getFloatFromGeneratorName( const std::string &_name);
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief as above by the id of the generator's name, a hashed lookup with no string built
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getFloatFromGeneratorName( StringID _name);
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief return a random colour with rgb components clamped between 0-1
   //----------------------------------------------------------------------------------------------------------------------
   Colour getRandomColour();
@@ -175,7 +180,7 @@ protected :
   /// a name / function pair, and this function will be called returning a Real
   /// value
   //----------------------------------------------------------------------------------------------------------------------
-  std::unordered_map<std::string, std::uniform_real_distribution<Real> > m_floatGenerators;
+  std::unordered_map<StringID, std::uniform_real_distribution<Real> > m_floatGenerators;
 
 };
 
@@ -0,0 +1,173 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RESOURCETRACKER_H_
+#define RESOURCETRACKER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ResourceTracker.h
+/// @brief accounting of the GPU and CPU memory held by NGL's resources
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ResourceTracker "include/ngl/ResourceTracker.h"
+/// @brief records the bytes held by each resource with a category and a tag saying what it is. The VAO
+/// classes, GeometryPool and UniformBuffer track their buffers with the object as the handle, textures
+/// made by Texture and Text are tracked by their GL name and released by GLState::deleteTextures, and
+/// AbstractMesh and NCCAPointBake track their CPU side arrays. The current and peak bytes are kept per
+/// category. Anything still tracked when everything should have been freed (say at the end of main) is a
+/// leak, reportLeaks lists them, and report shows which tags hold the most memory
+/// @code
+/// ngl::ResourceTracker *tracker=ngl::ResourceTracker::instance();
+/// tracker->report();
+/// @endcode
+/// This isn't a Singleton<> as the VAO and mesh destructors use it when the program exits
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT ResourceTracker
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the kinds of memory tracked, buffers and textures are on the GPU, meshes and point bakes on the CPU
+  //----------------------------------------------------------------------------------------------------------------------
+  enum Category{BUFFER=0,TEXTURE,MESH,POINTBAKE,NUMCATEGORIES};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a tracked resource, serial orders them by when they were first tracked
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Resource
+  {
+    Category category;
+    uintptr_t handle;
+    size_t bytes;
+    std::string tag;
+    uint64_t serial;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the tracker
+  //----------------------------------------------------------------------------------------------------------------------
+  static ResourceTracker *instance() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is a category GPU memory
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool isGPU(Category _category) noexcept{return _category == BUFFER || _category == TEXTURE;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the name of a category, for printing
+  //----------------------------------------------------------------------------------------------------------------------
+  static const char *getName(Category _category) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the bytes a resource holds, tracking it if it is new
+  /// @param[in] _category the kind of memory
+  /// @param[in] _handle the owning object or GL name
+  /// @param[in] _bytes the size
+  /// @param[in] _tag what the resource is, empty keeps the current tag
+  //----------------------------------------------------------------------------------------------------------------------
+  void track(Category _category, uintptr_t _handle, size_t _bytes, const std::string &_tag=std::string());
+  void track(Category _category, const void *_owner, size_t _bytes, const std::string &_tag=std::string())
+  {
+    track(_category,reinterpret_cast<uintptr_t>(_owner),_bytes,_tag);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add bytes to a resource, tracking it if it is new
+  //----------------------------------------------------------------------------------------------------------------------
+  void add(Category _category, uintptr_t _handle, size_t _bytes, const std::string &_tag=std::string());
+  void add(Category _category, const void *_owner, size_t _bytes, const std::string &_tag=std::string())
+  {
+    add(_category,reinterpret_cast<uintptr_t>(_owner),_bytes,_tag);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief stop tracking a resource, unknown resources are ignored
+  //----------------------------------------------------------------------------------------------------------------------
+  void release(Category _category, uintptr_t _handle);
+  void release(Category _category, const void *_owner){release(_category,reinterpret_cast<uintptr_t>(_owner));}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief change the tag of a tracked resource
+  //----------------------------------------------------------------------------------------------------------------------
+  void setTag(Category _category, uintptr_t _handle, const std::string &_tag);
+  void setTag(Category _category, const void *_owner, const std::string &_tag)
+  {
+    setTag(_category,reinterpret_cast<uintptr_t>(_owner),_tag);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the tag of a tracked resource, empty if it isn't tracked
+  //----------------------------------------------------------------------------------------------------------------------
+  std::string getTag(Category _category, uintptr_t _handle) const;
+  std::string getTag(Category _category, const void *_owner) const
+  {
+    return getTag(_category,reinterpret_cast<uintptr_t>(_owner));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bytes held now / the most held at once, by category and in total
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getCurrent(Category _category) const;
+  size_t getPeak(Category _category) const;
+  size_t getTotalCurrent() const;
+  size_t getTotalPeak() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of resources tracked in a category
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getNumResources(Category _category) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief all the tracked resources, largest first
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Resource> getResources() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bytes held by each tag in a category, largest first
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<std::pair<std::string,size_t>> getBytesByTag(Category _category) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the current and peak of each category and the _top largest tags through Logger
+  //----------------------------------------------------------------------------------------------------------------------
+  void report(size_t _top=10) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write every resource still tracked through Logger, oldest first
+  /// @returns the number of resources still tracked
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t reportLeaks() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief forget everything
+  //----------------------------------------------------------------------------------------------------------------------
+  void reset();
+
+private :
+  ResourceTracker() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief change a resource's bytes, called with the mutex held
+  //----------------------------------------------------------------------------------------------------------------------
+  void update(Category _category, uintptr_t _handle, size_t _bytes, bool _add, const std::string &_tag);
+  typedef std::pair<int,uintptr_t> Key;
+  mutable std::mutex m_mutex;
+  std::map<Key,Resource> m_resources;
+  std::array<size_t,NUMCATEGORIES> m_current;
+  std::array<size_t,NUMCATEGORIES> m_peak;
+  size_t m_totalCurrent=0;
+  size_t m_totalPeak=0;
+  uint64_t m_serial=0;
+};
+
+} // end ngl namespace
+#endif
@@ -55,6 +55,28 @@ public :
   /// is attached and issue warning if not
   //----------------------------------------------------------------------------------------------------------------------
   void compile() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start compiling without waiting for the result, checkCompileStatus gets the result later so
+  /// the driver can compile several shaders at once
+  //----------------------------------------------------------------------------------------------------------------------
+  void submitCompile() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief has a submitted compile finished, without GL_ARB_parallel_shader_compile this can't be
+  /// known without blocking so it is always true
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isCompileComplete() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief wait for a submitted compile and check it as compile does
+  //----------------------------------------------------------------------------------------------------------------------
+  void checkCompileStatus() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is a compile submitted but not checked
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isCompilePending() const noexcept{return m_compilePending;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief has the shader been compiled (and checked) since its source was last loaded
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isCompiled() const noexcept{return m_compiled;}
   /// @brief load in shader source and attach it to the shader object
   /// if source is already loaded it will re-load and re-attached
   /// @param _name the file name for the source we are loading
@@ -106,6 +128,10 @@ private :
   //----------------------------------------------------------------------------------------------------------------------
   bool m_compiled;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set by submitCompile until checkCompileStatus
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_compilePending=false;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief what type of shader we are
   //----------------------------------------------------------------------------------------------------------------------
   ShaderType m_shaderType;
@@ -24,13 +24,18 @@
 #include "Shader.h"
 #include "ShaderProgram.h"
 #include "Singleton.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderPreprocessor.h"
+#include "StringID.h"
 #include "Types.h"
 #include "Mat3.h"
 #include "Mat4.h"
 #include "Vec4.h"
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -101,6 +106,10 @@ public :
   /// @param _name the name of the ShaderProgram to use
   //----------------------------------------------------------------------------------------------------------------------
   void use( const std::string &_name ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief use a program by id, a hashed lookup with no string built
+  //----------------------------------------------------------------------------------------------------------------------
+  void use( StringID _name ) noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief bind an attribute at index by name
@@ -132,6 +141,121 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   ShaderProgram * operator[] (const char *_name) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accessor to the shader program by id
+  //----------------------------------------------------------------------------------------------------------------------
+  ShaderProgram * operator[] (StringID _name) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the program set by use or operator[]
+  //----------------------------------------------------------------------------------------------------------------------
+  ShaderProgram * getCurrentProgram() const noexcept{return m_currentProgram;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get a typed handle to a uniform in the current program, resolve these once (after the
+  /// program is linked) and keep them, setting a handle needs no string or map lookups
+  /// @param _name the name of the uniform
+  /// @returns the handle, invalid if not found or the wrong type
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class T>
+  UniformHandle<T> getUniformHandle(const std::string &_name) const noexcept
+  {
+    return m_currentProgram->getUniformHandle<T>(_name);
+  }
+  template <class T>
+  UniformHandle<T> getUniformHandle(const char *_name) const noexcept
+  {
+    return m_currentProgram->getUniformHandle<T>(_name);
+  }
+  template <class T>
+  UniformHandle<T> getUniformHandle(const UniformName &_name) const noexcept
+  {
+    return m_currentProgram->getUniformHandle<T>(_name);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief keep linked programs in an on disk cache so later runs skip compiling and linking, see
+  /// ProgramBinaryCache. Does nothing if the driver has no program binary formats
+  /// @param[in] _directory an existing directory for the cache, empty turns the cache off
+  /// @returns true if the cache is in use
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setProgramCache(const std::string &_directory) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the program cache or nullptr if not in use
+  //----------------------------------------------------------------------------------------------------------------------
+  ProgramBinaryCache * getProgramCache() const noexcept{return m_programCache.get();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief turn asynchronous compiling on or off. When on compileShader and linkProgramObject only submit
+  /// the work to the driver (which compiles in parallel if GL_ARB_parallel_shader_compile is available) and
+  /// the results are checked when a program is first used, by isCompileComplete or by finishCompiles
+  //----------------------------------------------------------------------------------------------------------------------
+  void setAsyncCompile(bool _state) noexcept;
+  bool isAsyncCompile() const noexcept{return m_asyncCompile;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief finish any submitted programs that are ready without blocking
+  /// @returns true when nothing is left compiling, poll this to keep a loading screen going
+  /// @code
+  /// shader->setAsyncCompile(true);
+  /// shader->loadFromJson("shaders.json");
+  /// while(!shader->isCompileComplete())
+  ///   drawLoadingScreen();
+  /// @endcode
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isCompileComplete() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief wait for and finish all submitted programs
+  //----------------------------------------------------------------------------------------------------------------------
+  void finishCompiles() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a directory searched for #include files by loadShaderSource, loadFromJson and the
+  /// permutation methods, files are first looked for next to the file including them
+  //----------------------------------------------------------------------------------------------------------------------
+  void addShaderIncludePath(const std::string &_path) noexcept{m_preprocessor.addIncludePath(_path);}
+  ShaderPreprocessor & getPreprocessor() noexcept{return m_preprocessor;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create a set of shader permutations, a program whose variants are built on first use by
+  /// #defining a set of features. Each variant is keyed by its feature bits and variants (or single
+  /// stages) whose preprocessed sources come out the same share the same compiled shader / program
+  /// @code
+  /// shader->createShaderPermutations("Phong",{"TEXTURED","SHADOWS"});
+  /// shader->attachPermutationShader("Phong",ngl::ShaderType::VERTEX,"shaders/PhongVertex.glsl");
+  /// shader->attachPermutationShader("Phong",ngl::ShaderType::FRAGMENT,"shaders/PhongFragment.glsl");
+  /// shader->usePermutation("Phong",shader->getFeatureMask("Phong",{"SHADOWS"}));
+  /// @endcode
+  /// @param[in] _name the name of the permutation set
+  /// @param[in] _features up to 32 feature names, feature n is bit n of the mask and is defined as 1
+  //----------------------------------------------------------------------------------------------------------------------
+  bool createShaderPermutations(const std::string &_name, const std::vector<std::string> &_features) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a stage to a permutation set, the file's includes are expanded now
+  //----------------------------------------------------------------------------------------------------------------------
+  bool attachPermutationShader(const std::string &_name, ShaderType _type, const std::string &_sourceFile) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the mask for a list of feature names, unknown names are ignored with a warning
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t getFeatureMask(const std::string &_name, const std::vector<std::string> &_features) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build a variant without using it, for warming up (it is only submitted if async compiling)
+  /// @returns the name the variant's program is stored under, empty on error
+  //----------------------------------------------------------------------------------------------------------------------
+  std::string preparePermutation(const std::string &_name, uint32_t _features) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief use a variant building it if needed
+  //----------------------------------------------------------------------------------------------------------------------
+  void usePermutation(const std::string &_name, uint32_t _features) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get a variant building it if needed, like operator[] it becomes the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  ShaderProgram * getPermutation(const std::string &_name, uint32_t _features) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief turn uniform shadowing on or off, when on (the default) setting a uniform to the value it
+  /// already holds doesn't call glUniform, see UniformShadow
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniformShadowing(bool _state) noexcept{UniformShadow::setEnabled(_state);}
+  bool isUniformShadowing() const noexcept{return UniformShadow::isEnabled();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of uniform uploads passed to GL / skipped as unchanged since the last reset
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t getNumUniformUploads() const noexcept{return UniformShadow::getNumIssued();}
+  uint64_t getNumSkippedUniformUploads() const noexcept{return UniformShadow::getNumSkipped();}
+  void resetUniformUploadCounters() noexcept{UniformShadow::resetCounters();}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief method to load shaders
   /// @param[in] _shaderName the name of the shader to be stored in the Manager
   /// @param[in] _vert the vertex shader to load
@@ -346,6 +470,17 @@ public :
   /// @returns the index of the block or -1 on error
   //----------------------------------------------------------------------------------------------------------------------
   GLuint getUniformBlockIndex(const std::string &_uniformBlockName  ) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief attach a uniform block in the current program to a buffer binding point, this is part of the
+  /// program so only needs doing once after linking
+  /// @param _uniformBlockName the name of the block
+  /// @param _bindingPoint the binding point a UniformBuffer is bound to
+  /// @returns false if the block isn't in the program
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setUniformBlockBinding(const std::string &_uniformBlockName, GLuint _bindingPoint) const noexcept
+  {
+    return m_currentProgram->setUniformBlockBinding(_uniformBlockName,_bindingPoint);
+  }
  //----------------------------------------------------------------------------------------------------------------------
   /// @brief register a uniform so we don't have to call glGet functions when using
   /// @param[in] _shaderName the name of the shader to set the param for
@@ -635,6 +770,23 @@ protected:
   //----------------------------------------------------------------------------------------------------------------------
   void loadToonShaders() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief restore a program from the program cache
+  /// @returns false if there is no cache or it misses
+  //----------------------------------------------------------------------------------------------------------------------
+  bool linkFromCache(ShaderProgram &_program) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief link a program and store it in the program cache if there is one
+  //----------------------------------------------------------------------------------------------------------------------
+  void linkAndCache(ShaderProgram &_program) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief finish a program's submitted link and cache it if it is pending
+  //----------------------------------------------------------------------------------------------------------------------
+  void finishProgram(ShaderProgram *_program) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a stage to a permutation set from source with its includes expanded
+  //----------------------------------------------------------------------------------------------------------------------
+  bool addPermutationStage(const std::string &_name, ShaderType _type, const std::string &_source) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief a map of shader Programs using name as key to shader pointer
   //----------------------------------------------------------------------------------------------------------------------
   std::unordered_map <std::string,ShaderProgram *> m_shaderPrograms;
@@ -647,9 +799,17 @@ protected:
   //----------------------------------------------------------------------------------------------------------------------
   ShaderProgram *m_nullProgram;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief the name of the currently active shader
+  /// @brief the programs again by the id of their name for use / operator[]
+  //----------------------------------------------------------------------------------------------------------------------
+  std::unordered_map <StringID,ShaderProgram *> m_programIDs;
   //----------------------------------------------------------------------------------------------------------------------
-  std::string m_currentShader;
+  /// @brief the id of the currently active shader
+  //----------------------------------------------------------------------------------------------------------------------
+  StringID m_currentShader;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the currently active program so the set methods don't need to look it up by name
+  //----------------------------------------------------------------------------------------------------------------------
+  ShaderProgram *m_currentProgram;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  flag to indicate the debug state
   //----------------------------------------------------------------------------------------------------------------------
@@ -659,6 +819,43 @@ protected:
   //----------------------------------------------------------------------------------------------------------------------
   unsigned int m_numShaders;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the program binary cache, null if not in use
+  //----------------------------------------------------------------------------------------------------------------------
+  std::unique_ptr<ProgramBinaryCache> m_programCache;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compile and link asynchronously
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_asyncCompile=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a submitted link and the cache key to save it with once finished
+  //----------------------------------------------------------------------------------------------------------------------
+  struct PendingLink
+  {
+    ShaderProgram *program;
+    bool cache;
+    uint64_t key;
+  };
+  std::vector<PendingLink> m_pendingLinks;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief expands #include in loaded shaders
+  //----------------------------------------------------------------------------------------------------------------------
+  ShaderPreprocessor m_preprocessor;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a permutation set, its stages' sources before defines and the variants built so far
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Permutations
+  {
+    std::vector<std::string> features;
+    std::vector<std::pair<ShaderType,std::string>> stages;
+    std::unordered_map<uint32_t,std::string> variants;
+  };
+  std::unordered_map<std::string,Permutations> m_permutations;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compiled permutation shaders and linked programs by the hash of their preprocessed sources
+  //----------------------------------------------------------------------------------------------------------------------
+  std::unordered_map<uint64_t,std::string> m_permutationShaders;
+  std::unordered_map<uint64_t,std::string> m_permutationPrograms;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief default ctor private as a singleton
   //----------------------------------------------------------------------------------------------------------------------
   ShaderLib() noexcept;
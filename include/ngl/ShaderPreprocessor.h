@@ -0,0 +1,102 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SHADERPREPROCESSOR_H_
+#define SHADERPREPROCESSOR_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ShaderPreprocessor.h
+/// @brief resolves #include and injects #defines into GLSL source
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ShaderPreprocessor "include/ngl/ShaderPreprocessor.h"
+/// @brief GLSL has no #include so this expands #include "file" (or <file>) lines before the source is
+/// given to GL. Files are looked for next to the including file then in each include path in order.
+/// #line directives are written around each include so compile errors give the line in the right file,
+/// the source string number in the error is the index into getFiles. Include guards work as normal
+/// as the GLSL preprocessor still sees the #ifndef / #define lines
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT ShaderPreprocessor
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a directory to search for includes
+  //----------------------------------------------------------------------------------------------------------------------
+  void addIncludePath(const std::string &_path);
+  const std::vector<std::string> &getIncludePaths() const noexcept{return m_includePaths;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief load a file and expand its includes
+  /// @param[in] _fname the file to load
+  /// @param[out] o_source the expanded source
+  /// @returns false if the file or one of its includes couldn't be read or includes itself
+  //----------------------------------------------------------------------------------------------------------------------
+  bool loadFile(const std::string &_fname, std::string &o_source);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief expand the includes in a source string
+  /// @param[in] _source the source
+  /// @param[in] _directory where relative includes are looked for first, may be empty
+  /// @param[out] o_source the expanded source
+  //----------------------------------------------------------------------------------------------------------------------
+  bool process(const std::string &_source, const std::string &_directory, std::string &o_source);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the files read by the last loadFile / process, index 0 being the top level
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<std::string> &getFiles() const noexcept{return m_files;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add #define lines straight after the #version line (or at the start if there isn't one)
+  /// @param[in] _source the source
+  /// @param[in] _defines each is either NAME or NAME=VALUE, NAME on its own is defined as 1
+  //----------------------------------------------------------------------------------------------------------------------
+  static std::string injectDefines(const std::string &_source, const std::vector<std::string> &_defines);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 64 bit FNV-1a hash of _size bytes, pass the last hash as _hash to chain calls. Used for the
+  /// preprocessed source keys and by ProgramBinaryCache
+  //----------------------------------------------------------------------------------------------------------------------
+  static uint64_t hashBytes(const void *_data, size_t _size, uint64_t _hash=14695981039346656037ull) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief hashBytes of a string's characters, used to find identical preprocessed sources
+  //----------------------------------------------------------------------------------------------------------------------
+  static uint64_t hash(const std::string &_s, uint64_t _hash=14695981039346656037ull) noexcept
+  {
+    return hashBytes(_s.data(),_s.size(),_hash);
+  }
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief expand a source, _stack holds the files being expanded to catch an include loop
+  //----------------------------------------------------------------------------------------------------------------------
+  bool expand(const std::string &_source, const std::string &_directory, size_t _fileIndex,
+              std::vector<std::string> &_stack, std::string &o_source);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find an include, returns an empty string if it isn't found
+  //----------------------------------------------------------------------------------------------------------------------
+  std::string resolve(const std::string &_name, const std::string &_directory) const;
+  std::vector<std::string> m_includePaths;
+  std::vector<std::string> m_files;
+};
+
+} // end ngl namespace
+#endif
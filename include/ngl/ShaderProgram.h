@@ -20,8 +20,10 @@
 #include "Shader.h"
 #include "Types.h"
 #include "Util.h"
+#include "UniformHandle.h"
 #include <vector>
 #include <unordered_map>
+#include <iostream>
 
 //----------------------------------------------------------------------------------------------------------------------
 ///  @class ShaderProgram  "ShaderProgram.h"
@@ -85,6 +87,24 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   void link() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start linking without waiting for the result, the link is finished by finishLink which
+  /// use calls so a program is checked the first time it is needed
+  //----------------------------------------------------------------------------------------------------------------------
+  void submitLink() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief has a submitted link (and the compiles before it) finished, without
+  /// GL_ARB_parallel_shader_compile this can't be known without blocking so it is always true
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isLinkComplete() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief wait for a submitted link, check the attached shaders and the link and register the uniforms
+  //----------------------------------------------------------------------------------------------------------------------
+  void finishLink() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is a link submitted but not finished
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isLinkPending() const noexcept{return m_linkPending;}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief get the ProgramID for the Program
   //----------------------------------------------------------------------------------------------------------------------
   GLuint getID() const noexcept{return m_programID;}
@@ -95,6 +115,23 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   GLint getUniformLocation( const char* _name) const noexcept;
 
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get a typed handle to a registered uniform so it can be set without any lookups, this
+  /// checks the uniform exists and its GLSL type matches T
+  /// @param _name the name of the uniform
+  /// @returns the handle, invalid if the uniform isn't found or is the wrong type
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class T>
+  UniformHandle<T> getUniformHandle(const std::string &_name) const noexcept;
+  template <class T>
+  UniformHandle<T> getUniformHandle(const char *_name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get a typed handle using a pre-hashed name
+  /// @param _name the name and compile time hash of the uniform
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class T>
+  UniformHandle<T> getUniformHandle(const UniformName &_name) const noexcept;
+
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief   lists the available uniforms for the shader (this was a pain because the compiler quietly gets rid of unused uniforms).
   ///  method written by Richard Southern.
@@ -474,13 +511,28 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
 
   GLuint getUniformBlockIndex( const std::string &_uniformBlockName  )const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief attach a uniform block to a buffer binding point (see UniformBuffer::bind)
+  /// @param[in] _uniformBlockName the name of the uniform block
+  /// @param[in] _bindingPoint the binding point
+  /// @returns false if the program has no such block
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setUniformBlockBinding(const std::string &_uniformBlockName, GLuint _bindingPoint) const noexcept;
 
 private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the cache restores the program and its uniforms directly
+  //----------------------------------------------------------------------------------------------------------------------
+  friend class ProgramBinaryCache;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief flag to indicate if the current Program has been linked
   //----------------------------------------------------------------------------------------------------------------------
   bool m_linked;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set by submitLink until finishLink
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_linkPending=false;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief a list of the shader objects attached to the program
   //----------------------------------------------------------------------------------------------------------------------
   std::vector <Shader *> m_shaders;
@@ -510,6 +562,7 @@ private :
     GLint loc;
     std::string name;
     GLenum type;
+    mutable UniformShadow shadow;
   };
 
   //----------------------------------------------------------------------------------------------------------------------
@@ -518,12 +571,78 @@ private :
   //----------------------------------------------------------------------------------------------------------------------
   std::unordered_map <std::string, uniformData> m_registeredUniforms;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the registered uniforms by hashUniformName of their name, built by autoRegisterUniforms
+  //----------------------------------------------------------------------------------------------------------------------
+  std::unordered_map <uint32_t, const uniformData *> m_uniformHashes;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief fill m_uniformHashes from m_registeredUniforms
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildUniformHashes() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find a registered uniform by name or hashed name
+  /// @returns the uniform or nullptr if not found
+  //----------------------------------------------------------------------------------------------------------------------
+  const uniformData *findUniform(const std::string &_name) const noexcept;
+  const uniformData *findUniform(const UniformName &_name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find a registered uniform and check the new value against its shadow
+  /// @param[in] _data the value or nullptr if it can't be shadowed
+  /// @param[in] _size the size of the value in bytes
+  /// @param[in] _warn report a missing uniform
+  /// @returns the location to upload to or -1 if not found or the value is unchanged
+  //----------------------------------------------------------------------------------------------------------------------
+  GLint uploadLocation(const std::string &_name, const void *_data, size_t _size, bool _warn) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief make a handle from a found uniform reporting any errors
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class T>
+  UniformHandle<T> makeHandle(const uniformData *_data, const char *_name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief indicate if this program is the current active program
   //----------------------------------------------------------------------------------------------------------------------
   bool m_active;
   //----------------------------------------------------------------------------------------------------------------------
 
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+template <class T>
+UniformHandle<T> ShaderProgram::getUniformHandle(const std::string &_name) const noexcept
+{
+  return makeHandle<T>(findUniform(_name),_name.c_str());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <class T>
+UniformHandle<T> ShaderProgram::getUniformHandle(const char *_name) const noexcept
+{
+  return getUniformHandle<T>(std::string(_name));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <class T>
+UniformHandle<T> ShaderProgram::getUniformHandle(const UniformName &_name) const noexcept
+{
+  return makeHandle<T>(findUniform(_name),_name.m_name);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <class T>
+UniformHandle<T> ShaderProgram::makeHandle(const uniformData *_data, const char *_name) const noexcept
+{
+  if(_data == nullptr)
+  {
+    std::cerr<<"Uniform \""<<_name<<"\" not found in Program \""<<m_programName<<"\"\n";
+    return UniformHandle<T>();
+  }
+  if(!UniformHandle<T>::isCompatible(_data->type))
+  {
+    std::cerr<<"Uniform \""<<_name<<"\" in Program \""<<m_programName<<"\" doesn't match the handle type\n";
+    return UniformHandle<T>();
+  }
+  return UniformHandle<T>(_data->loc,m_programID,&_data->shadow);
+}
+
 } // end NGL namespace
 #endif
 //----------------------------------------------------------------------------------------------------------------------
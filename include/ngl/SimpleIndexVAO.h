@@ -58,6 +58,11 @@ class NGL_DLLEXPORT SimpleIndexVAO : public AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     virtual void draw() const;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the VAO using glDrawElementsInstanced
+    /// @param _instances the number of instances to draw
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void drawInstanced(unsigned int _instances) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor don't do anything as the remove clears things
     //----------------------------------------------------------------------------------------------------------------------
     virtual ~SimpleIndexVAO();
@@ -0,0 +1,227 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SPATIALHASHGRID_H_
+#define SPATIALHASHGRID_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SpatialHashGrid.h
+/// @brief a uniform grid spatial hash for particle neighbour searches
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include <vector>
+#include <cmath>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class SpatialHashGrid "include/ngl/SpatialHashGrid.h"
+/// @brief a counting sort uniform grid for fast radius queries on large numbers of points (particles, flocks etc).
+/// The infinite grid of cells is hashed into a table and the points are sorted by cell, the positions are
+/// copied into contiguous per cell SoA arrays so a query only touches a few small linear ranges of memory.
+/// The grid is meant to be rebuilt each step, the rebuild is split over all cores and keeps points in
+/// their original order within a cell so results are deterministic.
+/// For best results set the cell size to the query radius.
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT SpatialHashGrid
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _cellSize the size of each grid cell, usually the neighbour search radius
+  //----------------------------------------------------------------------------------------------------------------------
+  SpatialHashGrid(Real _cellSize=1.0f) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the cell size, this will only be used on the next build
+  /// @param[in] _cellSize the size of each grid cell
+  //----------------------------------------------------------------------------------------------------------------------
+  void setCellSize(Real _cellSize) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the cell size
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getCellSize() const noexcept{return m_cellSize;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the grid from an array of positions
+  /// @param[in] _pos the positions
+  /// @param[in] _size the number of positions
+  //----------------------------------------------------------------------------------------------------------------------
+  void build(const Vec3 *_pos, size_t _size);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the grid from a vector of positions
+  /// @param[in] _pos the positions
+  //----------------------------------------------------------------------------------------------------------------------
+  void build(const std::vector<Vec3> &_pos){build(_pos.data(),_pos.size());}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the grid from SoA position arrays
+  /// @param[in] _x the x components
+  /// @param[in] _y the y components
+  /// @param[in] _z the z components
+  /// @param[in] _size the number of positions
+  //----------------------------------------------------------------------------------------------------------------------
+  void build(const Real *_x, const Real *_y, const Real *_z, size_t _size);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief call _func(index,distanceSquared) for every point within _radius of _p, the index is the
+  /// index of the point in the arrays passed to build. Safe to call from many threads at once.
+  /// @param[in] _p the query position
+  /// @param[in] _radius the search radius
+  /// @param[in] _func the function to call for each neighbour
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename Func>
+  void forEachNeighbour(const Vec3 &_p, Real _radius, const Func &_func) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief gather the indices of all points within _radius of _p
+  /// @param[in] _p the query position
+  /// @param[in] _radius the search radius
+  /// @param[out] o_results the indices of the points found (appended to)
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryRadius(const Vec3 &_p, Real _radius, std::vector<size_t> &o_results) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of points in the grid
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_sortedIndex.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the hash table (a power of 2)
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getTableSize() const noexcept{return m_tableMask+1;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the original point indices in grid order, iterating particles in this order
+  /// (or re-ordering the particle data with it) gives much better cache use in the sim loop
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<unsigned int> &getSortedIndices() const noexcept{return m_sortedIndex;}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert a position component to an integer cell co-ordinate
+  //----------------------------------------------------------------------------------------------------------------------
+  int cellCoord(Real _v) const noexcept{return static_cast<int>(std::floor(_v*m_invCellSize));}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief hash an integer cell into the table, x is not scrambled so a row of cells along x is a
+  /// contiguous run of table entries and a query can scan a whole row as one range of memory
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int hashCell(int _x, int _y, int _z) const noexcept
+  {
+    return ( static_cast<unsigned int>(_x) +
+             static_cast<unsigned int>(_y)*73856093u +
+             static_cast<unsigned int>(_z)*19349663u ) & m_tableMask;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the actual build, the positions are read through _get(i,x,y,z)
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename Getter>
+  void buildImpl(size_t _size, const Getter &_get);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the cell size
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_cellSize;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 1/cell size
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_invCellSize;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief table size -1 used to mask the hash
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int m_tableMask=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief hash of each input point
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned int> m_hash;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start offset into the sorted arrays for each table entry (size table+1)
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned int> m_cellStart;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scratch per thread counts then write cursors for each table entry used in the scatter,
+  /// one row of table size entries per build thread
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned int> m_cellCursor;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief original index of each sorted point
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned int> m_sortedIndex;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief sorted positions in SoA form
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_sortedX;
+  std::vector<Real> m_sortedY;
+  std::vector<Real> m_sortedZ;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Func>
+void SpatialHashGrid::forEachNeighbour(const Vec3 &_p, Real _radius, const Func &_func) const
+{
+  if(m_sortedIndex.empty())
+  {
+    return;
+  }
+  Real r2=_radius*_radius;
+  int minX=cellCoord(_p.m_x-_radius);
+  int minY=cellCoord(_p.m_y-_radius);
+  int minZ=cellCoord(_p.m_z-_radius);
+  int maxX=cellCoord(_p.m_x+_radius);
+  int maxY=cellCoord(_p.m_y+_radius);
+  int maxZ=cellCoord(_p.m_z+_radius);
+  unsigned int span=static_cast<unsigned int>(maxX-minX);
+  for(int z=minZ; z<=maxZ; ++z)
+  {
+    for(int y=minY; y<=maxY; ++y)
+    {
+      // the row minX..maxX is one run of the table unless it wraps around the end
+      unsigned int h0=hashCell(minX,y,z);
+      unsigned int h1=(h0+span) & m_tableMask;
+      unsigned int ranges[2][2];
+      int numRanges=1;
+      if(span >= m_tableMask)
+      {
+        // huge radius so the row covers the whole table
+        ranges[0][0]=0; ranges[0][1]=m_cellStart[m_tableMask+1];
+      }
+      else if(h1 >= h0)
+      {
+        ranges[0][0]=m_cellStart[h0]; ranges[0][1]=m_cellStart[h1+1];
+      }
+      else
+      {
+        ranges[0][0]=m_cellStart[h0]; ranges[0][1]=m_cellStart[m_tableMask+1];
+        ranges[1][0]=m_cellStart[0];  ranges[1][1]=m_cellStart[h1+1];
+        numRanges=2;
+      }
+      for(int r=0; r<numRanges; ++r)
+      {
+        for(unsigned int i=ranges[r][0]; i<ranges[r][1]; ++i)
+        {
+          Real dx=m_sortedX[i]-_p.m_x;
+          Real dy=m_sortedY[i]-_p.m_y;
+          Real dz=m_sortedZ[i]-_p.m_z;
+          Real d2=dx*dx+dy*dy+dz*dz;
+          // anything within the radius must be inside the query cells, but the run may also hold points
+          // from other rows that hash to the same entries so check the row to only report each point once
+          if(d2 <= r2 && cellCoord(m_sortedY[i]) == y && cellCoord(m_sortedZ[i]) == z)
+          {
+            _func(static_cast<size_t>(m_sortedIndex[i]),d2);
+          }
+        }
+      }
+    }
+  }
+}
+
+} // end ngl namespace
+#endif
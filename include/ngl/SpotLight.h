@@ -131,6 +131,11 @@ public:
 
   void loadToShader(std::string _uniformName  )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write the light to a std140 uniform block using the Light struct layout with the spot values
+  /// @param[in] _w the writer for the block
+  //----------------------------------------------------------------------------------------------------------------------
+  void writeStd140(Std140Writer &_w) const noexcept override;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief set the transform of the light this will be multiplied by the position
   /// Vec4 pos=m_transform*m_position;
   /// @param[in] _t the transform
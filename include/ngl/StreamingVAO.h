@@ -0,0 +1,169 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STREAMINGVAO_H_
+#define STREAMINGVAO_H_
+#include "AbstractVAO.h"
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class StreamingVAO "include/StreamingVAO.h"
+/// @brief non indexed vao for data that changes every frame. When ARB_buffer_storage is available the
+/// buffer is split into NUMREGIONS regions which stay persistently mapped, each update writes the next
+/// region and a fence placed after the draw stops the CPU writing a region the GPU is still reading.
+/// With three regions the fence has normally passed by the time the ring wraps so the CPU never waits.
+/// On older contexts the buffer is orphaned with glBufferData(nullptr) instead.
+/// The attribute pointers are re-pointed at the current region on each update so use setData
+/// or mapNextRegion / unmapRegion with the VAO bound.
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT StreamingVAO : public AbstractVAO
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of regions in the ring
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr unsigned int NUMREGIONS=3;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief creator method for the factory
+    /// @param _mode the mode to draw with.
+    /// @returns a new AbstractVAO * object
+    //----------------------------------------------------------------------------------------------------------------------
+    static AbstractVAO *create(GLenum _mode=GL_TRIANGLES) { return new StreamingVAO(_mode); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the current region using glDrawArrays
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void draw() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw instances of the current region using glDrawArraysInstanced
+    /// @param _instances the number of instances to draw
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void drawInstanced(unsigned int _instances) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor clears the VAO data
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual ~StreamingVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief remove the VAO, buffer and fences
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void removeVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy the data into the next region of the ring, the buffer only grows so sending
+    /// the same or less data each frame never reallocates
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void setData(const VertexData &_data);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief records the attribute so it can be moved to the current region on each update
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise=false );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get a pointer to write the next region directly without a copy, unmapRegion must be called
+    /// before drawing
+    /// @param _size the number of bytes that will be written
+    /// @returns the write only memory for the region
+    //----------------------------------------------------------------------------------------------------------------------
+    Real *mapNextRegion(size_t _size);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finish writing the region returned by mapNextRegion
+    //----------------------------------------------------------------------------------------------------------------------
+    void unmapRegion();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief is the persistent mapped path in use (false means orphaning)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isPersistent() const {return m_persistent;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of times the CPU had to wait on a fence, should stay 0 in normal use
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int getNumStalls() const {return m_stalls;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief return the id of the buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint getBufferID(unsigned int ){return m_buffer;}
+  protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor calles parent ctor to allocate vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    StreamingVAO(GLenum _mode);
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief (re)create the buffer with regions of at least _size bytes
+    //----------------------------------------------------------------------------------------------------------------------
+    void allocate(size_t _size);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief unmap and delete the buffer and fences
+    //----------------------------------------------------------------------------------------------------------------------
+    void freeBuffer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief point the recorded attributes at the current region
+    //----------------------------------------------------------------------------------------------------------------------
+    void bindAttributes();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fence the current region after a draw
+    //----------------------------------------------------------------------------------------------------------------------
+    void fenceRegion() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a recorded vertex attribute
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Attribute
+    {
+      GLuint id;
+      GLint size;
+      GLenum type;
+      GLsizei stride;
+      unsigned int dataOffset;
+      bool normalise;
+    };
+    std::vector<Attribute> m_attributes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the id of the buffer for the VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_buffer=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the persistent mapping of the whole buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    char *m_mapped=nullptr;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the size of each region
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_regionSize=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the region last written
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_region=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fences placed after the draws reading each region
+    //----------------------------------------------------------------------------------------------------------------------
+    mutable GLsync m_fence[NUMREGIONS]={nullptr,nullptr,nullptr};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fence wait count
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_stalls=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief using buffer storage
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_persistent;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the orphaning path has a region mapped
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_orphanMapped=false;
+};
+
+} // end namespace
+#endif
@@ -0,0 +1,112 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STRINGID_H_
+#define STRINGID_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file StringID.h
+/// @brief hashed, interned names for the ShaderLib, VAOPrimitives, VAOFactory and Random registries
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief 32 bit FNV-1a hash of a string, constexpr so literals can be hashed by the compiler
+//----------------------------------------------------------------------------------------------------------------------
+constexpr uint32_t hashStringID(const char *_name, uint32_t _hash=2166136261u) noexcept
+{
+  return *_name == 0 ? _hash :
+         hashStringID(_name+1,(_hash ^ static_cast<uint32_t>(static_cast<unsigned char>(*_name)))*16777619u);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class StringID "include/ngl/StringID.h"
+/// @brief the hash of a name used as the key in the registries so a lookup is one integer hash with no
+/// string to build or compare. Names are interned (kept in a global table) when something is registered
+/// with them so getString can give the name back and a name with the same hash as a different registered
+/// name is refused. Lookups never add to the table. Declare
+/// ids constexpr or use the _sid literal so the hash is done at compile time
+/// @code
+/// using ngl::operator"" _sid;
+/// constexpr ngl::StringID c_teapot("teapot");
+/// prim->draw(c_teapot);
+/// shader->use("Phong"_sid);
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT StringID
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id of the empty string
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr StringID() noexcept : m_hash(2166136261u){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief hash a name, explicit so string and id overloads aren't ambiguous
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr explicit StringID(const char *_name) noexcept : m_hash(hashStringID(_name)){}
+  explicit StringID(const std::string &_name) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief hash and add a name to the table, called by the registries when a name is registered, safe to
+  /// call from many threads
+  /// @param[in] _name the name to register
+  /// @param[out] o_id the id of the name
+  /// @returns false if a different name already has the same id (reported on std::cerr), the registry must
+  /// then refuse the name as the two would share one entry
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool intern(const std::string &_name, StringID &o_id);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the interned name for this id, empty if it was never interned
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::string &getString() const noexcept;
+  constexpr uint32_t getHash() const noexcept{return m_hash;}
+  constexpr bool operator==(const StringID &_id) const noexcept{return m_hash == _id.m_hash;}
+  constexpr bool operator!=(const StringID &_id) const noexcept{return m_hash != _id.m_hash;}
+
+private :
+  uint32_t m_hash;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief "name"_sid makes a compile time StringID
+//----------------------------------------------------------------------------------------------------------------------
+constexpr StringID operator"" _sid(const char *_name, size_t) noexcept
+{
+  return StringID(_name);
+}
+
+} // end ngl namespace
+
+namespace std
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id is already a hash so is used as is in the unordered_maps
+  //----------------------------------------------------------------------------------------------------------------------
+  template <>
+  struct hash<ngl::StringID>
+  {
+    size_t operator()(const ngl::StringID &_id) const noexcept{return _id.getHash();}
+  };
+}
+#endif
@@ -0,0 +1,324 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UNIFORMBUFFER_H_
+#define UNIFORMBUFFER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformBuffer.h
+/// @brief std140 uniform blocks written from the C++ types and shared between programs
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec2.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mat3.h"
+#include "Mat4.h"
+#include "Colour.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the std140 base alignment, size and GLSL name of a C++ type
+//----------------------------------------------------------------------------------------------------------------------
+template <class T> struct Std140Type;
+
+template <> struct Std140Type<float>
+{
+  static constexpr size_t alignment=4;
+  static constexpr size_t size=4;
+  static const char *glsl() noexcept{return "float";}
+  static void copy(unsigned char *_dst, const float &_v) noexcept{std::memcpy(_dst,&_v,size);}
+};
+
+template <> struct Std140Type<int>
+{
+  static constexpr size_t alignment=4;
+  static constexpr size_t size=4;
+  static const char *glsl() noexcept{return "int";}
+  static void copy(unsigned char *_dst, const int &_v) noexcept{std::memcpy(_dst,&_v,size);}
+};
+
+template <> struct Std140Type<bool>
+{
+  static constexpr size_t alignment=4;
+  static constexpr size_t size=4;
+  static const char *glsl() noexcept{return "bool";}
+  static void copy(unsigned char *_dst, const bool &_v) noexcept{GLint v=_v ? 1 : 0; std::memcpy(_dst,&v,size);}
+};
+
+template <> struct Std140Type<Vec2>
+{
+  static constexpr size_t alignment=8;
+  static constexpr size_t size=8;
+  static const char *glsl() noexcept{return "vec2";}
+  static void copy(unsigned char *_dst, const Vec2 &_v) noexcept{std::memcpy(_dst,&_v.m_x,size);}
+};
+
+template <> struct Std140Type<Vec3>
+{
+  static constexpr size_t alignment=16;
+  static constexpr size_t size=12;
+  static const char *glsl() noexcept{return "vec3";}
+  static void copy(unsigned char *_dst, const Vec3 &_v) noexcept{std::memcpy(_dst,&_v.m_x,size);}
+};
+
+template <> struct Std140Type<Vec4>
+{
+  static constexpr size_t alignment=16;
+  static constexpr size_t size=16;
+  static const char *glsl() noexcept{return "vec4";}
+  static void copy(unsigned char *_dst, const Vec4 &_v) noexcept{std::memcpy(_dst,&_v.m_x,size);}
+};
+
+template <> struct Std140Type<Colour>
+{
+  static constexpr size_t alignment=16;
+  static constexpr size_t size=16;
+  static const char *glsl() noexcept{return "vec4";}
+  static void copy(unsigned char *_dst, const Colour &_v) noexcept{std::memcpy(_dst,&_v.m_r,size);}
+};
+
+// a mat3 is stored as three vec4 columns
+template <> struct Std140Type<Mat3>
+{
+  static constexpr size_t alignment=16;
+  static constexpr size_t size=48;
+  static const char *glsl() noexcept{return "mat3";}
+  static void copy(unsigned char *_dst, const Mat3 &_v) noexcept
+  {
+    for(size_t c=0; c<3; ++c)
+    {
+      std::memcpy(_dst+c*16,&_v.m_openGL[c*3],3*sizeof(float));
+    }
+  }
+};
+
+template <> struct Std140Type<Mat4>
+{
+  static constexpr size_t alignment=16;
+  static constexpr size_t size=64;
+  static const char *glsl() noexcept{return "mat4";}
+  static void copy(unsigned char *_dst, const Mat4 &_v) noexcept{std::memcpy(_dst,&_v.m_openGL[0],size);}
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Std140Writer "include/ngl/UniformBuffer.h"
+/// @brief writes values in order to a block using the std140 rules so the offsets come from the C++ types
+/// rather than being hand coded. With no destination it only measures the block, and if a declaration
+/// string is given the matching GLSL members are appended to it
+/// @code
+/// std::string glsl;
+/// ngl::Std140Writer measure(nullptr,0,&glsl);
+/// light.writeStd140(measure);
+/// // measure.getSize() is the size of one light and glsl the members of its struct
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT Std140Writer
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _data where to write or nullptr to only measure
+  /// @param[in] _capacity the size of _data in bytes, values past it are not written
+  /// @param[in] _declaration if not null the GLSL for each value is appended
+  //----------------------------------------------------------------------------------------------------------------------
+  Std140Writer(unsigned char *_data, size_t _capacity, std::string *_declaration=nullptr) noexcept :
+    m_data(_data), m_capacity(_capacity), m_declaration(_declaration){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write a value at the next offset with the alignment of its type
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class T>
+  void write(const char *_name, const T &_v) noexcept
+  {
+    m_offset=align(m_offset,Std140Type<T>::alignment);
+    if(fits(Std140Type<T>::size))
+    {
+      Std140Type<T>::copy(m_data+m_offset,_v);
+    }
+    declare(Std140Type<T>::glsl(),_name,0);
+    m_offset+=Std140Type<T>::size;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write an array, each element is padded out to a vec4
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class T>
+  void write(const char *_name, const T *_v, size_t _count) noexcept
+  {
+    size_t stride=align(Std140Type<T>::size,16);
+    m_offset=align(m_offset,16);
+    if(fits(stride*_count))
+    {
+      std::memset(m_data+m_offset,0,stride*_count);
+      for(size_t i=0; i<_count; ++i)
+      {
+        Std140Type<T>::copy(m_data+m_offset+i*stride,_v[i]);
+      }
+    }
+    declare(Std140Type<T>::glsl(),_name,_count);
+    m_offset+=stride*_count;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief structs start and end on a vec4 boundary, call around the members of each struct
+  //----------------------------------------------------------------------------------------------------------------------
+  void beginStruct() noexcept{m_offset=align(m_offset,16);}
+  void endStruct() noexcept{m_offset=align(m_offset,16);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the offset of the next value
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getOffset() const noexcept{return m_offset;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the block written so far, rounded up to a vec4
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getSize() const noexcept{return align(m_offset,16);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief round _offset up to a multiple of _alignment
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t align(size_t _offset, size_t _alignment) noexcept
+  {
+    return (_offset+_alignment-1)/_alignment*_alignment;
+  }
+
+private :
+  bool fits(size_t _size) const noexcept{return m_data != nullptr && m_offset+_size <= m_capacity;}
+  void declare(const char *_type, const char *_name, size_t _count);
+  unsigned char *m_data;
+  size_t m_capacity;
+  size_t m_offset=0;
+  std::string *m_declaration;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the offset after members of types T written in order from _offset, used by std140Size
+//----------------------------------------------------------------------------------------------------------------------
+template <class... T> struct Std140Layout;
+
+template <> struct Std140Layout<>
+{
+  static constexpr size_t end(size_t _offset) noexcept{return _offset;}
+};
+
+template <class T, class... Rest> struct Std140Layout<T,Rest...>
+{
+  static constexpr size_t end(size_t _offset) noexcept
+  {
+    return Std140Layout<Rest...>::end(Std140Writer::align(_offset,Std140Type<T>::alignment)+Std140Type<T>::size);
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the size Std140Writer::getSize gives for a block or struct of members of types T, worked out by the
+/// compiler so a fixed layout can be sized without writing one
+/// @code
+/// // mat4 view; mat4 projection; mat4 viewProjection; vec4 eye;
+/// constexpr size_t size=ngl::std140Size<ngl::Mat4,ngl::Mat4,ngl::Mat4,ngl::Vec4>();
+/// @endcode
+//----------------------------------------------------------------------------------------------------------------------
+template <class... T>
+constexpr size_t std140Size() noexcept
+{
+  return Std140Writer::align(Std140Layout<T...>::end(0),16);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformBuffer "include/ngl/UniformBuffer.h"
+/// @brief a uniform buffer holding one or more copies of a std140 block. Each copy starts on the
+/// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT so any of them can be bound with glBindBufferRange, this gives a table
+/// of blocks (say one per material) uploaded once a frame and selected per draw with a single bind. The
+/// blocks are written to a CPU copy with getWriter and upload sends everything written since the last
+/// upload in one glBufferSubData. Programs pick the block up with ShaderLib::setUniformBlockBinding.
+/// @code
+/// // layout(std140) uniform Camera { mat4 view; mat4 projection; mat4 viewProjection; vec4 eye; };
+/// ngl::UniformBuffer camera(ngl::Camera::getStd140Size());
+/// shader->setUniformBlockBinding("Camera",ngl::UniformBuffer::CAMERABINDING);
+/// // once a frame
+/// ngl::Std140Writer w=camera.getWriter();
+/// cam.writeStd140(w);
+/// camera.upload();
+/// camera.bind(ngl::UniformBuffer::CAMERABINDING);
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT UniformBuffer
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the binding points used for the NGL blocks
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr GLuint CAMERABINDING=0;
+  static constexpr GLuint LIGHTBINDING=1;
+  static constexpr GLuint MATERIALBINDING=2;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor allocates the GL buffer
+  /// @param[in] _blockSize the size of one block in bytes
+  /// @param[in] _numBlocks the number of copies of the block
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformBuffer(size_t _blockSize, size_t _numBlocks=1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor deletes the GL buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  ~UniformBuffer() noexcept;
+  UniformBuffer(const UniformBuffer &)=delete;
+  UniformBuffer & operator=(const UniformBuffer &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get a writer for a block, marking it to be uploaded
+  //----------------------------------------------------------------------------------------------------------------------
+  Std140Writer getWriter(size_t _block=0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief send the blocks written since the last upload to GL
+  //----------------------------------------------------------------------------------------------------------------------
+  void upload() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief bind a block to a uniform buffer binding point with glBindBufferRange
+  //----------------------------------------------------------------------------------------------------------------------
+  void bind(GLuint _bindingPoint, size_t _block=0) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accessors
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint getID() const noexcept{return m_id;}
+  size_t getBlockSize() const noexcept{return m_blockSize;}
+  size_t getNumBlocks() const noexcept{return m_numBlocks;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the distance between blocks in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getStride() const noexcept{return m_stride;}
+
+private :
+  GLuint m_id=0;
+  size_t m_blockSize;
+  size_t m_numBlocks;
+  size_t m_stride;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the CPU copy of the buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned char> m_data;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the range of blocks written since the last upload, m_firstDirty > m_lastDirty if none
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_firstDirty;
+  size_t m_lastDirty=0;
+};
+
+} // end ngl namespace
+#endif
@@ -0,0 +1,406 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UNIFORMHANDLE_H_
+#define UNIFORMHANDLE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformHandle.h
+/// @brief typed uniform locations resolved once and set without any string lookups
+//----------------------------------------------------------------------------------------------------------------------
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec2.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mat3.h"
+#include "Mat4.h"
+#include "Colour.h"
+#include "FrameStats.h"
+#include "StringID.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief hash of a uniform name, the same FNV-1a hash as StringID so literal names are hashed by the compiler
+//----------------------------------------------------------------------------------------------------------------------
+constexpr uint32_t hashUniformName(const char *_name) noexcept
+{
+  return hashStringID(_name);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a uniform name and its hash, declare these constexpr so the hash is done at compile time
+/// @code
+/// constexpr ngl::UniformName c_MVP("MVP");
+/// auto mvp=shader->getUniformHandle<ngl::Mat4>(c_MVP);
+/// @endcode
+//----------------------------------------------------------------------------------------------------------------------
+struct UniformName
+{
+  constexpr UniformName(const char *_name) noexcept : m_name(_name), m_hash(hashUniformName(_name)){}
+  const char *m_name;
+  uint32_t m_hash;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformShadow "include/ngl/UniformHandle.h"
+/// @brief the last value uploaded to a uniform, each registered uniform in a ShaderProgram has one and the
+/// setters (and handles) only call glUniform when the new value differs. Values bigger than a Mat4 and
+/// transposed matrices aren't shadowed and always go to GL. Setting a uniform by calling glUniform directly
+/// or changing it through a UBO / another context leaves the shadow stale, use invalidate or turn shadowing
+/// off with setEnabled(false) in that case
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT UniformShadow
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest value shadowed in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t MAXSIZE=16*sizeof(float);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _active false for a uniform that must never be shadowed such as an array element which
+  /// can also be written by an array set through an earlier element
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformShadow(bool _active=true) noexcept : m_active(_active){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compare a new value with the shadow and store it
+  /// @param[in] _data the value or nullptr to force an upload
+  /// @param[in] _size the size of the value in bytes
+  /// @returns true if the value must be passed to GL
+  //----------------------------------------------------------------------------------------------------------------------
+  bool update(const void *_data, size_t _size) noexcept
+  {
+    if(s_enabled && m_active && _data != nullptr && _size <= MAXSIZE)
+    {
+      if(_size == m_size && std::memcmp(&m_value[0],_data,_size) == 0)
+      {
+        ++s_skipped;
+        return false;
+      }
+      std::memcpy(&m_value[0],_data,_size);
+      m_size=_size;
+    }
+    else
+    {
+      m_size=0;
+    }
+    ++s_issued;
+    return true;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief forget the value so the next set always goes to GL
+  //----------------------------------------------------------------------------------------------------------------------
+  void invalidate() noexcept{m_size=0;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is this uniform shadowed at all
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isActive() const noexcept{return m_active;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief turn shadowing on (the default) or off for all programs, while off every set goes to GL
+  //----------------------------------------------------------------------------------------------------------------------
+  static void setEnabled(bool _state) noexcept{s_enabled=_state;}
+  static bool isEnabled() noexcept{return s_enabled;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of uniform uploads passed to GL / skipped since the last resetCounters
+  //----------------------------------------------------------------------------------------------------------------------
+  static uint64_t getNumIssued() noexcept{return s_issued;}
+  static uint64_t getNumSkipped() noexcept{return s_skipped;}
+  static void resetCounters() noexcept{s_issued=0; s_skipped=0;}
+
+private :
+  std::array<unsigned char,MAXSIZE> m_value;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the shadowed value, 0 if unknown
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_size=0;
+  bool m_active;
+  static bool s_enabled;
+  static uint64_t s_issued;
+  static uint64_t s_skipped;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformHandle "include/ngl/UniformHandle.h"
+/// @brief the location of a uniform in a program with the C++ type used to set it. Handles are got once
+/// from ShaderProgram::getUniformHandle or ShaderLib::getUniformHandle (which check the GLSL type matches)
+/// and then set goes straight to glUniform, skipping the call if the uniform's shadow already holds the
+/// value. As with glUniform the program must be active when set is called.
+/// Supported types are float, int, bool, Vec2, Vec3, Vec4, Colour, Mat3 and Mat4, int is also used for samplers
+/// @code
+/// auto colour=shader->getUniformHandle<ngl::Vec4>("Colour");
+/// for(auto &o : objects)
+///   colour.set(o.colour);
+/// @endcode
+/// @author Jonathan Macey
+/// @version 1.0
+/// @date 18/10/16 Initial version
+//----------------------------------------------------------------------------------------------------------------------
+template <class T>
+class UniformHandle
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor an invalid handle, setting it does nothing
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformHandle() noexcept=default;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _location the uniform location
+  /// @param[in] _program the program the location belongs to
+  /// @param[in] _shadow the uniform's shadow in the program, without one every set goes to GL
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformHandle(GLint _location, GLuint _program, UniformShadow *_shadow=nullptr) noexcept :
+    m_location(_location), m_program(_program), m_shadow(_shadow){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the value
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(const T &_v) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set an array uniform from the start of the array
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(const T *_v, size_t _count) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief does the GLSL type _type match T
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool isCompatible(GLenum _type) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accessors
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isValid() const noexcept{return m_location != -1;}
+  GLint getLocation() const noexcept{return m_location;}
+  GLuint getProgram() const noexcept{return m_program;}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check the value against the shadow
+  /// @returns true if GL needs calling
+  //----------------------------------------------------------------------------------------------------------------------
+  bool upload(const void *_data, size_t _size) const noexcept
+  {
+    if(m_shadow != nullptr && !m_shadow->update(_data,_size))
+    {
+      return false;
+    }
+    FrameStats::instance()->add(FrameStats::UNIFORMUPLOADS);
+    return true;
+  }
+  GLint m_location=-1;
+  GLuint m_program=0;
+  UniformShadow *m_shadow=nullptr;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<float>::set(const float &_v) const noexcept
+{
+  if(upload(&_v,sizeof(float)))
+  {
+    glUniform1f(m_location,_v);
+  }
+}
+template <> inline void UniformHandle<float>::set(const float *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(float)))
+  {
+    glUniform1fv(m_location,static_cast<GLsizei>(_count),_v);
+  }
+}
+template <> inline bool UniformHandle<float>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_FLOAT;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<int>::set(const int &_v) const noexcept
+{
+  if(upload(&_v,sizeof(int)))
+  {
+    glUniform1i(m_location,_v);
+  }
+}
+template <> inline void UniformHandle<int>::set(const int *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(int)))
+  {
+    glUniform1iv(m_location,static_cast<GLsizei>(_count),_v);
+  }
+}
+template <> inline bool UniformHandle<int>::isCompatible(GLenum _type) noexcept
+{
+  switch(_type)
+  {
+    case GL_INT : case GL_BOOL : case GL_SAMPLER_2D : case GL_SAMPLER_3D : case GL_SAMPLER_CUBE :
+    case GL_SAMPLER_2D_SHADOW : case GL_SAMPLER_2D_ARRAY :
+#ifndef USINGIOS_
+    case GL_SAMPLER_1D : case GL_SAMPLER_2D_RECT : case GL_SAMPLER_BUFFER : case GL_SAMPLER_2D_MULTISAMPLE :
+#endif
+      return true;
+    default : return false;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<bool>::set(const bool &_v) const noexcept
+{
+  GLint v=_v ? 1 : 0;
+  if(upload(&v,sizeof(GLint)))
+  {
+    glUniform1i(m_location,v);
+  }
+}
+template <> inline void UniformHandle<bool>::set(const bool *_v, size_t _count) const noexcept
+{
+  // GL takes bools as ints, converted so the whole array goes in one call like the int version
+  std::vector<GLint> v(_v,_v+_count);
+  if(upload(v.data(),_count*sizeof(GLint)))
+  {
+    glUniform1iv(m_location,static_cast<GLsizei>(_count),v.data());
+  }
+}
+template <> inline bool UniformHandle<bool>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_BOOL || _type == GL_INT;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<Vec2>::set(const Vec2 &_v) const noexcept
+{
+  if(upload(&_v,sizeof(Vec2)))
+  {
+    glUniform2f(m_location,_v.m_x,_v.m_y);
+  }
+}
+template <> inline void UniformHandle<Vec2>::set(const Vec2 *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(Vec2)))
+  {
+    glUniform2fv(m_location,static_cast<GLsizei>(_count),&_v[0].m_x);
+  }
+}
+template <> inline bool UniformHandle<Vec2>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_FLOAT_VEC2;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<Vec3>::set(const Vec3 &_v) const noexcept
+{
+  if(upload(&_v,sizeof(Vec3)))
+  {
+    glUniform3f(m_location,_v.m_x,_v.m_y,_v.m_z);
+  }
+}
+template <> inline void UniformHandle<Vec3>::set(const Vec3 *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(Vec3)))
+  {
+    glUniform3fv(m_location,static_cast<GLsizei>(_count),&_v[0].m_x);
+  }
+}
+template <> inline bool UniformHandle<Vec3>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_FLOAT_VEC3;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<Vec4>::set(const Vec4 &_v) const noexcept
+{
+  if(upload(&_v,sizeof(Vec4)))
+  {
+    glUniform4f(m_location,_v.m_x,_v.m_y,_v.m_z,_v.m_w);
+  }
+}
+template <> inline void UniformHandle<Vec4>::set(const Vec4 *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(Vec4)))
+  {
+    glUniform4fv(m_location,static_cast<GLsizei>(_count),&_v[0].m_x);
+  }
+}
+template <> inline bool UniformHandle<Vec4>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_FLOAT_VEC4;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<Colour>::set(const Colour &_v) const noexcept
+{
+  if(upload(&_v,sizeof(Colour)))
+  {
+    glUniform4f(m_location,_v.m_r,_v.m_g,_v.m_b,_v.m_a);
+  }
+}
+template <> inline void UniformHandle<Colour>::set(const Colour *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(Colour)))
+  {
+    glUniform4fv(m_location,static_cast<GLsizei>(_count),&_v[0].m_r);
+  }
+}
+template <> inline bool UniformHandle<Colour>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_FLOAT_VEC4;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<Mat3>::set(const Mat3 &_v) const noexcept
+{
+  if(upload(&_v,sizeof(Mat3)))
+  {
+    glUniformMatrix3fv(m_location,1,GL_FALSE,&_v.m_openGL[0]);
+  }
+}
+template <> inline void UniformHandle<Mat3>::set(const Mat3 *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(Mat3)))
+  {
+    glUniformMatrix3fv(m_location,static_cast<GLsizei>(_count),GL_FALSE,&_v[0].m_openGL[0]);
+  }
+}
+template <> inline bool UniformHandle<Mat3>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_FLOAT_MAT3;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <> inline void UniformHandle<Mat4>::set(const Mat4 &_v) const noexcept
+{
+  if(upload(&_v,sizeof(Mat4)))
+  {
+    glUniformMatrix4fv(m_location,1,GL_FALSE,&_v.m_openGL[0]);
+  }
+}
+template <> inline void UniformHandle<Mat4>::set(const Mat4 *_v, size_t _count) const noexcept
+{
+  if(upload(_v,_count*sizeof(Mat4)))
+  {
+    glUniformMatrix4fv(m_location,static_cast<GLsizei>(_count),GL_FALSE,&_v[0].m_openGL[0]);
+  }
+}
+template <> inline bool UniformHandle<Mat4>::isCompatible(GLenum _type) noexcept
+{
+  return _type == GL_FLOAT_MAT4;
+}
+
+} // end ngl namespace
+#endif
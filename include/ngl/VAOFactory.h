@@ -19,6 +19,7 @@
 
 #include "Types.h"
 #include "AbstractVAO.h"
+#include "StringID.h"
 #include <unordered_map>
 #include <string>
 #include <functional>
@@ -58,13 +59,17 @@ class NGL_DLLEXPORT VAOFactory
     //----------------------------------------------------------------------------------------------------------------------
     static AbstractVAO *createVAO(const std::string &_type, GLenum _mode=GL_TRIANGLES);
     //----------------------------------------------------------------------------------------------------------------------
+    /// Create an instance of a VAO from the id of a creator's name, a hashed lookup with no string built
+    //----------------------------------------------------------------------------------------------------------------------
+    static AbstractVAO *createVAO(StringID _type, GLenum _mode=GL_TRIANGLES);
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief debug function to list all creators
     //----------------------------------------------------------------------------------------------------------------------
     static void listCreators();
     private :
     //----------------------------------------------------------------------------------------------------------------------
     //----------------------------------------------------------------------------------------------------------------------
-      static std::unordered_map<std::string, std::function<AbstractVAO *(GLenum _mode)>> m_vaoCreators;
+      static std::unordered_map<StringID, std::function<AbstractVAO *(GLenum _mode)>> m_vaoCreators;
 
 };
 
@@ -22,6 +22,7 @@
 #include "Types.h"
 #include "Vec3.h"
 #include "AbstractVAO.h"
+#include "StringID.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -29,6 +30,8 @@
 
 namespace ngl
 {
+class InstancedVAO;
+class GeometryPool;
 //----------------------------------------------------------------------------------------------------------------------
 /// @class VAOPrimitives "include/VAOPrimitives.h"
 /// @brief VAO based object primitives used for fast openGL drawing this is a singelton class
@@ -70,6 +73,27 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   void draw( const std::string &_name,GLenum _mode ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Draw many copies of one of the VAO's in a single call, per instance data can be set
+  /// using getInstancedVAO or the shader can use gl_InstanceID
+  /// @param[in] _name the name of the VAO to lookup in the VAO map
+  /// @param[in] _instances the number of instances to draw
+  //----------------------------------------------------------------------------------------------------------------------
+  void drawInstanced( const std::string &_name,unsigned int _instances ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the draw methods by the id of the VAO's name, a hashed lookup with no string built
+  //----------------------------------------------------------------------------------------------------------------------
+  void draw( StringID _name ) noexcept;
+  void draw( StringID _name,GLenum _mode ) noexcept;
+  void drawInstanced( StringID _name,unsigned int _instances ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy one of the VAO's into a GeometryPool, the data is read back from the VAO. Strips and fans
+  /// are converted to triangle lists, line and point primitives can't be pooled
+  /// @param[in] _name the name of the VAO to lookup in the VAO map
+  /// @param[in] _pool the pool to add to
+  /// @returns the id of the mesh in the pool or GeometryPool::INVALID
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addToPool( const std::string &_name, GeometryPool &_pool ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief create a triangulated Sphere as a vbo with auto generated texture cords
   /// @param[in] _name the name of the object created used when drawing
   /// @param[in] _radius the sphere radius
@@ -158,12 +182,16 @@ public :
   void clear() noexcept;
   /// @brief get the raw VAO so we can map it etc
   AbstractVAO * getVAOFromName(const std::string &_name);
+  AbstractVAO * getVAOFromName(StringID _name);
+  /// @brief get the VAO as an InstancedVAO so per instance streams can be attached
+  /// @returns nullptr if the name is not found or the VAO was not created as an InstancedVAO
+  InstancedVAO * getInstancedVAO(const std::string &_name);
 
 private :
 	//----------------------------------------------------------------------------------------------------------------------
 	///  a map to store the VAO by name
 	//----------------------------------------------------------------------------------------------------------------------
-  std::unordered_map <std::string,AbstractVAO *> m_createdVAOs;
+  std::unordered_map <StringID,AbstractVAO *> m_createdVAOs;
 
 	//----------------------------------------------------------------------------------------------------------------------
 	/// @brief default constructor
@@ -16,11 +16,16 @@
 */
 
 #include "AbstractMesh.h"
+#include "CPUProfiler.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include "Util.h"
 #include <list>
 #include "NGLStream.h"
 #include "VAOFactory.h"
 #include "SimpleVAO.h"
+#include "GeometryPool.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file AbstractMesh.cpp
 /// @brief a series of classes used to define an abstract 3D mesh of Faces, Vertex Normals and TexCords
@@ -28,6 +33,7 @@
 
 namespace ngl
 {
+using namespace dispatch;
   //----------------------------------------------------------------------------------------------------------------------
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -70,9 +76,23 @@ AbstractMesh::~AbstractMesh() noexcept
 
     if(m_vbo)
     {
-      glDeleteBuffers(1,&m_vboBuffers);
+      GLState::instance()->deleteBuffers(1,&m_vboBuffers);
+      ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
     }
   }
+  ResourceTracker::instance()->release(ResourceTracker::MESH,this);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::trackMemory(const std::string &_tag) const
+{
+  size_t bytes=(m_verts.size()+m_norm.size()+m_tex.size())*sizeof(Vec3)+m_indices.size()*sizeof(IndexRef)+
+               m_outIndices.size()*sizeof(GLuint);
+  for(auto &f : m_face)
+  {
+    bytes+=sizeof(Face)+(f.m_vert.size()+f.m_tex.size()+f.m_norm.size())*sizeof(uint32_t);
+  }
+  ResourceTracker::instance()->track(ResourceTracker::MESH,this,bytes,_tag);
 }
 
 
@@ -213,6 +233,7 @@ struct VertData
 
 void AbstractMesh::createVAO() noexcept
 {
+	NGL_PROFILE_SCOPE("AbstractMesh::createVAO");
 	// if we have already created a VBO just return.
 	if(m_vao == true)
 	{
@@ -327,11 +348,39 @@ void AbstractMesh::createVAO() noexcept
 
 	// indicate we have a vao now
 	m_vao=true;
+  // tag the VAO's buffer with the mesh it was made from
+  ResourceTracker *tracker=ResourceTracker::instance();
+  std::string tag=tracker->getTag(ResourceTracker::MESH,this);
+  if(!tag.empty())
+  {
+    tracker->setTag(ResourceTracker::BUFFER,m_vaoMesh.get(),tag);
+  }
 
 }
 
 
 
+//----------------------------------------------------------------------------------------------------------------------
+size_t AbstractMesh::addToPool(GeometryPool &_pool) noexcept
+{
+  if(m_vao == false)
+  {
+    createVAO();
+  }
+  // copy out and unmap before adding as the pool binds its own buffers
+  std::vector<Real> verts(m_meshSize*GeometryPool::VERTEXSIZE);
+  Real *ptr=mapVAOVerts();
+  if(ptr == nullptr)
+  {
+    unMapVAO();
+    std::cerr<<"unable to read mesh data for the GeometryPool\n";
+    return GeometryPool::INVALID;
+  }
+  std::copy(ptr,ptr+verts.size(),verts.begin());
+  unMapVAO();
+  return _pool.addMesh(&verts[0],m_meshSize,nullptr,0);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::draw() const noexcept
 {
@@ -339,11 +388,11 @@ void AbstractMesh::draw() const noexcept
   {
     if(m_texture == true)
     {
-      glBindTexture(GL_TEXTURE_2D,m_textureID);
+      GLState::instance()->bindTexture(GL_TEXTURE_2D,m_textureID);
     }
+    // the VAO is left bound, GLState skips the bind if this mesh is drawn again next
     m_vaoMesh->bind();
     m_vaoMesh->draw();
-    m_vaoMesh->unbind();
   }
 
 }
@@ -359,7 +408,7 @@ Real * AbstractMesh::mapVAOVerts() noexcept
 //
   m_vaoMesh->bind();
   //NGLCheckGLError("Abstract Mesh",__LINE__);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vaoMesh->getBufferID(0));
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_vaoMesh->getBufferID(0));
   //NGLCheckGLError("Abstract Mesh",__LINE__);
 #ifndef USINGIOS_
   ptr = static_cast<Real *>(glMapBuffer(GL_ARRAY_BUFFER, GL_READ_WRITE));
@@ -371,6 +420,20 @@ Real * AbstractMesh::mapVAOVerts() noexcept
   return ptr;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+Real * AbstractMesh::mapVAOVertsWrite() noexcept
+{
+  Real* ptr=nullptr;
+  m_vaoMesh->bind();
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_vaoMesh->getBufferID(0));
+#ifndef USINGIOS_
+  ptr = static_cast<Real *>(glMapBufferRange(GL_ARRAY_BUFFER,0,static_cast<GLsizeiptr>(m_meshSize*sizeof(VertData)),
+                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+#endif
+  m_vboMapped=true;
+  return ptr;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::unMapVAO() noexcept
 {
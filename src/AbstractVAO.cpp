@@ -1,4 +1,6 @@
 #include "AbstractVAO.h"
+#include "FrameStats.h"
+#include "GLState.h"
 #include <iostream>
 namespace ngl
 {
@@ -22,17 +24,32 @@ namespace ngl
   //----------------------------------------------------------------------------------------------------------------------
   void AbstractVAO::bind()
   {
-    glBindVertexArray(m_id);
+    GLState::instance()->bindVertexArray(m_id);
     m_bound=true;
   }
   //----------------------------------------------------------------------------------------------------------------------
   void AbstractVAO::unbind()
   {
-    glBindVertexArray(0);
+    GLState::instance()->bindVertexArray(0);
     m_bound=false;
   }
 
 
+  //----------------------------------------------------------------------------------------------------------------------
+  void AbstractVAO::drawInstanced(unsigned int _instances) const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    glDrawArraysInstanced(m_mode, 0, static_cast<GLsizei>(m_indicesCount), static_cast<GLsizei>(_instances));
+    FrameStats::instance()->addDraw(m_mode,m_indicesCount,_instances);
+  }
+
   void AbstractVAO::setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise )
   {
     if(m_bound !=true)
@@ -19,11 +19,13 @@
 /// @brief a simple bounding box class
 //----------------------------------------------------------------------------------------------------------------------
 #include "BBox.h"
+#include "GLDispatch.h"
 #include "VAOFactory.h"
 #include "SimpleIndexVAO.h"
 #include <iostream>
 namespace ngl
 {
+using namespace dispatch;
 constexpr GLubyte indices[]=  {
                                     0,1,5,0,4,5, // back
                                     3,2,6,7,6,3, // front
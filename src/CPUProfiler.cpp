@@ -0,0 +1,224 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "CPUProfiler.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CPUProfiler.cpp
+/// @brief implementation files for CPUProfiler class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+constexpr size_t CPUProfiler::EVENTSPERTHREAD;
+
+namespace
+{
+  const std::chrono::steady_clock::time_point s_epoch=std::chrono::steady_clock::now();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CPUProfiler *CPUProfiler::instance() noexcept
+{
+  // never deleted so threads still running at exit can record safely
+  static CPUProfiler *s_profiler=new CPUProfiler;
+  return s_profiler;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t CPUProfiler::now() noexcept
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now()-s_epoch).count());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CPUProfiler::ThreadBuffer &CPUProfiler::threadBuffer()
+{
+  // gives the buffer back when the thread exits, the profiler is never deleted so this is safe at exit
+  struct Owner
+  {
+    ThreadBuffer *buffer=nullptr;
+    ~Owner()
+    {
+      if(buffer != nullptr)
+      {
+        CPUProfiler::instance()->releaseBuffer(buffer);
+      }
+    }
+  };
+  static thread_local Owner t_owner;
+  if(t_owner.buffer == nullptr)
+  {
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    if(!m_freeBuffers.empty())
+    {
+      // the mutex orders the old thread's writes before this thread's
+      t_owner.buffer=m_freeBuffers.back();
+      m_freeBuffers.pop_back();
+    }
+    else
+    {
+      std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+      buffer->events.reset(new Event[EVENTSPERTHREAD]);
+      buffer->id=static_cast<unsigned int>(m_threads.size());
+      buffer->name="thread "+std::to_string(buffer->id);
+      t_owner.buffer=buffer.get();
+      m_threads.push_back(std::move(buffer));
+    }
+  }
+  return *t_owner.buffer;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPUProfiler::releaseBuffer(ThreadBuffer *_buffer)
+{
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  _buffer->name="thread "+std::to_string(_buffer->id);
+  m_freeBuffers.push_back(_buffer);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPUProfiler::record(const char *_name, uint64_t _start, uint64_t _end) noexcept
+{
+  ThreadBuffer &buffer=threadBuffer();
+  // only this thread writes count so a relaxed load is enough, the release publishes the event
+  size_t index=buffer.count.load(std::memory_order_relaxed);
+  if(index >= EVENTSPERTHREAD)
+  {
+    buffer.dropped.fetch_add(1,std::memory_order_relaxed);
+    return;
+  }
+  buffer.events[index]={_name,_start,_end};
+  buffer.count.store(index+1,std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPUProfiler::setThreadName(const std::string &_name)
+{
+  ThreadBuffer &buffer=threadBuffer();
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  buffer.name=_name;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t CPUProfiler::getNumThreads() const
+{
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  return m_threads.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPUProfiler::getEvents(size_t _thread, std::vector<Event> &o_events) const
+{
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  o_events.clear();
+  if(_thread >= m_threads.size())
+  {
+    return;
+  }
+  const ThreadBuffer &buffer=*m_threads[_thread];
+  size_t count=buffer.count.load(std::memory_order_acquire);
+  o_events.assign(buffer.events.get(),buffer.events.get()+count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t CPUProfiler::getNumEvents() const
+{
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  size_t total=0;
+  for(auto &t : m_threads)
+  {
+    total+=t->count.load(std::memory_order_acquire);
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t CPUProfiler::getNumDropped() const
+{
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  uint64_t total=0;
+  for(auto &t : m_threads)
+  {
+    total+=t->dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CPUProfiler::writeChromeTrace(const std::string &_fname) const
+{
+  std::ofstream file(_fname);
+  if(!file.is_open())
+  {
+    std::cerr<<"CPUProfiler can't write trace "<<_fname<<"\n";
+    return false;
+  }
+  namespace rj=rapidjson;
+  rj::StringBuffer stream;
+  rj::Writer<rj::StringBuffer> writer(stream);
+  writer.StartObject();
+  writer.Key("traceEvents");
+  writer.StartArray();
+  {
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    for(auto &t : m_threads)
+    {
+      writer.StartObject();
+      writer.Key("name"); writer.String("thread_name");
+      writer.Key("ph"); writer.String("M");
+      writer.Key("pid"); writer.Int(1);
+      writer.Key("tid"); writer.Uint(t->id);
+      writer.Key("args"); writer.StartObject(); writer.Key("name"); writer.String(t->name.c_str()); writer.EndObject();
+      writer.EndObject();
+      size_t count=t->count.load(std::memory_order_acquire);
+      for(size_t i=0; i<count; ++i)
+      {
+        const Event &e=t->events[i];
+        writer.StartObject();
+        writer.Key("name"); writer.String(e.name);
+        writer.Key("cat"); writer.String("cpu");
+        writer.Key("ph"); writer.String("X");
+        writer.Key("pid"); writer.Int(1);
+        writer.Key("tid"); writer.Uint(t->id);
+        writer.Key("ts"); writer.Double(static_cast<double>(e.start)*1.0e-3);
+        writer.Key("dur"); writer.Double(static_cast<double>(e.end-e.start)*1.0e-3);
+        writer.EndObject();
+      }
+    }
+  }
+  writer.EndArray();
+  writer.EndObject();
+  file<<stream.GetString();
+  return file.good();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPUProfiler::clear()
+{
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  for(auto &t : m_threads)
+  {
+    t->count.store(0,std::memory_order_release);
+    t->dropped.store(0,std::memory_order_relaxed);
+  }
+}
+
+} // end ngl namespace
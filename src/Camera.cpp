@@ -19,6 +19,7 @@
 #include "NGLassert.h"
 #include "VAOFactory.h"
 #include "SimpleVAO.h"
+#include "UniformBuffer.h"
 #include <vector>
 #include "Vec3.h"
 #include <iostream>
@@ -352,6 +353,22 @@ void Camera::writeRib( RibExport &_rib ) const noexcept
 		_rib.getStream() <<"#End of Camera from GraphicsLib\n";
 	}
 }
+//----------------------------------------------------------------------------------------------------------------------
+void Camera::writeStd140(Std140Writer &_w) const noexcept
+{
+  _w.write("view",m_viewMatrix);
+  _w.write("projection",m_projectionMatrix);
+  _w.write("viewProjection",getVPMatrix());
+  _w.write("eye",m_eye);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t Camera::getStd140Size() noexcept
+{
+  // view, projection, viewProjection and eye as written by writeStd140
+  return std140Size<Mat4,Mat4,Mat4,Vec4>();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 /// Code modified from http://www.lighthouse3d.com/opengl/viewfrustum/index.php?intro
 ///
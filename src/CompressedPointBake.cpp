@@ -0,0 +1,409 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "CompressedPointBake.h"
+#include "NCCAPointBake.h"
+#include "NGLassert.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <cstring>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CompressedPointBake.cpp
+/// @brief implementation files for CompressedPointBake class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+constexpr unsigned int CompressedPointBake::BLOCKSIZE;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  // the on disk header, followed by numFrames+1 uint64 frame offsets then the frames. Each frame is
+  // the float min and step for x,y,z then the x, y and z residual streams. A stream is a run of blocks
+  // of a width byte followed by BLOCKSIZE values packed little endian at that width
+  //----------------------------------------------------------------------------------------------------------------------
+  struct FileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t numFrames;
+    uint32_t numVerts;
+    uint32_t startFrame;
+    uint32_t bits;
+    uint32_t keyframeInterval;
+  };
+  const char c_magic[8]={'n','g','l','p','b','c','1','\0'};
+  constexpr uint32_t c_version=1;
+  constexpr unsigned int c_maxBits=24;
+  // the unpacker reads 8 bytes at a time so the buffer is padded
+  constexpr size_t c_readPadding=8;
+
+  inline uint32_t zigzag(int32_t _v) noexcept
+  {
+    return (static_cast<uint32_t>(_v) << 1) ^ static_cast<uint32_t>(_v >> 31);
+  }
+
+  inline int32_t unzigzag(uint32_t _v) noexcept
+  {
+    return static_cast<int32_t>(_v >> 1) ^ -static_cast<int32_t>(_v & 1);
+  }
+
+  inline unsigned int bitWidth(uint32_t _v) noexcept
+  {
+    unsigned int w=0;
+    while(_v)
+    {
+      ++w;
+      _v>>=1;
+    }
+    return w;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  // pack _count residuals as blocks onto the end of o_out
+  //----------------------------------------------------------------------------------------------------------------------
+  void packStream(const uint32_t *_values, size_t _count, std::vector<char> &o_out)
+  {
+    for(size_t b=0; b<_count; b+=CompressedPointBake::BLOCKSIZE)
+    {
+      size_t n=std::min<size_t>(CompressedPointBake::BLOCKSIZE,_count-b);
+      uint32_t all=0;
+      for(size_t i=0; i<n; ++i)
+      {
+        all|=_values[b+i];
+      }
+      unsigned int width=bitWidth(all);
+      o_out.push_back(static_cast<char>(width));
+      uint64_t acc=0;
+      unsigned int accBits=0;
+      for(size_t i=0; i<n && width!=0; ++i)
+      {
+        acc|=static_cast<uint64_t>(_values[b+i]) << accBits;
+        accBits+=width;
+        while(accBits >= 8)
+        {
+          o_out.push_back(static_cast<char>(acc & 0xff));
+          acc>>=8;
+          accBits-=8;
+        }
+      }
+      if(accBits != 0)
+      {
+        o_out.push_back(static_cast<char>(acc & 0xff));
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  // unpack _count residuals and add them to the prediction in io_q, returns the end of the stream
+  // on keyframes the prediction is the previous vertex otherwise it is the same vertex last frame.
+  // The temporal residuals are exact integers so subtracting them (_sign -1) steps back a frame
+  //----------------------------------------------------------------------------------------------------------------------
+  const char *unpackStream(const char *_src, size_t _count, bool _key, int32_t _sign, uint32_t * __restrict io_q) noexcept
+  {
+    uint32_t prev=0;
+    for(size_t b=0; b<_count; b+=CompressedPointBake::BLOCKSIZE)
+    {
+      size_t n=std::min<size_t>(CompressedPointBake::BLOCKSIZE,_count-b);
+      unsigned int width=static_cast<unsigned char>(*_src++);
+      uint64_t mask=(uint64_t(1) << width)-1;
+      uint32_t *q=io_q+b;
+      if(_key)
+      {
+        for(size_t i=0; i<n; ++i)
+        {
+          size_t bit=i*width;
+          uint64_t v;
+          std::memcpy(&v,_src+(bit>>3),sizeof(uint64_t));
+          prev+=static_cast<uint32_t>(unzigzag(static_cast<uint32_t>((v >> (bit&7)) & mask)));
+          q[i]=prev;
+        }
+      }
+      else if(width != 0)
+      {
+        for(size_t i=0; i<n; ++i)
+        {
+          size_t bit=i*width;
+          uint64_t v;
+          std::memcpy(&v,_src+(bit>>3),sizeof(uint64_t));
+          q[i]+=static_cast<uint32_t>(_sign*unzigzag(static_cast<uint32_t>((v >> (bit&7)) & mask)));
+        }
+      }
+      _src+=(n*width+7)/8;
+    }
+    return _src;
+  }
+
+  template<typename T>
+  inline void appendPOD(std::vector<char> &o_out, const T &_v)
+  {
+    const char *p=reinterpret_cast<const char *>(&_v);
+    o_out.insert(o_out.end(),p,p+sizeof(T));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CompressedPointBake::CompressedPointBake(const std::string &_fileName) noexcept
+{
+  load(_fileName);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CompressedPointBake::load(const std::string &_fileName) noexcept
+{
+  m_data.clear();
+  m_frameOffset.clear();
+  m_numFrames=m_numVerts=0;
+  m_decodedFrame=-1;
+  std::ifstream file(_fileName.c_str(),std::ios::in | std::ios::binary);
+  if(!file.is_open())
+  {
+    std::cerr<<"problems Opening File "<<_fileName<<"\n";
+    return false;
+  }
+  m_data.assign(std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>());
+  FileHeader header;
+  if(m_data.size() < sizeof(FileHeader) || std::memcmp(m_data.data(),c_magic,sizeof(c_magic)) != 0)
+  {
+    std::cerr<<_fileName<<" is not a compressed point bake file\n";
+    m_data.clear();
+    return false;
+  }
+  std::memcpy(&header,m_data.data(),sizeof(FileHeader));
+  size_t tableSize=(static_cast<size_t>(header.numFrames)+1)*sizeof(uint64_t);
+  if(header.version != c_version || header.bits == 0 || header.bits > c_maxBits ||
+     m_data.size() < sizeof(FileHeader)+tableSize)
+  {
+    std::cerr<<"unsupported compressed point bake "<<_fileName<<"\n";
+    m_data.clear();
+    return false;
+  }
+  m_frameOffset.resize(header.numFrames+1);
+  std::memcpy(m_frameOffset.data(),m_data.data()+sizeof(FileHeader),tableSize);
+  if(m_frameOffset.back() > m_data.size())
+  {
+    std::cerr<<"truncated compressed point bake "<<_fileName<<"\n";
+    m_data.clear();
+    m_frameOffset.clear();
+    return false;
+  }
+  m_data.resize(m_data.size()+c_readPadding,0);
+  m_numFrames=header.numFrames;
+  m_numVerts=header.numVerts;
+  m_startFrame=header.startFrame;
+  m_bits=header.bits;
+  m_keyframeInterval=std::max(1u,header.keyframeInterval);
+  m_q.assign(static_cast<size_t>(m_numVerts)*3,0);
+  m_frame.resize(m_numVerts);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t CompressedPointBake::getCompressedSize() const noexcept
+{
+  return m_data.empty() ? 0 : m_data.size()-c_readPadding;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real CompressedPointBake::getCompressionRatio() const noexcept
+{
+  size_t size=getCompressedSize();
+  return size==0 ? 0.0f : static_cast<Real>(getRawSize())/static_cast<Real>(size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CompressedPointBake::decodeIntegers(unsigned int _frame) noexcept
+{
+  bool key=(_frame % m_keyframeInterval)==0;
+  NGL_ASSERT(key || m_decodedFrame==static_cast<long>(_frame)-1);
+  const char *src=m_data.data()+m_frameOffset[_frame]+6*sizeof(float);
+  for(size_t c=0; c<3; ++c)
+  {
+    src=unpackStream(src,m_numVerts,key,1,&m_q[c*m_numVerts]);
+  }
+  m_decodedFrame=_frame;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CompressedPointBake::undoIntegers() noexcept
+{
+  NGL_ASSERT(m_decodedFrame > 0 && m_decodedFrame % m_keyframeInterval != 0);
+  const char *src=m_data.data()+m_frameOffset[static_cast<size_t>(m_decodedFrame)]+6*sizeof(float);
+  for(size_t c=0; c<3; ++c)
+  {
+    src=unpackStream(src,m_numVerts,false,-1,&m_q[c*m_numVerts]);
+  }
+  --m_decodedFrame;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CompressedPointBake::seek(unsigned int _frame) noexcept
+{
+  if(m_decodedFrame==static_cast<long>(_frame))
+  {
+    return;
+  }
+  long target=static_cast<long>(_frame);
+  long key=static_cast<long>(_frame-_frame%m_keyframeInterval);
+  // scrubbing backwards within the keyframe interval undoes frames if that is cheaper than starting over
+  if(m_decodedFrame > target && m_decodedFrame-key < static_cast<long>(m_keyframeInterval) &&
+     m_decodedFrame-target <= target-key+1)
+  {
+    while(m_decodedFrame > target)
+    {
+      undoIntegers();
+    }
+    return;
+  }
+  // carry on from the current frame if it is between the keyframe and the target
+  long from= (m_decodedFrame >= key && m_decodedFrame < target) ? m_decodedFrame+1 : key;
+  for(long f=from; f<=target; ++f)
+  {
+    decodeIntegers(static_cast<unsigned int>(f));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CompressedPointBake::decodeFrame(unsigned int _frame, Vec3 *o_verts) noexcept
+{
+  NGL_ASSERT(_frame < m_numFrames);
+  seek(_frame);
+  float bounds[6];
+  std::memcpy(bounds,m_data.data()+m_frameOffset[_frame],sizeof(bounds));
+  const uint32_t * __restrict qx=&m_q[0];
+  const uint32_t * __restrict qy=&m_q[m_numVerts];
+  const uint32_t * __restrict qz=&m_q[2*static_cast<size_t>(m_numVerts)];
+  for(size_t i=0; i<m_numVerts; ++i)
+  {
+    o_verts[i].set(bounds[0]+static_cast<Real>(qx[i])*bounds[3],
+                   bounds[1]+static_cast<Real>(qy[i])*bounds[4],
+                   bounds[2]+static_cast<Real>(qz[i])*bounds[5]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const std::vector<Vec3> &CompressedPointBake::getFrame(unsigned int _frame) noexcept
+{
+  if(m_numVerts != 0)
+  {
+    decodeFrame(_frame,&m_frame[0]);
+  }
+  return m_frame;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CompressedPointBake::save(const std::string &_fileName, const std::vector<std::vector<Vec3>> &_frames, unsigned int _startFrame,
+                               unsigned int _bits, unsigned int _keyframeInterval) noexcept
+{
+  size_t numVerts= _frames.empty() ? 0 : _frames[0].size();
+  for(auto &f : _frames)
+  {
+    if(f.size() != numVerts)
+    {
+      std::cerr<<"all frames must have the same number of vertices to save "<<_fileName<<"\n";
+      return false;
+    }
+  }
+  _bits=std::min(std::max(_bits,1u),c_maxBits);
+  _keyframeInterval=std::max(_keyframeInterval,1u);
+  std::ofstream file(_fileName.c_str(),std::ios::out | std::ios::binary);
+  if(!file.is_open())
+  {
+    std::cerr<<"problems Opening File "<<_fileName<<"\n";
+    return false;
+  }
+  FileHeader header;
+  std::memcpy(header.magic,c_magic,sizeof(c_magic));
+  header.version=c_version;
+  header.numFrames=static_cast<uint32_t>(_frames.size());
+  header.numVerts=static_cast<uint32_t>(numVerts);
+  header.startFrame=_startFrame;
+  header.bits=_bits;
+  header.keyframeInterval=_keyframeInterval;
+
+  float maxQ=static_cast<float>((1u << _bits)-1);
+  std::vector<uint32_t> q(numVerts*3);
+  std::vector<uint32_t> prevQ(numVerts*3);
+  std::vector<uint32_t> residual(numVerts);
+  std::vector<uint64_t> offsets;
+  std::vector<char> body;
+  uint64_t base=sizeof(FileHeader)+(_frames.size()+1)*sizeof(uint64_t);
+  for(size_t f=0; f<_frames.size(); ++f)
+  {
+    offsets.push_back(base+body.size());
+    const std::vector<Vec3> &verts=_frames[f];
+    float bounds[6];
+    for(size_t c=0; c<3; ++c)
+    {
+      float minV=0.0f;
+      float maxV=0.0f;
+      if(numVerts != 0)
+      {
+        minV=maxV=verts[0].m_openGL[c];
+      }
+      for(auto &v : verts)
+      {
+        minV=std::min(minV,v.m_openGL[c]);
+        maxV=std::max(maxV,v.m_openGL[c]);
+      }
+      float step=(maxV-minV)/maxQ;
+      float scale= step > 0.0f ? 1.0f/step : 0.0f;
+      bounds[c]=minV;
+      bounds[c+3]=step;
+      uint32_t *qc=&q[c*numVerts];
+      for(size_t i=0; i<numVerts; ++i)
+      {
+        float s=(verts[i].m_openGL[c]-minV)*scale+0.5f;
+        qc[i]=static_cast<uint32_t>(std::min(std::max(s,0.0f),maxQ));
+      }
+    }
+    for(auto b : bounds)
+    {
+      appendPOD(body,b);
+    }
+    bool key=(f % _keyframeInterval)==0;
+    for(size_t c=0; c<3; ++c)
+    {
+      const uint32_t *qc=&q[c*numVerts];
+      const uint32_t *pc=&prevQ[c*numVerts];
+      for(size_t i=0; i<numVerts; ++i)
+      {
+        uint32_t prediction= key ? (i==0 ? 0 : qc[i-1]) : pc[i];
+        residual[i]=zigzag(static_cast<int32_t>(qc[i]-prediction));
+      }
+      packStream(residual.data(),numVerts,body);
+    }
+    q.swap(prevQ);
+  }
+  offsets.push_back(base+body.size());
+  file.write(reinterpret_cast<const char *>(&header),sizeof(FileHeader));
+  file.write(reinterpret_cast<const char *>(offsets.data()),static_cast<std::streamsize>(offsets.size()*sizeof(uint64_t)));
+  if(!body.empty())
+  {
+    file.write(&body[0],static_cast<std::streamsize>(body.size()));
+  }
+  return file.good();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CompressedPointBake::save(const std::string &_fileName, NCCAPointBake &_bake, unsigned int _bits, unsigned int _keyframeInterval) noexcept
+{
+  return save(_fileName,_bake.getRawDataPointer(),_bake.getStartFrame(),_bits,_keyframeInterval);
+}
+
+} // end ngl namespace
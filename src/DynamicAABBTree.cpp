@@ -0,0 +1,661 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "DynamicAABBTree.h"
+#include "BBox.h"
+#include "Camera.h"
+#include "Plane.h"
+#include "NGLassert.h"
+#include <algorithm>
+#include <cmath>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DynamicAABBTree.cpp
+/// @brief implementation files for DynamicAABBTree class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+constexpr int DynamicAABBTree::NULLNODE;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  // helpers for the min / max box maths, kept local as the ngl AABB class is corner / extent based
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Vec3 vmin(const Vec3 &_a, const Vec3 &_b) noexcept
+  {
+    return Vec3(std::min(_a.m_x,_b.m_x),std::min(_a.m_y,_b.m_y),std::min(_a.m_z,_b.m_z));
+  }
+
+  inline Vec3 vmax(const Vec3 &_a, const Vec3 &_b) noexcept
+  {
+    return Vec3(std::max(_a.m_x,_b.m_x),std::max(_a.m_y,_b.m_y),std::max(_a.m_z,_b.m_z));
+  }
+  // surface area of the box used for the SAH cost
+  inline Real area(const Vec3 &_min, const Vec3 &_max) noexcept
+  {
+    Real dx=_max.m_x-_min.m_x;
+    Real dy=_max.m_y-_min.m_y;
+    Real dz=_max.m_z-_min.m_z;
+    return 2.0f*(dx*dy+dy*dz+dz*dx);
+  }
+
+  inline bool contains(const Vec3 &_outerMin, const Vec3 &_outerMax, const Vec3 &_min, const Vec3 &_max) noexcept
+  {
+    return _outerMin.m_x <= _min.m_x && _outerMin.m_y <= _min.m_y && _outerMin.m_z <= _min.m_z &&
+           _max.m_x <= _outerMax.m_x && _max.m_y <= _outerMax.m_y && _max.m_z <= _outerMax.m_z;
+  }
+
+  inline bool overlaps(const Vec3 &_aMin, const Vec3 &_aMax, const Vec3 &_bMin, const Vec3 &_bMax) noexcept
+  {
+    return _aMin.m_x <= _bMax.m_x && _aMax.m_x >= _bMin.m_x &&
+           _aMin.m_y <= _bMax.m_y && _aMax.m_y >= _bMin.m_y &&
+           _aMin.m_z <= _bMax.m_z && _aMax.m_z >= _bMin.m_z;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+DynamicAABBTree::DynamicAABBTree(Real _margin, Real _displacementScale) noexcept :
+  m_margin(_margin), m_displacementScale(_displacementScale)
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int DynamicAABBTree::allocateNode()
+{
+  if(m_freeList == NULLNODE)
+  {
+    // grow the pool and thread the new nodes onto the free list
+    size_t oldSize=m_nodes.size();
+    size_t newSize= oldSize == 0 ? 16 : oldSize*2;
+    m_nodes.resize(newSize);
+    for(size_t i=oldSize; i<newSize-1; ++i)
+    {
+      m_nodes[i].m_parent=static_cast<int>(i+1);
+      m_nodes[i].m_height=-1;
+    }
+    m_nodes[newSize-1].m_parent=NULLNODE;
+    m_nodes[newSize-1].m_height=-1;
+    m_freeList=static_cast<int>(oldSize);
+  }
+  int id=m_freeList;
+  TreeNode &node=m_nodes[id];
+  m_freeList=node.m_parent;
+  node.m_parent=NULLNODE;
+  node.m_child1=NULLNODE;
+  node.m_child2=NULLNODE;
+  node.m_height=0;
+  node.m_userData=0;
+  return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::freeNode(int _id) noexcept
+{
+  NGL_ASSERT(_id>=0 && _id < static_cast<int>(m_nodes.size()));
+  m_nodes[_id].m_parent=m_freeList;
+  m_nodes[_id].m_height=-1;
+  m_freeList=_id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int DynamicAABBTree::insert(const Vec3 &_min, const Vec3 &_max, size_t _userData) noexcept
+{
+  int id=allocateNode();
+  TreeNode &node=m_nodes[id];
+  Vec3 margin(m_margin,m_margin,m_margin);
+  node.m_min=_min-margin;
+  node.m_max=_max+margin;
+  node.m_userData=_userData;
+  node.m_height=0;
+  insertLeaf(id);
+  ++m_proxyCount;
+  return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int DynamicAABBTree::insert(const BBox &_box, size_t _userData) noexcept
+{
+  Vec3 halfSize(_box.width()*0.5f,_box.height()*0.5f,_box.depth()*0.5f);
+  return insert(_box.center()-halfSize,_box.center()+halfSize,_userData);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::remove(int _id) noexcept
+{
+  NGL_ASSERT(_id>=0 && _id < static_cast<int>(m_nodes.size()));
+  NGL_ASSERT(m_nodes[_id].isLeaf());
+  removeLeaf(_id);
+  freeNode(_id);
+  --m_proxyCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicAABBTree::update(int _id, const Vec3 &_min, const Vec3 &_max, const Vec3 &_displacement) noexcept
+{
+  NGL_ASSERT(_id>=0 && _id < static_cast<int>(m_nodes.size()));
+  NGL_ASSERT(m_nodes[_id].isLeaf());
+  // still inside the fat box so nothing to do
+  if(contains(m_nodes[_id].m_min,m_nodes[_id].m_max,_min,_max))
+  {
+    return false;
+  }
+  removeLeaf(_id);
+  Vec3 margin(m_margin,m_margin,m_margin);
+  Vec3 fatMin=_min-margin;
+  Vec3 fatMax=_max+margin;
+  // predict the motion so fast moving objects don't need re-inserting every frame
+  Vec3 d=_displacement*m_displacementScale;
+  if(d.m_x < 0.0f) fatMin.m_x+=d.m_x; else fatMax.m_x+=d.m_x;
+  if(d.m_y < 0.0f) fatMin.m_y+=d.m_y; else fatMax.m_y+=d.m_y;
+  if(d.m_z < 0.0f) fatMin.m_z+=d.m_z; else fatMax.m_z+=d.m_z;
+  m_nodes[_id].m_min=fatMin;
+  m_nodes[_id].m_max=fatMax;
+  insertLeaf(_id);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicAABBTree::update(int _id, const BBox &_localBox, const Mat4 &_tx) noexcept
+{
+  Vec3 halfSize(_localBox.width()*0.5f,_localBox.height()*0.5f,_localBox.depth()*0.5f);
+  Vec3 wMin,wMax;
+  transformBounds(_localBox.center()-halfSize,_localBox.center()+halfSize,_tx,wMin,wMax);
+  return update(_id,wMin,wMax);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::clear() noexcept
+{
+  m_nodes.clear();
+  m_root=NULLNODE;
+  m_freeList=NULLNODE;
+  m_proxyCount=0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t DynamicAABBTree::getUserData(int _id) const noexcept
+{
+  NGL_ASSERT(_id>=0 && _id < static_cast<int>(m_nodes.size()));
+  return m_nodes[_id].m_userData;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::getFatBounds(int _id, Vec3 &o_min, Vec3 &o_max) const noexcept
+{
+  NGL_ASSERT(_id>=0 && _id < static_cast<int>(m_nodes.size()));
+  o_min=m_nodes[_id].m_min;
+  o_max=m_nodes[_id].m_max;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int DynamicAABBTree::getHeight() const noexcept
+{
+  return m_root == NULLNODE ? -1 : m_nodes[m_root].m_height;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::insertLeaf(int _leaf) noexcept
+{
+  if(m_root == NULLNODE)
+  {
+    m_root=_leaf;
+    m_nodes[m_root].m_parent=NULLNODE;
+    return;
+  }
+  // find the best sibling for this node using the surface area heuristic
+  Vec3 leafMin=m_nodes[_leaf].m_min;
+  Vec3 leafMax=m_nodes[_leaf].m_max;
+  int index=m_root;
+  while(!m_nodes[index].isLeaf())
+  {
+    const TreeNode &node=m_nodes[index];
+    int child1=node.m_child1;
+    int child2=node.m_child2;
+    Real nodeArea=area(node.m_min,node.m_max);
+    Real combinedArea=area(vmin(node.m_min,leafMin),vmax(node.m_max,leafMax));
+    // cost of creating a new parent for this node and the new leaf
+    Real cost=2.0f*combinedArea;
+    // minimum cost of pushing the leaf further down the tree
+    Real inheritanceCost=2.0f*(combinedArea-nodeArea);
+
+    auto descendCost=[&](int _child)
+    {
+      const TreeNode &c=m_nodes[_child];
+      Real newArea=area(vmin(c.m_min,leafMin),vmax(c.m_max,leafMax));
+      if(c.isLeaf())
+      {
+        return newArea+inheritanceCost;
+      }
+      return (newArea-area(c.m_min,c.m_max))+inheritanceCost;
+    };
+    Real cost1=descendCost(child1);
+    Real cost2=descendCost(child2);
+    if(cost < cost1 && cost < cost2)
+    {
+      break;
+    }
+    index = cost1 < cost2 ? child1 : child2;
+  }
+  int sibling=index;
+  // create a new parent, note allocateNode may move the pool so no references are held over this
+  int oldParent=m_nodes[sibling].m_parent;
+  int newParent=allocateNode();
+  m_nodes[newParent].m_parent=oldParent;
+  m_nodes[newParent].m_min=vmin(leafMin,m_nodes[sibling].m_min);
+  m_nodes[newParent].m_max=vmax(leafMax,m_nodes[sibling].m_max);
+  m_nodes[newParent].m_height=m_nodes[sibling].m_height+1;
+  m_nodes[newParent].m_child1=sibling;
+  m_nodes[newParent].m_child2=_leaf;
+  m_nodes[sibling].m_parent=newParent;
+  m_nodes[_leaf].m_parent=newParent;
+  if(oldParent != NULLNODE)
+  {
+    if(m_nodes[oldParent].m_child1 == sibling)
+    {
+      m_nodes[oldParent].m_child1=newParent;
+    }
+    else
+    {
+      m_nodes[oldParent].m_child2=newParent;
+    }
+  }
+  else
+  {
+    m_root=newParent;
+  }
+  // walk back up the tree fixing heights and boxes
+  index=m_nodes[_leaf].m_parent;
+  while(index != NULLNODE)
+  {
+    index=balance(index);
+    TreeNode &node=m_nodes[index];
+    const TreeNode &c1=m_nodes[node.m_child1];
+    const TreeNode &c2=m_nodes[node.m_child2];
+    node.m_height=1+std::max(c1.m_height,c2.m_height);
+    node.m_min=vmin(c1.m_min,c2.m_min);
+    node.m_max=vmax(c1.m_max,c2.m_max);
+    index=node.m_parent;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::removeLeaf(int _leaf) noexcept
+{
+  if(_leaf == m_root)
+  {
+    m_root=NULLNODE;
+    return;
+  }
+  int parent=m_nodes[_leaf].m_parent;
+  int grandParent=m_nodes[parent].m_parent;
+  int sibling = m_nodes[parent].m_child1 == _leaf ? m_nodes[parent].m_child2 : m_nodes[parent].m_child1;
+  if(grandParent != NULLNODE)
+  {
+    // destroy the parent and connect the sibling to the grand parent
+    if(m_nodes[grandParent].m_child1 == parent)
+    {
+      m_nodes[grandParent].m_child1=sibling;
+    }
+    else
+    {
+      m_nodes[grandParent].m_child2=sibling;
+    }
+    m_nodes[sibling].m_parent=grandParent;
+    freeNode(parent);
+    int index=grandParent;
+    while(index != NULLNODE)
+    {
+      index=balance(index);
+      TreeNode &node=m_nodes[index];
+      const TreeNode &c1=m_nodes[node.m_child1];
+      const TreeNode &c2=m_nodes[node.m_child2];
+      node.m_min=vmin(c1.m_min,c2.m_min);
+      node.m_max=vmax(c1.m_max,c2.m_max);
+      node.m_height=1+std::max(c1.m_height,c2.m_height);
+      index=node.m_parent;
+    }
+  }
+  else
+  {
+    m_root=sibling;
+    m_nodes[sibling].m_parent=NULLNODE;
+    freeNode(parent);
+  }
+  m_nodes[_leaf].m_parent=NULLNODE;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int DynamicAABBTree::balance(int _a) noexcept
+{
+  TreeNode &A=m_nodes[_a];
+  if(A.isLeaf() || A.m_height < 2)
+  {
+    return _a;
+  }
+  int iB=A.m_child1;
+  int iC=A.m_child2;
+  TreeNode &B=m_nodes[iB];
+  TreeNode &C=m_nodes[iC];
+  int balance=C.m_height-B.m_height;
+  // rotate C up
+  if(balance > 1)
+  {
+    int iF=C.m_child1;
+    int iG=C.m_child2;
+    TreeNode &F=m_nodes[iF];
+    TreeNode &G=m_nodes[iG];
+    C.m_child1=_a;
+    C.m_parent=A.m_parent;
+    A.m_parent=iC;
+    if(C.m_parent != NULLNODE)
+    {
+      if(m_nodes[C.m_parent].m_child1 == _a)
+      {
+        m_nodes[C.m_parent].m_child1=iC;
+      }
+      else
+      {
+        m_nodes[C.m_parent].m_child2=iC;
+      }
+    }
+    else
+    {
+      m_root=iC;
+    }
+    if(F.m_height > G.m_height)
+    {
+      C.m_child2=iF;
+      A.m_child2=iG;
+      G.m_parent=_a;
+      A.m_min=vmin(B.m_min,G.m_min); A.m_max=vmax(B.m_max,G.m_max);
+      C.m_min=vmin(A.m_min,F.m_min); C.m_max=vmax(A.m_max,F.m_max);
+      A.m_height=1+std::max(B.m_height,G.m_height);
+      C.m_height=1+std::max(A.m_height,F.m_height);
+    }
+    else
+    {
+      C.m_child2=iG;
+      A.m_child2=iF;
+      F.m_parent=_a;
+      A.m_min=vmin(B.m_min,F.m_min); A.m_max=vmax(B.m_max,F.m_max);
+      C.m_min=vmin(A.m_min,G.m_min); C.m_max=vmax(A.m_max,G.m_max);
+      A.m_height=1+std::max(B.m_height,F.m_height);
+      C.m_height=1+std::max(A.m_height,G.m_height);
+    }
+    return iC;
+  }
+  // rotate B up
+  if(balance < -1)
+  {
+    int iD=B.m_child1;
+    int iE=B.m_child2;
+    TreeNode &D=m_nodes[iD];
+    TreeNode &E=m_nodes[iE];
+    B.m_child1=_a;
+    B.m_parent=A.m_parent;
+    A.m_parent=iB;
+    if(B.m_parent != NULLNODE)
+    {
+      if(m_nodes[B.m_parent].m_child1 == _a)
+      {
+        m_nodes[B.m_parent].m_child1=iB;
+      }
+      else
+      {
+        m_nodes[B.m_parent].m_child2=iB;
+      }
+    }
+    else
+    {
+      m_root=iB;
+    }
+    if(D.m_height > E.m_height)
+    {
+      B.m_child2=iD;
+      A.m_child1=iE;
+      E.m_parent=_a;
+      A.m_min=vmin(C.m_min,E.m_min); A.m_max=vmax(C.m_max,E.m_max);
+      B.m_min=vmin(A.m_min,D.m_min); B.m_max=vmax(A.m_max,D.m_max);
+      A.m_height=1+std::max(C.m_height,E.m_height);
+      B.m_height=1+std::max(A.m_height,D.m_height);
+    }
+    else
+    {
+      B.m_child2=iE;
+      A.m_child1=iD;
+      D.m_parent=_a;
+      A.m_min=vmin(C.m_min,D.m_min); A.m_max=vmax(C.m_max,D.m_max);
+      B.m_min=vmin(A.m_min,E.m_min); B.m_max=vmax(A.m_max,E.m_max);
+      A.m_height=1+std::max(C.m_height,D.m_height);
+      B.m_height=1+std::max(A.m_height,E.m_height);
+    }
+    return iB;
+  }
+  return _a;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::queryRegion(const Vec3 &_min, const Vec3 &_max, std::vector<size_t> &o_results) const
+{
+  if(m_root == NULLNODE)
+  {
+    return;
+  }
+  m_stack.clear();
+  m_stack.push_back(m_root);
+  while(!m_stack.empty())
+  {
+    int id=m_stack.back();
+    m_stack.pop_back();
+    const TreeNode &node=m_nodes[id];
+    if(overlaps(node.m_min,node.m_max,_min,_max))
+    {
+      if(node.isLeaf())
+      {
+        o_results.push_back(node.m_userData);
+      }
+      else
+      {
+        m_stack.push_back(node.m_child1);
+        m_stack.push_back(node.m_child2);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::queryFrustum(const Camera &_cam, std::vector<size_t> &o_results) const
+{
+  queryFrustum(_cam.getFrustumPlanes(),6,o_results);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::queryFrustum(const Plane *_planes, size_t _numPlanes, std::vector<size_t> &o_results) const
+{
+  NGL_ASSERT(_numPlanes <= 32);
+  if(m_root == NULLNODE)
+  {
+    return;
+  }
+  // each stack entry is a node and a mask of the planes still to be tested, once a node is fully
+  // inside a plane its children don't need testing against it, when the mask is empty the whole
+  // sub tree is visible and is added without any more plane tests.
+  unsigned int allPlanes = _numPlanes == 32 ? 0xffffffffu : (1u << _numPlanes)-1u;
+  m_stack.clear();
+  m_stack.push_back(m_root);
+  m_stack.push_back(static_cast<int>(allPlanes));
+  while(!m_stack.empty())
+  {
+    unsigned int mask=static_cast<unsigned int>(m_stack.back());
+    m_stack.pop_back();
+    int id=m_stack.back();
+    m_stack.pop_back();
+    const TreeNode &node=m_nodes[id];
+    bool outside=false;
+    for(size_t i=0; i<_numPlanes && mask !=0; ++i)
+    {
+      unsigned int bit=1u<<i;
+      if(!(mask & bit))
+      {
+        continue;
+      }
+      Vec3 n=_planes[i].getNormal();
+      Real d=_planes[i].getD();
+      // positive vertex (furthest along the normal) and negative vertex
+      Real px = n.m_x > 0.0f ? node.m_max.m_x : node.m_min.m_x;
+      Real py = n.m_y > 0.0f ? node.m_max.m_y : node.m_min.m_y;
+      Real pz = n.m_z > 0.0f ? node.m_max.m_z : node.m_min.m_z;
+      if(n.m_x*px+n.m_y*py+n.m_z*pz+d < 0.0f)
+      {
+        outside=true;
+        break;
+      }
+      Real nx = n.m_x > 0.0f ? node.m_min.m_x : node.m_max.m_x;
+      Real ny = n.m_y > 0.0f ? node.m_min.m_y : node.m_max.m_y;
+      Real nz = n.m_z > 0.0f ? node.m_min.m_z : node.m_max.m_z;
+      if(n.m_x*nx+n.m_y*ny+n.m_z*nz+d >= 0.0f)
+      {
+        mask &= ~bit;
+      }
+    }
+    if(outside)
+    {
+      continue;
+    }
+    if(node.isLeaf())
+    {
+      o_results.push_back(node.m_userData);
+    }
+    else
+    {
+      m_stack.push_back(node.m_child1);
+      m_stack.push_back(static_cast<int>(mask));
+      m_stack.push_back(node.m_child2);
+      m_stack.push_back(static_cast<int>(mask));
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::queryRay(const Vec3 &_origin, const Vec3 &_dir, Real _maxT, std::vector<size_t> &o_results) const
+{
+  if(m_root == NULLNODE)
+  {
+    return;
+  }
+  // slab test, 1/0 gives inf which the min / max below handle correctly
+  Vec3 invDir(1.0f/_dir.m_x,1.0f/_dir.m_y,1.0f/_dir.m_z);
+  auto hit=[&](const TreeNode &_n)
+  {
+    Real t1=(_n.m_min.m_x-_origin.m_x)*invDir.m_x;
+    Real t2=(_n.m_max.m_x-_origin.m_x)*invDir.m_x;
+    Real tmin=std::min(t1,t2);
+    Real tmax=std::max(t1,t2);
+    t1=(_n.m_min.m_y-_origin.m_y)*invDir.m_y;
+    t2=(_n.m_max.m_y-_origin.m_y)*invDir.m_y;
+    tmin=std::max(tmin,std::min(t1,t2));
+    tmax=std::min(tmax,std::max(t1,t2));
+    t1=(_n.m_min.m_z-_origin.m_z)*invDir.m_z;
+    t2=(_n.m_max.m_z-_origin.m_z)*invDir.m_z;
+    tmin=std::max(tmin,std::min(t1,t2));
+    tmax=std::min(tmax,std::max(t1,t2));
+    return tmax >= std::max(tmin,0.0f) && tmin <= _maxT;
+  };
+  m_stack.clear();
+  m_stack.push_back(m_root);
+  while(!m_stack.empty())
+  {
+    int id=m_stack.back();
+    m_stack.pop_back();
+    const TreeNode &node=m_nodes[id];
+    if(!hit(node))
+    {
+      continue;
+    }
+    if(node.isLeaf())
+    {
+      o_results.push_back(node.m_userData);
+    }
+    else
+    {
+      m_stack.push_back(node.m_child1);
+      m_stack.push_back(node.m_child2);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicAABBTree::validate() const noexcept
+{
+  if(m_root == NULLNODE)
+  {
+    return m_proxyCount == 0;
+  }
+  if(m_nodes[m_root].m_parent != NULLNODE)
+  {
+    return false;
+  }
+  return validateNode(m_root);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicAABBTree::validateNode(int _id) const noexcept
+{
+  const TreeNode &node=m_nodes[_id];
+  if(node.isLeaf())
+  {
+    return node.m_height == 0 && node.m_child2 == NULLNODE;
+  }
+  const TreeNode &c1=m_nodes[node.m_child1];
+  const TreeNode &c2=m_nodes[node.m_child2];
+  if(c1.m_parent != _id || c2.m_parent != _id)
+  {
+    return false;
+  }
+  if(node.m_height != 1+std::max(c1.m_height,c2.m_height))
+  {
+    return false;
+  }
+  if(!contains(node.m_min,node.m_max,c1.m_min,c1.m_max) || !contains(node.m_min,node.m_max,c2.m_min,c2.m_max))
+  {
+    return false;
+  }
+  return validateNode(node.m_child1) && validateNode(node.m_child2);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicAABBTree::transformBounds(const Vec3 &_min, const Vec3 &_max, const Mat4 &_tx, Vec3 &o_min, Vec3 &o_max) noexcept
+{
+  // Arvo's method, start at the translation and add the min / max contribution of each axis
+  Real omin[3]={_tx.m_30,_tx.m_31,_tx.m_32};
+  Real omax[3]={_tx.m_30,_tx.m_31,_tx.m_32};
+  const Real lmin[3]={_min.m_x,_min.m_y,_min.m_z};
+  const Real lmax[3]={_max.m_x,_max.m_y,_max.m_z};
+  for(int i=0; i<3; ++i)
+  {
+    for(int j=0; j<3; ++j)
+    {
+      Real a=_tx.m_m[j][i]*lmin[j];
+      Real b=_tx.m_m[j][i]*lmax[j];
+      omin[i]+=std::min(a,b);
+      omax[i]+=std::max(a,b);
+    }
+  }
+  o_min.set(omin[0],omin[1],omin[2]);
+  o_max.set(omax[0],omax[1],omax[2]);
+}
+
+} // end ngl namespace
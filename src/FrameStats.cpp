@@ -0,0 +1,117 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "FrameStats.h"
+#include "Logger.h"
+#include <algorithm>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameStats.cpp
+/// @brief implementation files for FrameStats class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+FrameStats *FrameStats::instance() noexcept
+{
+  // trivially destructible so it is still usable from other objects' destructors at exit
+  static FrameStats s_stats;
+  return &s_stats;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+FrameStats::FrameStats() noexcept
+{
+  reset();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FrameStats::addDraw(GLenum _mode, size_t _count, size_t _instances) noexcept
+{
+  size_t triangles=0;
+  switch(_mode)
+  {
+    case GL_TRIANGLES : triangles=_count/3; break;
+    case GL_TRIANGLE_STRIP : case GL_TRIANGLE_FAN : triangles= _count > 2 ? _count-2 : 0; break;
+#ifndef USINGIOS_
+    case GL_TRIANGLES_ADJACENCY : triangles=_count/6; break;
+    case GL_TRIANGLE_STRIP_ADJACENCY : triangles= _count > 4 ? _count/2-2 : 0; break;
+#endif
+    default : break;
+  }
+  add(DRAWCALLS);
+  add(INSTANCES,_instances);
+  add(TRIANGLES,triangles*_instances);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FrameStats::beginFrame() noexcept
+{
+  for(auto &c : m_current)
+  {
+    c.store(0,std::memory_order_relaxed);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FrameStats::endFrame() noexcept
+{
+  for(size_t i=0; i<NUMCOUNTERS; ++i)
+  {
+    m_last[i]=m_current[i].exchange(0,std::memory_order_relaxed);
+    m_peak[i]=std::max(m_peak[i],m_last[i]);
+    m_total[i]+=m_last[i];
+  }
+  ++m_frames;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const char *FrameStats::getName(Counter _counter) noexcept
+{
+  static const char *names[NUMCOUNTERS]=
+  {
+    "draw calls","triangles","instances","vertex array binds","program switches","uniform uploads",
+    "buffer uploads","buffer bytes","texture bytes"
+  };
+  return _counter < NUMCOUNTERS ? names[_counter] : "unknown";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FrameStats::report() const
+{
+  Logger *log=Logger::instance();
+  log->logMessage("Frame statistics over %llu frames\n",static_cast<unsigned long long>(m_frames));
+  for(size_t i=0; i<NUMCOUNTERS; ++i)
+  {
+    double average= m_frames == 0 ? 0.0 : static_cast<double>(m_total[i])/static_cast<double>(m_frames);
+    log->logMessage("%-20s last %12llu peak %12llu avg %14.1f\n",getName(static_cast<Counter>(i)),
+                    static_cast<unsigned long long>(m_last[i]),static_cast<unsigned long long>(m_peak[i]),average);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FrameStats::reset() noexcept
+{
+  for(auto &c : m_current)
+  {
+    c.store(0,std::memory_order_relaxed);
+  }
+  m_last.fill(0);
+  m_peak.fill(0);
+  m_total.fill(0);
+  m_frames=0;
+}
+
+} // end ngl namespace
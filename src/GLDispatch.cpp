@@ -0,0 +1,49 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GLDispatch.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLDispatch.cpp
+/// @brief implementation files for GLDispatch class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+GLCoreFunctions GLDispatch::s_core=GLDispatch::getGLFunctions();
+
+//----------------------------------------------------------------------------------------------------------------------
+GLCoreFunctions GLDispatch::getGLFunctions() noexcept
+{
+  GLCoreFunctions functions;
+  functions.bindTexture=::glBindTexture;
+  functions.blendFunc=::glBlendFunc;
+  functions.deleteTextures=::glDeleteTextures;
+  functions.disable=::glDisable;
+  functions.drawArrays=::glDrawArrays;
+  functions.drawElements=::glDrawElements;
+  functions.enable=::glEnable;
+  functions.genTextures=::glGenTextures;
+  functions.getError=::glGetError;
+  functions.getIntegerv=::glGetIntegerv;
+  functions.getString=::glGetString;
+  functions.pointSize=::glPointSize;
+  functions.polygonMode=::glPolygonMode;
+  functions.readPixels=::glReadPixels;
+  functions.texImage2D=::glTexImage2D;
+  functions.texParameteri=::glTexParameteri;
+  return functions;
+}
+
+} // end ngl namespace
@@ -0,0 +1,883 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GLMock.h"
+#include "GLState.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLMock.cpp
+/// @brief implementation files for GLMock class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+GLMock *GLMock::s_installed=nullptr;
+
+namespace
+{
+  // does a parameter list have a pointer in it, those calls can't be replayed safely
+  template <class... T>
+  struct AnyPointer : std::false_type {};
+  template <class T, class... Rest>
+  struct AnyPointer<T,Rest...> :
+    std::integral_constant<bool,std::is_pointer<T>::value || AnyPointer<Rest...>::value> {};
+
+  // bytes per pixel of a format and type, only used to size the texture totals
+  size_t pixelSize(GLenum _format, GLenum _type) noexcept
+  {
+    switch(_type)
+    {
+      case GL_UNSIGNED_BYTE_3_3_2 : return 1;
+      case GL_UNSIGNED_SHORT_5_6_5 :
+      case GL_UNSIGNED_SHORT_4_4_4_4 :
+      case GL_UNSIGNED_SHORT_5_5_5_1 : return 2;
+      case GL_UNSIGNED_INT_8_8_8_8 :
+      case GL_UNSIGNED_INT_10_10_10_2 :
+      case GL_UNSIGNED_INT_2_10_10_10_REV : return 4;
+      default : break;
+    }
+    size_t components=4;
+    switch(_format)
+    {
+      case GL_RED : case GL_ALPHA : case GL_DEPTH_COMPONENT : case GL_RED_INTEGER : components=1; break;
+      case GL_RG : case GL_RG_INTEGER : components=2; break;
+      case GL_RGB : case GL_BGR : case GL_RGB_INTEGER : components=3; break;
+      default : break;
+    }
+    size_t bytes=1;
+    switch(_type)
+    {
+      case GL_SHORT : case GL_UNSIGNED_SHORT : case GL_HALF_FLOAT : bytes=2; break;
+      case GL_INT : case GL_UNSIGNED_INT : case GL_FLOAT : bytes=4; break;
+      default : break;
+    }
+    return components*bytes;
+  }
+
+  // any non null value will do for a fence
+  char s_fence;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the mock GL entry points, they are only installed while s_installed is set
+//----------------------------------------------------------------------------------------------------------------------
+struct GLMock::Functions
+{
+  // count a call, the replay is only kept if recording
+  template <class L>
+  static void called(const char *_name, L &&_replay)
+  {
+    GLMock *mock=s_installed;
+    mock->called(_name,mock->m_recording ? std::function<void()>(std::forward<L>(_replay)) : std::function<void()>());
+  }
+
+  static void draw(const char *_name, std::function<void()> &&_replay)
+  {
+    ++s_installed->m_draws;
+    ++s_installed->m_frameDraws;
+    called(_name,std::move(_replay));
+  }
+
+  static void deleted(size_t _erased, GLuint _name)
+  {
+    if(_erased == 0 && _name != 0)
+    {
+      ++s_installed->m_badDeletes;
+    }
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // functions that only count, one instantiation per installed pointer
+  //--------------------------------------------------------------------------------------------------------------------
+  template <int I, class F>
+  struct Stub;
+
+  template <int I, class R, class... Args>
+  struct Stub<I,R (GLAPIENTRY *)(Args...)>
+  {
+    using Pointer=R (GLAPIENTRY *)(Args...);
+    static const char *&name(){static const char *s_name=nullptr; return s_name;}
+    static Pointer *&target(){static Pointer *s_target=nullptr; return s_target;}
+
+    static std::function<void()> makeReplay(std::true_type, Args...)
+    {
+      return std::function<void()>();
+    }
+    static std::function<void()> makeReplay(std::false_type, Args... _args)
+    {
+      Pointer *pointer=target();
+      return [=](){(*pointer)(_args...);};
+    }
+    static R GLAPIENTRY call(Args... _args)
+    {
+      GLMock *mock=s_installed;
+      mock->called(name(),mock->m_recording ? makeReplay(AnyPointer<Args...>(),_args...) : std::function<void()>());
+      return R();
+    }
+  };
+
+  template <int I, class F>
+  static void stub(GLMock &_mock, F &_pointer, const char *_name)
+  {
+    Stub<I,F>::name()=_name;
+    Stub<I,F>::target()=&_pointer;
+    _mock.hook(_pointer,static_cast<F>(&Stub<I,F>::call));
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // buffers
+  //--------------------------------------------------------------------------------------------------------------------
+  static void GLAPIENTRY genBuffers(GLsizei _n, GLuint *_buffers)
+  {
+    for(GLsizei i=0; i<_n; ++i)
+    {
+      _buffers[i]=s_installed->m_nextName++;
+      s_installed->m_buffers[_buffers[i]];
+    }
+    called("glGenBuffers",[=](){std::vector<GLuint> names(_n); glGenBuffers(_n,names.data());});
+  }
+
+  static void GLAPIENTRY deleteBuffers(GLsizei _n, const GLuint *_buffers)
+  {
+    std::vector<GLuint> names(_buffers,_buffers+_n);
+    for(auto b : names)
+    {
+      deleted(s_installed->m_buffers.erase(b),b);
+      for(auto &bound : s_installed->m_boundBuffers)
+      {
+        bound.second= bound.second == b ? 0 : bound.second;
+      }
+    }
+    called("glDeleteBuffers",[=](){glDeleteBuffers(_n,names.data());});
+  }
+
+  static void GLAPIENTRY bindBuffer(GLenum _target, GLuint _buffer)
+  {
+    s_installed->m_boundBuffers[_target]=_buffer;
+    called("glBindBuffer",[=](){glBindBuffer(_target,_buffer);});
+  }
+
+  static std::vector<unsigned char> *boundBuffer(GLenum _target)
+  {
+    auto buffer=s_installed->m_buffers.find(s_installed->m_boundBuffers[_target]);
+    return buffer != s_installed->m_buffers.end() ? &buffer->second : nullptr;
+  }
+
+  // copy upload data only when it is going to be replayed
+  static std::shared_ptr<std::vector<unsigned char>> keep(const void *_data, size_t _size)
+  {
+    if(!s_installed->m_recording || _data == nullptr)
+    {
+      return nullptr;
+    }
+    const unsigned char *bytes=static_cast<const unsigned char *>(_data);
+    return std::make_shared<std::vector<unsigned char>>(bytes,bytes+_size);
+  }
+
+  static void GLAPIENTRY bufferData(GLenum _target, GLsizeiptr _size, const void *_data, GLenum _usage)
+  {
+    if(auto *store=boundBuffer(_target))
+    {
+      store->assign(static_cast<size_t>(_size),0);
+      if(_data != nullptr && _size > 0)
+      {
+        memcpy(store->data(),_data,static_cast<size_t>(_size));
+      }
+    }
+    s_installed->m_uploadBytes+=static_cast<uint64_t>(_size);
+    auto copy=keep(_data,static_cast<size_t>(_size));
+    called("glBufferData",[=](){glBufferData(_target,_size,copy ? copy->data() : nullptr,_usage);});
+  }
+
+  static void GLAPIENTRY bufferStorage(GLenum _target, GLsizeiptr _size, const void *_data, GLbitfield _flags)
+  {
+    if(auto *store=boundBuffer(_target))
+    {
+      store->assign(static_cast<size_t>(_size),0);
+      if(_data != nullptr && _size > 0)
+      {
+        memcpy(store->data(),_data,static_cast<size_t>(_size));
+      }
+    }
+    s_installed->m_uploadBytes+=static_cast<uint64_t>(_size);
+    auto copy=keep(_data,static_cast<size_t>(_size));
+    called("glBufferStorage",[=](){glBufferStorage(_target,_size,copy ? copy->data() : nullptr,_flags);});
+  }
+
+  static void GLAPIENTRY bufferSubData(GLenum _target, GLintptr _offset, GLsizeiptr _size, const void *_data)
+  {
+    auto *store=boundBuffer(_target);
+    if(store != nullptr && _offset >= 0 && static_cast<size_t>(_offset+_size) <= store->size())
+    {
+      memcpy(store->data()+_offset,_data,static_cast<size_t>(_size));
+    }
+    else
+    {
+      std::cerr<<"GLMock glBufferSubData outside the buffer\n";
+    }
+    s_installed->m_uploadBytes+=static_cast<uint64_t>(_size);
+    auto copy=keep(_data,static_cast<size_t>(_size));
+    called("glBufferSubData",[=](){glBufferSubData(_target,_offset,_size,copy ? copy->data() : nullptr);});
+  }
+
+  static void GLAPIENTRY getBufferSubData(GLenum _target, GLintptr _offset, GLsizeiptr _size, void *o_data)
+  {
+    auto *store=boundBuffer(_target);
+    if(store != nullptr && _offset >= 0 && static_cast<size_t>(_offset+_size) <= store->size())
+    {
+      memcpy(o_data,store->data()+_offset,static_cast<size_t>(_size));
+    }
+    called("glGetBufferSubData",std::function<void()>());
+  }
+
+  static void GLAPIENTRY getBufferParameteriv(GLenum _target, GLenum _name, GLint *o_params)
+  {
+    auto *store=boundBuffer(_target);
+    *o_params= (_name == GL_BUFFER_SIZE && store != nullptr) ? static_cast<GLint>(store->size()) : 0;
+    called("glGetBufferParameteriv",std::function<void()>());
+  }
+
+  static void GLAPIENTRY copyBufferSubData(GLenum _read, GLenum _write, GLintptr _readOffset, GLintptr _writeOffset,
+                                           GLsizeiptr _size)
+  {
+    auto *from=boundBuffer(_read);
+    auto *to=boundBuffer(_write);
+    if(from != nullptr && to != nullptr && static_cast<size_t>(_readOffset+_size) <= from->size() &&
+       static_cast<size_t>(_writeOffset+_size) <= to->size())
+    {
+      memmove(to->data()+_writeOffset,from->data()+_readOffset,static_cast<size_t>(_size));
+    }
+    called("glCopyBufferSubData",[=](){glCopyBufferSubData(_read,_write,_readOffset,_writeOffset,_size);});
+  }
+
+  static void *GLAPIENTRY mapBufferRange(GLenum _target, GLintptr _offset, GLsizeiptr _length, GLbitfield)
+  {
+    auto *store=boundBuffer(_target);
+    called("glMapBufferRange",std::function<void()>());
+    if(store == nullptr || _offset < 0 || static_cast<size_t>(_offset+_length) > store->size())
+    {
+      return nullptr;
+    }
+    return store->data()+_offset;
+  }
+
+  static void *GLAPIENTRY mapBuffer(GLenum _target, GLenum)
+  {
+    auto *store=boundBuffer(_target);
+    called("glMapBuffer",std::function<void()>());
+    return (store == nullptr || store->empty()) ? nullptr : store->data();
+  }
+
+  static GLboolean GLAPIENTRY unmapBuffer(GLenum _target)
+  {
+    called("glUnmapBuffer",std::function<void()>());
+    return boundBuffer(_target) != nullptr ? GL_TRUE : GL_FALSE;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // vertex arrays
+  //--------------------------------------------------------------------------------------------------------------------
+  static void GLAPIENTRY genVertexArrays(GLsizei _n, GLuint *_arrays)
+  {
+    for(GLsizei i=0; i<_n; ++i)
+    {
+      _arrays[i]=s_installed->m_nextName++;
+      s_installed->m_vertexArrays[_arrays[i]]=true;
+    }
+    called("glGenVertexArrays",[=](){std::vector<GLuint> names(_n); glGenVertexArrays(_n,names.data());});
+  }
+
+  static void GLAPIENTRY deleteVertexArrays(GLsizei _n, const GLuint *_arrays)
+  {
+    std::vector<GLuint> names(_arrays,_arrays+_n);
+    for(auto a : names)
+    {
+      deleted(s_installed->m_vertexArrays.erase(a),a);
+    }
+    called("glDeleteVertexArrays",[=](){glDeleteVertexArrays(_n,names.data());});
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // shaders and programs
+  //--------------------------------------------------------------------------------------------------------------------
+  static GLuint GLAPIENTRY createShader(GLenum _type)
+  {
+    GLuint name=s_installed->m_nextName++;
+    s_installed->m_shaders[name];
+    called("glCreateShader",[=](){glCreateShader(_type);});
+    return name;
+  }
+
+  static void GLAPIENTRY deleteShader(GLuint _shader)
+  {
+    deleted(s_installed->m_shaders.erase(_shader),_shader);
+    called("glDeleteShader",[=](){glDeleteShader(_shader);});
+  }
+
+  static void GLAPIENTRY shaderSource(GLuint _shader, GLsizei _count, const GLchar *const *_strings,
+                                      const GLint *_lengths)
+  {
+    std::string source;
+    for(GLsizei i=0; i<_count; ++i)
+    {
+      if(_lengths != nullptr && _lengths[i] >= 0)
+      {
+        source.append(_strings[i],static_cast<size_t>(_lengths[i]));
+      }
+      else
+      {
+        source.append(_strings[i]);
+      }
+    }
+    auto shader=s_installed->m_shaders.find(_shader);
+    if(shader != s_installed->m_shaders.end())
+    {
+      shader->second=source;
+    }
+    called("glShaderSource",[=](){const GLchar *s=source.c_str(); glShaderSource(_shader,1,&s,nullptr);});
+  }
+
+  static void GLAPIENTRY getShaderiv(GLuint, GLenum _name, GLint *o_params)
+  {
+    switch(_name)
+    {
+      case GL_COMPILE_STATUS : case GL_COMPLETION_STATUS_ARB : *o_params=GL_TRUE; break;
+      default : *o_params=0; break;
+    }
+    called("glGetShaderiv",std::function<void()>());
+  }
+
+  static GLuint GLAPIENTRY createProgram()
+  {
+    GLuint name=s_installed->m_nextName++;
+    s_installed->m_programs[name];
+    called("glCreateProgram",[](){glCreateProgram();});
+    return name;
+  }
+
+  static void GLAPIENTRY deleteProgram(GLuint _program)
+  {
+    deleted(s_installed->m_programs.erase(_program),_program);
+    called("glDeleteProgram",[=](){glDeleteProgram(_program);});
+  }
+
+  static void GLAPIENTRY getProgramiv(GLuint, GLenum _name, GLint *o_params)
+  {
+    switch(_name)
+    {
+      case GL_LINK_STATUS : case GL_COMPLETION_STATUS_ARB : *o_params=GL_TRUE; break;
+      default : *o_params=0; break;
+    }
+    called("glGetProgramiv",std::function<void()>());
+  }
+
+  static void GLAPIENTRY getProgramInterfaceiv(GLuint, GLenum, GLenum, GLint *o_params)
+  {
+    *o_params=0;
+    called("glGetProgramInterfaceiv",std::function<void()>());
+  }
+
+  // each new name in a program gets the next location
+  static GLint location(GLuint _program, const GLchar *_name)
+  {
+    auto program=s_installed->m_programs.find(_program);
+    if(program == s_installed->m_programs.end())
+    {
+      return -1;
+    }
+    auto &locations=program->second;
+    auto loc=locations.find(_name);
+    if(loc == locations.end())
+    {
+      loc=locations.insert({_name,static_cast<GLint>(locations.size())}).first;
+    }
+    return loc->second;
+  }
+
+  static GLint GLAPIENTRY getUniformLocation(GLuint _program, const GLchar *_name)
+  {
+    called("glGetUniformLocation",std::function<void()>());
+    return location(_program,_name);
+  }
+
+  static GLint GLAPIENTRY getAttribLocation(GLuint _program, const GLchar *_name)
+  {
+    called("glGetAttribLocation",std::function<void()>());
+    return location(_program,_name);
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // sync
+  //--------------------------------------------------------------------------------------------------------------------
+  static GLsync GLAPIENTRY fenceSync(GLenum, GLbitfield)
+  {
+    called("glFenceSync",std::function<void()>());
+    return reinterpret_cast<GLsync>(&s_fence);
+  }
+
+  static GLenum GLAPIENTRY clientWaitSync(GLsync, GLbitfield, GLuint64)
+  {
+    called("glClientWaitSync",std::function<void()>());
+    return GL_ALREADY_SIGNALED;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // queries are always ready and every result is zero
+  //--------------------------------------------------------------------------------------------------------------------
+  static void GLAPIENTRY genQueries(GLsizei _n, GLuint *_ids)
+  {
+    for(GLsizei i=0; i<_n; ++i)
+    {
+      _ids[i]=s_installed->m_nextName++;
+    }
+    called("glGenQueries",[=](){std::vector<GLuint> names(_n); glGenQueries(_n,names.data());});
+  }
+
+  static void GLAPIENTRY getQueryObjectiv(GLuint, GLenum _name, GLint *o_params)
+  {
+    *o_params= _name == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    called("glGetQueryObjectiv",std::function<void()>());
+  }
+
+  static void GLAPIENTRY getQueryObjectui64v(GLuint, GLenum _name, GLuint64 *o_params)
+  {
+    *o_params= _name == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    called("glGetQueryObjectui64v",std::function<void()>());
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // draws, index offsets are replayed as given
+  //--------------------------------------------------------------------------------------------------------------------
+  static void GLAPIENTRY drawArrays(GLenum _mode, GLint _first, GLsizei _count)
+  {
+    draw("glDrawArrays",[=](){GLDispatch::core().drawArrays(_mode,_first,_count);});
+  }
+
+  static void GLAPIENTRY drawElements(GLenum _mode, GLsizei _count, GLenum _type, const void *_indices)
+  {
+    draw("glDrawElements",[=](){GLDispatch::core().drawElements(_mode,_count,_type,_indices);});
+  }
+
+  static void GLAPIENTRY drawArraysInstanced(GLenum _mode, GLint _first, GLsizei _count, GLsizei _instances)
+  {
+    draw("glDrawArraysInstanced",[=](){glDrawArraysInstanced(_mode,_first,_count,_instances);});
+  }
+
+  static void GLAPIENTRY drawElementsInstanced(GLenum _mode, GLsizei _count, GLenum _type, const void *_indices,
+                                               GLsizei _instances)
+  {
+    draw("glDrawElementsInstanced",[=](){glDrawElementsInstanced(_mode,_count,_type,_indices,_instances);});
+  }
+
+  static void GLAPIENTRY drawElementsBaseVertex(GLenum _mode, GLsizei _count, GLenum _type, const void *_indices,
+                                                GLint _baseVertex)
+  {
+    draw("glDrawElementsBaseVertex",[=](){glDrawElementsBaseVertex(_mode,_count,_type,_indices,_baseVertex);});
+  }
+
+  static void GLAPIENTRY multiDrawElementsIndirect(GLenum _mode, GLenum _type, const void *_indirect,
+                                                   GLsizei _drawCount, GLsizei _stride)
+  {
+    draw("glMultiDrawElementsIndirect",
+         [=](){glMultiDrawElementsIndirect(_mode,_type,_indirect,_drawCount,_stride);});
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+  // textures and the rest of the GL 1.1 functions
+  //--------------------------------------------------------------------------------------------------------------------
+  static void GLAPIENTRY activeTexture(GLenum _unit)
+  {
+    s_installed->m_activeTexture=std::min<unsigned int>(_unit-GL_TEXTURE0,31);
+    called("glActiveTexture",[=](){glActiveTexture(_unit);});
+  }
+
+  static void GLAPIENTRY bindTexture(GLenum _target, GLuint _texture)
+  {
+    s_installed->m_boundTextures[s_installed->m_activeTexture]=_texture;
+    called("glBindTexture",[=](){GLDispatch::core().bindTexture(_target,_texture);});
+  }
+
+  static void GLAPIENTRY genTextures(GLsizei _n, GLuint *_textures)
+  {
+    for(GLsizei i=0; i<_n; ++i)
+    {
+      _textures[i]=s_installed->m_nextName++;
+      s_installed->m_textures[_textures[i]]=0;
+    }
+    called("glGenTextures",[=](){std::vector<GLuint> names(_n); GLDispatch::core().genTextures(_n,names.data());});
+  }
+
+  static void GLAPIENTRY deleteTextures(GLsizei _n, const GLuint *_textures)
+  {
+    std::vector<GLuint> names(_textures,_textures+_n);
+    for(auto t : names)
+    {
+      deleted(s_installed->m_textures.erase(t),t);
+    }
+    called("glDeleteTextures",[=](){GLDispatch::core().deleteTextures(_n,names.data());});
+  }
+
+  static void GLAPIENTRY texImage2D(GLenum _target, GLint _level, GLint _internalFormat, GLsizei _width,
+                                    GLsizei _height, GLint _border, GLenum _format, GLenum _type, const void *_pixels)
+  {
+    size_t size=static_cast<size_t>(_width)*static_cast<size_t>(_height)*pixelSize(_format,_type);
+    auto texture=s_installed->m_textures.find(s_installed->m_boundTextures[s_installed->m_activeTexture]);
+    if(texture != s_installed->m_textures.end() && _level == 0)
+    {
+      texture->second=size;
+    }
+    s_installed->m_uploadBytes+=size;
+    auto copy=keep(_pixels,size);
+    called("glTexImage2D",[=](){GLDispatch::core().texImage2D(_target,_level,_internalFormat,_width,_height,_border,
+                                                              _format,_type,copy ? copy->data() : nullptr);});
+  }
+
+  static void GLAPIENTRY getIntegerv(GLenum _name, GLint *o_params)
+  {
+    switch(_name)
+    {
+      case GL_MAJOR_VERSION : *o_params=4; break;
+      case GL_MINOR_VERSION : *o_params=1; break;
+      case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT : *o_params=256; break;
+      case GL_VIEWPORT : std::fill(o_params,o_params+4,0); break;
+      default : *o_params=0; break;
+    }
+    called("glGetIntegerv",std::function<void()>());
+  }
+
+  static const GLubyte *GLAPIENTRY getString(GLenum)
+  {
+    called("glGetString",std::function<void()>());
+    return reinterpret_cast<const GLubyte *>("NGL GLMock");
+  }
+
+  static GLenum GLAPIENTRY getError()
+  {
+    called("glGetError",std::function<void()>());
+    return GL_NO_ERROR;
+  }
+
+  static void GLAPIENTRY readPixels(GLint, GLint, GLsizei _width, GLsizei _height, GLenum _format, GLenum _type,
+                                    void *o_pixels)
+  {
+    memset(o_pixels,0,static_cast<size_t>(_width)*static_cast<size_t>(_height)*pixelSize(_format,_type));
+    called("glReadPixels",std::function<void()>());
+  }
+
+  static void GLAPIENTRY blendFunc(GLenum _src, GLenum _dst)
+  {
+    called("glBlendFunc",[=](){GLDispatch::core().blendFunc(_src,_dst);});
+  }
+
+  static void GLAPIENTRY enable(GLenum _cap)
+  {
+    called("glEnable",[=](){GLDispatch::core().enable(_cap);});
+  }
+
+  static void GLAPIENTRY disable(GLenum _cap)
+  {
+    called("glDisable",[=](){GLDispatch::core().disable(_cap);});
+  }
+
+  static void GLAPIENTRY pointSize(GLfloat _size)
+  {
+    called("glPointSize",[=](){GLDispatch::core().pointSize(_size);});
+  }
+
+  static void GLAPIENTRY polygonMode(GLenum _face, GLenum _mode)
+  {
+    called("glPolygonMode",[=](){GLDispatch::core().polygonMode(_face,_mode);});
+  }
+
+  static void GLAPIENTRY texParameteri(GLenum _target, GLenum _name, GLint _param)
+  {
+    called("glTexParameteri",[=](){GLDispatch::core().texParameteri(_target,_name,_param);});
+  }
+};
+
+// one Stub instantiation per line
+#define NGL_MOCK_STUB(_name) Functions::stub<__LINE__>(*this,__glew##_name,"gl" #_name)
+
+//----------------------------------------------------------------------------------------------------------------------
+bool GLMock::install() noexcept
+{
+  if(s_installed != nullptr)
+  {
+    std::cerr<<"GLMock already installed\n";
+    return s_installed == this;
+  }
+  s_installed=this;
+
+  m_oldCore=GLDispatch::core();
+  GLCoreFunctions core;
+  core.bindTexture=Functions::bindTexture;
+  core.blendFunc=Functions::blendFunc;
+  core.deleteTextures=Functions::deleteTextures;
+  core.disable=Functions::disable;
+  core.drawArrays=Functions::drawArrays;
+  core.drawElements=Functions::drawElements;
+  core.enable=Functions::enable;
+  core.genTextures=Functions::genTextures;
+  core.getError=Functions::getError;
+  core.getIntegerv=Functions::getIntegerv;
+  core.getString=Functions::getString;
+  core.pointSize=Functions::pointSize;
+  core.polygonMode=Functions::polygonMode;
+  core.readPixels=Functions::readPixels;
+  core.texImage2D=Functions::texImage2D;
+  core.texParameteri=Functions::texParameteri;
+  GLDispatch::setCoreFunctions(core);
+
+  hook(__glewGenBuffers,Functions::genBuffers);
+  hook(__glewDeleteBuffers,Functions::deleteBuffers);
+  hook(__glewBindBuffer,Functions::bindBuffer);
+  hook(__glewBufferData,Functions::bufferData);
+  hook(__glewBufferStorage,Functions::bufferStorage);
+  hook(__glewBufferSubData,Functions::bufferSubData);
+  hook(__glewGetBufferSubData,Functions::getBufferSubData);
+  hook(__glewGetBufferParameteriv,Functions::getBufferParameteriv);
+  hook(__glewCopyBufferSubData,Functions::copyBufferSubData);
+  hook(__glewMapBuffer,Functions::mapBuffer);
+  hook(__glewMapBufferRange,Functions::mapBufferRange);
+  hook(__glewUnmapBuffer,Functions::unmapBuffer);
+  hook(__glewGenVertexArrays,Functions::genVertexArrays);
+  hook(__glewDeleteVertexArrays,Functions::deleteVertexArrays);
+  hook(__glewCreateShader,Functions::createShader);
+  hook(__glewDeleteShader,Functions::deleteShader);
+  hook(__glewShaderSource,Functions::shaderSource);
+  hook(__glewGetShaderiv,Functions::getShaderiv);
+  hook(__glewCreateProgram,Functions::createProgram);
+  hook(__glewDeleteProgram,Functions::deleteProgram);
+  hook(__glewGetProgramiv,Functions::getProgramiv);
+  hook(__glewGetProgramInterfaceiv,Functions::getProgramInterfaceiv);
+  hook(__glewGetUniformLocation,Functions::getUniformLocation);
+  hook(__glewGetAttribLocation,Functions::getAttribLocation);
+  hook(__glewFenceSync,Functions::fenceSync);
+  hook(__glewClientWaitSync,Functions::clientWaitSync);
+  hook(__glewDrawArraysInstanced,Functions::drawArraysInstanced);
+  hook(__glewDrawElementsInstanced,Functions::drawElementsInstanced);
+  hook(__glewDrawElementsBaseVertex,Functions::drawElementsBaseVertex);
+  hook(__glewMultiDrawElementsIndirect,Functions::multiDrawElementsIndirect);
+  hook(__glewActiveTexture,Functions::activeTexture);
+  hook(__glewGenQueries,Functions::genQueries);
+  hook(__glewGetQueryObjectiv,Functions::getQueryObjectiv);
+  hook(__glewGetQueryObjectui64v,Functions::getQueryObjectui64v);
+
+  NGL_MOCK_STUB(AttachShader);
+  NGL_MOCK_STUB(BindAttribLocation);
+  NGL_MOCK_STUB(BindBufferRange);
+  NGL_MOCK_STUB(BindFragDataLocation);
+  NGL_MOCK_STUB(BeginQuery);
+  NGL_MOCK_STUB(BindVertexArray);
+  NGL_MOCK_STUB(CompileShader);
+  NGL_MOCK_STUB(DeleteQueries);
+  NGL_MOCK_STUB(DeleteSync);
+  NGL_MOCK_STUB(DisableVertexAttribArray);
+  NGL_MOCK_STUB(EnableVertexAttribArray);
+  NGL_MOCK_STUB(EndQuery);
+  NGL_MOCK_STUB(GenerateMipmap);
+  NGL_MOCK_STUB(GetActiveAttrib);
+  NGL_MOCK_STUB(GetActiveUniform);
+  NGL_MOCK_STUB(GetActiveUniformName);
+  NGL_MOCK_STUB(GetProgramBinary);
+  NGL_MOCK_STUB(GetProgramInfoLog);
+  NGL_MOCK_STUB(GetShaderInfoLog);
+  NGL_MOCK_STUB(GetUniformBlockIndex);
+  NGL_MOCK_STUB(GetUniformfv);
+  NGL_MOCK_STUB(GetUniformiv);
+  NGL_MOCK_STUB(LinkProgram);
+  NGL_MOCK_STUB(MaxShaderCompilerThreadsARB);
+  NGL_MOCK_STUB(ProgramBinary);
+  NGL_MOCK_STUB(ProgramParameteri);
+  NGL_MOCK_STUB(QueryCounter);
+  NGL_MOCK_STUB(Uniform1f);
+  NGL_MOCK_STUB(Uniform1fv);
+  NGL_MOCK_STUB(Uniform1i);
+  NGL_MOCK_STUB(Uniform1iv);
+  NGL_MOCK_STUB(Uniform2f);
+  NGL_MOCK_STUB(Uniform2fv);
+  NGL_MOCK_STUB(Uniform2i);
+  NGL_MOCK_STUB(Uniform2iv);
+  NGL_MOCK_STUB(Uniform3f);
+  NGL_MOCK_STUB(Uniform3fv);
+  NGL_MOCK_STUB(Uniform3i);
+  NGL_MOCK_STUB(Uniform3iv);
+  NGL_MOCK_STUB(Uniform4f);
+  NGL_MOCK_STUB(Uniform4fv);
+  NGL_MOCK_STUB(Uniform4i);
+  NGL_MOCK_STUB(Uniform4iv);
+  NGL_MOCK_STUB(UniformBlockBinding);
+  NGL_MOCK_STUB(UniformMatrix2fv);
+  NGL_MOCK_STUB(UniformMatrix2x3fv);
+  NGL_MOCK_STUB(UniformMatrix2x4fv);
+  NGL_MOCK_STUB(UniformMatrix3fv);
+  NGL_MOCK_STUB(UniformMatrix3x2fv);
+  NGL_MOCK_STUB(UniformMatrix3x4fv);
+  NGL_MOCK_STUB(UniformMatrix4fv);
+  NGL_MOCK_STUB(UniformMatrix4x2fv);
+  NGL_MOCK_STUB(UniformMatrix4x3fv);
+  NGL_MOCK_STUB(UseProgram);
+  NGL_MOCK_STUB(VertexAttribDivisor);
+  NGL_MOCK_STUB(VertexAttribIPointer);
+  NGL_MOCK_STUB(VertexAttribPointer);
+
+  // whatever the cache holds belongs to the real context
+  GLState::instance()->invalidate();
+  return true;
+}
+
+#undef NGL_MOCK_STUB
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLMock::uninstall() noexcept
+{
+  if(s_installed != this)
+  {
+    return;
+  }
+  for(auto restore=m_restore.rbegin(); restore!=m_restore.rend(); ++restore)
+  {
+    (*restore)();
+  }
+  m_restore.clear();
+  GLDispatch::setCoreFunctions(m_oldCore);
+  GLState::instance()->invalidate();
+  s_installed=nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GLMock::~GLMock() noexcept
+{
+  uninstall();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLMock::called(const char *_name, std::function<void()> &&_replay)
+{
+  ++m_counts[_name];
+  ++m_frameCounts[_name];
+  if(m_recording)
+  {
+    m_calls.push_back({_name,std::move(_replay)});
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t GLMock::getCallCount(const std::string &_name) const noexcept
+{
+  auto count=m_counts.find(_name);
+  return count != m_counts.end() ? count->second : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t GLMock::getFrameCallCount(const std::string &_name) const noexcept
+{
+  auto count=m_frameCounts.find(_name);
+  return count != m_frameCounts.end() ? count->second : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t GLMock::getLastFrameCallCount(const std::string &_name) const noexcept
+{
+  auto count=m_lastFrameCounts.find(_name);
+  return count != m_lastFrameCounts.end() ? count->second : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLMock::endFrame() noexcept
+{
+  m_lastFrameCounts.swap(m_frameCounts);
+  m_frameCounts.clear();
+  m_lastFrameDraws=m_frameDraws;
+  m_frameDraws=0;
+  ++m_frame;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLMock::resetCounters() noexcept
+{
+  m_counts.clear();
+  m_frameCounts.clear();
+  m_lastFrameCounts.clear();
+  m_draws=m_frameDraws=m_lastFrameDraws=0;
+  m_uploadBytes=0;
+  m_badDeletes=0;
+  m_frame=0;
+  m_calls.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLMock::replay() const
+{
+  // copied as replaying into this mock while recording would grow m_calls
+  std::vector<Call> calls=m_calls;
+  for(auto &c : calls)
+  {
+    if(c.replay)
+    {
+      c.replay();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t GLMock::getNumObjects(ObjectType _type) const noexcept
+{
+  switch(_type)
+  {
+    case BUFFER : return m_buffers.size();
+    case VERTEXARRAY : return m_vertexArrays.size();
+    case TEXTURE : return m_textures.size();
+    case SHADER : return m_shaders.size();
+    case PROGRAM : return m_programs.size();
+    default : return 0;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const std::vector<unsigned char> &GLMock::getBufferData(GLuint _buffer) const noexcept
+{
+  static const std::vector<unsigned char> empty;
+  auto buffer=m_buffers.find(_buffer);
+  return buffer != m_buffers.end() ? buffer->second : empty;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t GLMock::getBufferBytes() const noexcept
+{
+  size_t total=0;
+  for(auto &b : m_buffers)
+  {
+    total+=b.second.size();
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t GLMock::getTextureBytes() const noexcept
+{
+  size_t total=0;
+  for(auto &t : m_textures)
+  {
+    total+=t.second;
+  }
+  return total;
+}
+
+} // end ngl namespace
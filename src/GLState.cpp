@@ -0,0 +1,295 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GLState.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "ResourceTracker.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLState.cpp
+/// @brief implementation files for GLState class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+using namespace dispatch;
+constexpr unsigned int GLState::MAXTEXTUREUNITS;
+constexpr GLuint GLState::UNKNOWN;
+constexpr unsigned int GLState::NUMCAPABILITIES;
+
+namespace
+{
+  // the index of a tracked enable flag or -1
+  int capabilityIndex(GLenum _cap) noexcept
+  {
+    switch(_cap)
+    {
+      case GL_DEPTH_TEST : return 0;
+      case GL_BLEND : return 1;
+      case GL_CULL_FACE : return 2;
+      case GL_SCISSOR_TEST : return 3;
+      case GL_STENCIL_TEST : return 4;
+#ifndef USINGIOS_
+      case GL_MULTISAMPLE : return 5;
+      case GL_PROGRAM_POINT_SIZE : return 6;
+#endif
+      default : return -1;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GLState *GLState::instance() noexcept
+{
+  // trivially destructible so it is still usable from other objects' destructors at exit
+  static GLState s_state;
+  return &s_state;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GLState::GLState() noexcept
+{
+  invalidate();
+  m_issued.fill(0);
+  m_elided.fill(0);
+  m_lastIssued.fill(0);
+  m_lastElided.fill(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::invalidate() noexcept
+{
+  m_program=UNKNOWN;
+  m_vao=UNKNOWN;
+  m_arrayBuffer=UNKNOWN;
+  m_elementBuffer=UNKNOWN;
+  m_activeUnit=UNKNOWN;
+  m_textures.fill(UNKNOWN);
+  m_capabilities.fill(-1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::useProgram(GLuint _program) noexcept
+{
+  if(_program == m_program)
+  {
+    ++m_elided[PROGRAM];
+    return;
+  }
+  glUseProgram(_program);
+  m_program=_program;
+  ++m_issued[PROGRAM];
+  FrameStats::instance()->add(FrameStats::PROGRAMSWITCHES);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::bindVertexArray(GLuint _vao) noexcept
+{
+  if(_vao == m_vao)
+  {
+    ++m_elided[VERTEXARRAY];
+    return;
+  }
+  glBindVertexArray(_vao);
+  m_vao=_vao;
+  // the element buffer binding is part of the vertex array
+  m_elementBuffer=UNKNOWN;
+  ++m_issued[VERTEXARRAY];
+  FrameStats::instance()->add(FrameStats::VAOBINDS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::bindBuffer(GLenum _target, GLuint _buffer) noexcept
+{
+  GLuint *cached=nullptr;
+  if(_target == GL_ARRAY_BUFFER)
+  {
+    cached=&m_arrayBuffer;
+  }
+  else if(_target == GL_ELEMENT_ARRAY_BUFFER)
+  {
+    cached=&m_elementBuffer;
+  }
+  if(cached != nullptr && *cached == _buffer)
+  {
+    ++m_elided[BUFFER];
+    return;
+  }
+  glBindBuffer(_target,_buffer);
+  if(cached != nullptr)
+  {
+    *cached=_buffer;
+  }
+  ++m_issued[BUFFER];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::activeTexture(GLenum _unit) noexcept
+{
+  GLuint unit=_unit-GL_TEXTURE0;
+  if(unit == m_activeUnit)
+  {
+    ++m_elided[TEXTURE];
+    return;
+  }
+  glActiveTexture(_unit);
+  m_activeUnit=unit;
+  ++m_issued[TEXTURE];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::bindTexture(GLenum _target, GLuint _texture) noexcept
+{
+  bool tracked= _target == GL_TEXTURE_2D && m_activeUnit < MAXTEXTUREUNITS;
+  if(tracked && m_textures[m_activeUnit] == _texture)
+  {
+    ++m_elided[TEXTURE];
+    return;
+  }
+  glBindTexture(_target,_texture);
+  if(tracked)
+  {
+    m_textures[m_activeUnit]=_texture;
+  }
+  ++m_issued[TEXTURE];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::setCapability(GLenum _cap, bool _state) noexcept
+{
+  int index=capabilityIndex(_cap);
+  if(index >= 0 && m_capabilities[index] == static_cast<int8_t>(_state))
+  {
+    ++m_elided[CAPABILITY];
+    return;
+  }
+  if(_state)
+  {
+    glEnable(_cap);
+  }
+  else
+  {
+    glDisable(_cap);
+  }
+  if(index >= 0)
+  {
+    m_capabilities[index]=static_cast<int8_t>(_state);
+  }
+  ++m_issued[CAPABILITY];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::enable(GLenum _cap) noexcept
+{
+  setCapability(_cap,true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::disable(GLenum _cap) noexcept
+{
+  setCapability(_cap,false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::deleteProgram(GLuint _program) noexcept
+{
+  glDeleteProgram(_program);
+  // a deleted program stays current until replaced but its name can be reused
+  if(_program == m_program)
+  {
+    m_program=UNKNOWN;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::deleteVertexArrays(GLsizei _n, const GLuint *_vaos) noexcept
+{
+  glDeleteVertexArrays(_n,_vaos);
+  for(GLsizei i=0; i<_n; ++i)
+  {
+    if(_vaos[i] == m_vao)
+    {
+      m_vao=0;
+      m_elementBuffer=UNKNOWN;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::deleteBuffers(GLsizei _n, const GLuint *_buffers) noexcept
+{
+  glDeleteBuffers(_n,_buffers);
+  for(GLsizei i=0; i<_n; ++i)
+  {
+    if(_buffers[i] == m_arrayBuffer)
+    {
+      m_arrayBuffer=0;
+    }
+    if(_buffers[i] == m_elementBuffer)
+    {
+      m_elementBuffer=0;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::deleteTextures(GLsizei _n, const GLuint *_textures) noexcept
+{
+  glDeleteTextures(_n,_textures);
+  for(GLsizei i=0; i<_n; ++i)
+  {
+    for(auto &t : m_textures)
+    {
+      if(t == _textures[i])
+      {
+        t=0;
+      }
+    }
+    ResourceTracker::instance()->release(ResourceTracker::TEXTURE,static_cast<uintptr_t>(_textures[i]));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLState::newFrame() noexcept
+{
+  m_lastIssued=m_issued;
+  m_lastElided=m_elided;
+  m_issued.fill(0);
+  m_elided.fill(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t GLState::getTotalIssued() const noexcept
+{
+  uint64_t total=0;
+  for(auto c : m_lastIssued)
+  {
+    total+=c;
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t GLState::getTotalElided() const noexcept
+{
+  uint64_t total=0;
+  for(auto c : m_lastElided)
+  {
+    total+=c;
+  }
+  return total;
+}
+
+} // end ngl namespace
@@ -0,0 +1,340 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GPUProfiler.h"
+#include "Logger.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GPUProfiler.cpp
+/// @brief implementation files for GPUProfiler class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+constexpr unsigned int GPUProfiler::FRAMELATENCY;
+constexpr unsigned int GPUProfiler::STATSWINDOW;
+
+//----------------------------------------------------------------------------------------------------------------------
+GPUProfiler *GPUProfiler::instance() noexcept
+{
+  // never deleted, the queries belong to the context and it has gone by the time statics are destroyed
+  static GPUProfiler *s_profiler=new GPUProfiler;
+  return s_profiler;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool GPUProfiler::isSupported() const noexcept
+{
+  return glQueryCounter != nullptr && glGetQueryObjectui64v != nullptr && glGenQueries != nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GLuint GPUProfiler::getQuery()
+{
+  if(m_freeQueries.empty())
+  {
+    // grab a batch at a time rather than one per scope
+    GLuint queries[32];
+    glGenQueries(32,queries);
+    m_freeQueries.insert(m_freeQueries.end(),queries,queries+32);
+    m_allQueries.insert(m_allQueries.end(),queries,queries+32);
+  }
+  GLuint query=m_freeQueries.back();
+  m_freeQueries.pop_back();
+  return query;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::beginFrame()
+{
+  if(m_inFrame)
+  {
+    endFrame();
+  }
+  if(!m_enabled || !isSupported())
+  {
+    return;
+  }
+  // the slot this frame writes into must be finished with, it is normally resolved already
+  Frame &reuse=m_frames[m_frame%m_frames.size()];
+  if(reuse.pending)
+  {
+    resolve(reuse,true);
+  }
+  // the frame FRAMELATENCY ago should be done by now, if not leave it for another frame
+  if(m_frame >= FRAMELATENCY)
+  {
+    Frame &old=m_frames[(m_frame-FRAMELATENCY)%m_frames.size()];
+    if(old.pending)
+    {
+      resolve(old,false);
+    }
+  }
+  m_inFrame=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::endFrame()
+{
+  if(!m_inFrame)
+  {
+    return;
+  }
+  if(!m_open.empty())
+  {
+    std::cerr<<"GPUProfiler "<<m_open.size()<<" scopes left open at the end of the frame\n";
+    while(!m_open.empty())
+    {
+      end();
+    }
+  }
+  Frame &frame=m_frames[m_frame%m_frames.size()];
+  frame.pending=!frame.samples.empty();
+  m_inFrame=false;
+  ++m_frame;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool GPUProfiler::begin(const char *_name)
+{
+  if(!m_inFrame || !m_enabled)
+  {
+    return false;
+  }
+  Frame &frame=m_frames[m_frame%m_frames.size()];
+  Sample sample;
+  sample.id=StringID(_name);
+  sample.depth=static_cast<unsigned int>(m_open.size());
+  sample.begin=getQuery();
+  sample.end=getQuery();
+  glQueryCounter(sample.begin,GL_TIMESTAMP);
+  frame.lastQuery=sample.begin;
+  if(m_scopes.find(sample.id) == m_scopes.end())
+  {
+    Scope &scope=m_scopes[sample.id];
+    scope.stats.name=_name;
+    m_order.push_back(sample.id);
+  }
+  m_open.push_back(frame.samples.size());
+  frame.samples.push_back(sample);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::end()
+{
+  if(m_open.empty())
+  {
+    return;
+  }
+  Frame &frame=m_frames[m_frame%m_frames.size()];
+  GLuint query=frame.samples[m_open.back()].end;
+  glQueryCounter(query,GL_TIMESTAMP);
+  frame.lastQuery=query;
+  m_open.pop_back();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool GPUProfiler::resolve(Frame &_frame, bool _wait)
+{
+  if(!_wait)
+  {
+    // queries complete in the order they were issued so the last one being ready means they all are
+    GLint available=GL_FALSE;
+    glGetQueryObjectiv(_frame.lastQuery,GL_QUERY_RESULT_AVAILABLE,&available);
+    if(available == GL_FALSE)
+    {
+      return false;
+    }
+  }
+  for(auto &sample : _frame.samples)
+  {
+    GLuint64 begin=0;
+    GLuint64 end=0;
+    glGetQueryObjectui64v(sample.begin,GL_QUERY_RESULT,&begin);
+    glGetQueryObjectui64v(sample.end,GL_QUERY_RESULT,&end);
+    uint64_t duration= end > begin ? end-begin : 0;
+    addSample(sample,static_cast<double>(duration)*1.0e-6);
+    if(m_tracing)
+    {
+      if(m_trace.size() >= m_maxTraceEvents)
+      {
+        m_trace.erase(m_trace.begin(),m_trace.begin()+static_cast<std::ptrdiff_t>(m_trace.size()/4+1));
+      }
+      m_trace.push_back({sample.id,begin,duration});
+    }
+    m_freeQueries.push_back(sample.begin);
+    m_freeQueries.push_back(sample.end);
+  }
+  _frame.samples.clear();
+  _frame.pending=false;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::addSample(const Sample &_sample, double _ms)
+{
+  Scope &scope=m_scopes[_sample.id];
+  Stats &stats=scope.stats;
+  scope.window[scope.next]=_ms;
+  scope.next=(scope.next+1)%STATSWINDOW;
+  ++stats.samples;
+  stats.depth=_sample.depth;
+  stats.lastMs=_ms;
+  size_t count=std::min<uint64_t>(stats.samples,STATSWINDOW);
+  auto first=scope.window.begin();
+  stats.minMs=*std::min_element(first,first+count);
+  stats.maxMs=*std::max_element(first,first+count);
+  double total=0.0;
+  for(size_t i=0; i<count; ++i)
+  {
+    total+=scope.window[i];
+  }
+  stats.averageMs=total/static_cast<double>(count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::flush()
+{
+  if(m_inFrame)
+  {
+    endFrame();
+  }
+  // oldest first so the trace stays in order
+  for(size_t i=m_frames.size(); i>0; --i)
+  {
+    Frame &frame=m_frames[(m_frame+m_frames.size()-i)%m_frames.size()];
+    if(frame.pending)
+    {
+      resolve(frame,true);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const GPUProfiler::Stats *GPUProfiler::getStats(const std::string &_name) const noexcept
+{
+  auto scope=m_scopes.find(StringID(_name));
+  if(scope == m_scopes.end() || scope->second.stats.samples == 0)
+  {
+    return nullptr;
+  }
+  return &scope->second.stats;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<GPUProfiler::Stats> GPUProfiler::getAllStats() const
+{
+  std::vector<Stats> stats;
+  stats.reserve(m_order.size());
+  for(auto id : m_order)
+  {
+    const Stats &s=m_scopes.at(id).stats;
+    if(s.samples != 0)
+    {
+      stats.push_back(s);
+    }
+  }
+  return stats;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::report() const
+{
+  Logger *log=Logger::instance();
+  log->logMessage("GPU times in ms over the last %u frames\n",STATSWINDOW);
+  for(auto &s : getAllStats())
+  {
+    log->logMessage("%*s%-32.32s last %8.3f avg %8.3f min %8.3f max %8.3f\n",s.depth*2,"",s.name.c_str(),
+                    s.lastMs,s.averageMs,s.minMs,s.maxMs);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::setTraceCapture(bool _state, size_t _maxEvents) noexcept
+{
+  m_tracing=_state;
+  m_maxTraceEvents=std::max<size_t>(_maxEvents,1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool GPUProfiler::writeTrace(const std::string &_fname) const
+{
+  std::ofstream file(_fname);
+  if(!file.is_open())
+  {
+    std::cerr<<"GPUProfiler can't write trace "<<_fname<<"\n";
+    return false;
+  }
+  namespace rj=rapidjson;
+  rj::StringBuffer buffer;
+  rj::Writer<rj::StringBuffer> writer(buffer);
+  // timestamps are relative to the first event so the numbers stay readable
+  uint64_t origin= m_trace.empty() ? 0 : m_trace.front().start;
+  writer.StartObject();
+  writer.Key("traceEvents");
+  writer.StartArray();
+  writer.StartObject();
+  writer.Key("name"); writer.String("thread_name");
+  writer.Key("ph"); writer.String("M");
+  writer.Key("pid"); writer.Int(0);
+  writer.Key("tid"); writer.Int(0);
+  writer.Key("args"); writer.StartObject(); writer.Key("name"); writer.String("GPU"); writer.EndObject();
+  writer.EndObject();
+  for(auto &e : m_trace)
+  {
+    writer.StartObject();
+    writer.Key("name"); writer.String(m_scopes.at(e.id).stats.name.c_str());
+    writer.Key("cat"); writer.String("gpu");
+    writer.Key("ph"); writer.String("X");
+    writer.Key("pid"); writer.Int(0);
+    writer.Key("tid"); writer.Int(0);
+    writer.Key("ts"); writer.Double(static_cast<double>(e.start-origin)*1.0e-3);
+    writer.Key("dur"); writer.Double(static_cast<double>(e.duration)*1.0e-3);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+  file<<buffer.GetString();
+  return file.good();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GPUProfiler::reset()
+{
+  m_inFrame=false;
+  m_open.clear();
+  for(auto &frame : m_frames)
+  {
+    frame.samples.clear();
+    frame.pending=false;
+  }
+  if(!m_allQueries.empty() && glDeleteQueries != nullptr)
+  {
+    glDeleteQueries(static_cast<GLsizei>(m_allQueries.size()),m_allQueries.data());
+  }
+  m_allQueries.clear();
+  m_freeQueries.clear();
+  m_scopes.clear();
+  m_order.clear();
+  m_trace.clear();
+  m_frame=0;
+}
+
+} // end ngl namespace
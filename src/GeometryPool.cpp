@@ -0,0 +1,459 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GeometryPool.h"
+#include "FrameStats.h"
+#include "GLState.h"
+#include "NGLassert.h"
+#include "ResourceTracker.h"
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GeometryPool.cpp
+/// @brief implementation files for RangeAllocator and GeometryPool classes
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+constexpr size_t RangeAllocator::INVALID;
+constexpr size_t GeometryPool::VERTEXSIZE;
+constexpr size_t GeometryPool::INVALID;
+
+//----------------------------------------------------------------------------------------------------------------------
+RangeAllocator::RangeAllocator(size_t _capacity) noexcept : m_capacity(0)
+{
+  grow(_capacity);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t RangeAllocator::allocate(size_t _size) noexcept
+{
+  if(_size == 0)
+  {
+    return INVALID;
+  }
+  for(auto it=m_free.begin(); it!=m_free.end(); ++it)
+  {
+    if(it->size >= _size)
+    {
+      size_t offset=it->offset;
+      it->offset+=_size;
+      it->size-=_size;
+      if(it->size == 0)
+      {
+        m_free.erase(it);
+      }
+      return offset;
+    }
+  }
+  return INVALID;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void RangeAllocator::release(size_t _offset, size_t _size) noexcept
+{
+  if(_size == 0)
+  {
+    return;
+  }
+  NGL_ASSERT(_offset+_size <= m_capacity);
+  auto next=std::lower_bound(m_free.begin(),m_free.end(),_offset,
+                             [](const Range &_r, size_t _o){return _r.offset < _o;});
+  // merge with the free range after and / or before so the list never holds neighbours
+  bool mergeNext= next!=m_free.end() && _offset+_size == next->offset;
+  bool mergePrev= next!=m_free.begin() && (next-1)->offset+(next-1)->size == _offset;
+  if(mergePrev && mergeNext)
+  {
+    (next-1)->size+=_size+next->size;
+    m_free.erase(next);
+  }
+  else if(mergePrev)
+  {
+    (next-1)->size+=_size;
+  }
+  else if(mergeNext)
+  {
+    next->offset=_offset;
+    next->size+=_size;
+  }
+  else
+  {
+    m_free.insert(next,{_offset,_size});
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void RangeAllocator::grow(size_t _capacity) noexcept
+{
+  if(_capacity <= m_capacity)
+  {
+    return;
+  }
+  size_t old=m_capacity;
+  m_capacity=_capacity;
+  release(old,_capacity-old);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void RangeAllocator::reset(size_t _capacity, size_t _used) noexcept
+{
+  NGL_ASSERT(_used <= _capacity);
+  m_free.clear();
+  m_capacity=_capacity;
+  if(_used < _capacity)
+  {
+    m_free.push_back({_used,_capacity-_used});
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t RangeAllocator::getFree() const noexcept
+{
+  size_t total=0;
+  for(auto &r : m_free)
+  {
+    total+=r.size;
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t RangeAllocator::getLargestFree() const noexcept
+{
+  size_t largest=0;
+  for(auto &r : m_free)
+  {
+    largest=std::max(largest,r.size);
+  }
+  return largest;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GeometryPool::GeometryPool(size_t _vertexCapacity, size_t _indexCapacity) noexcept :
+  m_vertexAlloc(std::max<size_t>(_vertexCapacity,1)),m_indexAlloc(std::max<size_t>(_indexCapacity,1))
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GeometryPool::~GeometryPool() noexcept
+{
+  if(m_vao != 0)
+  {
+    GLuint buffers[]={m_vertexBuffer,m_indexBuffer,m_indirectBuffer,m_transformBuffer};
+    GLState::instance()->deleteBuffers(4,buffers);
+    GLState::instance()->deleteVertexArrays(1,&m_vao);
+    ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::createGL() noexcept
+{
+#ifndef USINGIOS_
+  m_multiDraw= GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+#endif
+  glGenVertexArrays(1,&m_vao);
+  glGenBuffers(1,&m_vertexBuffer);
+  glGenBuffers(1,&m_indexBuffer);
+  glGenBuffers(1,&m_indirectBuffer);
+  glGenBuffers(1,&m_transformBuffer);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(m_vertexAlloc.getCapacity()*VERTEXSIZE*sizeof(Real)),nullptr,GL_STATIC_DRAW);
+  GLState::instance()->bindVertexArray(m_vao);
+  GLState::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER,m_indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,static_cast<GLsizeiptr>(m_indexAlloc.getCapacity()*sizeof(GLuint)),nullptr,GL_STATIC_DRAW);
+  GLState::instance()->bindVertexArray(0);
+  setVertexAttributes();
+  trackMemory();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::trackMemory() const
+{
+  size_t bytes=m_vertexAlloc.getCapacity()*VERTEXSIZE*sizeof(Real)+m_indexAlloc.getCapacity()*sizeof(GLuint)+
+               m_transformSize+m_indirectSize;
+  ResourceTracker::instance()->track(ResourceTracker::BUFFER,this,bytes,"GeometryPool");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::setVertexAttributes() noexcept
+{
+  // the same u,v,nx,ny,nz,x,y,z layout and locations as VAOPrimitives
+  GLsizei stride=static_cast<GLsizei>(VERTEXSIZE*sizeof(Real));
+  GLState::instance()->bindVertexArray(m_vao);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_vertexBuffer);
+  glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,stride,static_cast<Real *>(nullptr)+5);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1,2,GL_FLOAT,GL_FALSE,stride,static_cast<Real *>(nullptr));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2,3,GL_FLOAT,GL_FALSE,stride,static_cast<Real *>(nullptr)+2);
+  glEnableVertexAttribArray(2);
+  GLState::instance()->bindVertexArray(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::reallocate(GLuint &io_buffer, GLenum _target, size_t _newSize, const std::vector<size_t> &_ranges) noexcept
+{
+  // copy on the GPU into a new buffer, copying within one buffer isn't allowed when the ranges overlap
+  GLuint buffer;
+  glGenBuffers(1,&buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER,buffer);
+  glBufferData(GL_COPY_WRITE_BUFFER,static_cast<GLsizeiptr>(_newSize),nullptr,GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_READ_BUFFER,io_buffer);
+  for(size_t i=0; i+2<_ranges.size(); i+=3)
+  {
+    glCopyBufferSubData(GL_COPY_READ_BUFFER,GL_COPY_WRITE_BUFFER,static_cast<GLintptr>(_ranges[i]),
+                        static_cast<GLintptr>(_ranges[i+1]),static_cast<GLsizeiptr>(_ranges[i+2]));
+  }
+  GLState::instance()->deleteBuffers(1,&io_buffer);
+  io_buffer=buffer;
+  if(_target == GL_ELEMENT_ARRAY_BUFFER)
+  {
+    GLState::instance()->bindVertexArray(m_vao);
+    GLState::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER,io_buffer);
+    GLState::instance()->bindVertexArray(0);
+  }
+  else
+  {
+    setVertexAttributes();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::growVertices(size_t _size) noexcept
+{
+  size_t capacity=m_vertexAlloc.getCapacity();
+  size_t newCapacity=std::max(capacity*2,capacity+_size);
+  size_t bytes=VERTEXSIZE*sizeof(Real);
+  reallocate(m_vertexBuffer,GL_ARRAY_BUFFER,newCapacity*bytes,{0,0,capacity*bytes});
+  m_vertexAlloc.grow(newCapacity);
+  trackMemory();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::growIndices(size_t _size) noexcept
+{
+  size_t capacity=m_indexAlloc.getCapacity();
+  size_t newCapacity=std::max(capacity*2,capacity+_size);
+  reallocate(m_indexBuffer,GL_ELEMENT_ARRAY_BUFFER,newCapacity*sizeof(GLuint),{0,0,capacity*sizeof(GLuint)});
+  m_indexAlloc.grow(newCapacity);
+  trackMemory();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t GeometryPool::addMesh(const Real *_verts, size_t _numVerts, const GLuint *_indices, size_t _numIndices) noexcept
+{
+  if(_numVerts == 0)
+  {
+    return INVALID;
+  }
+  if(m_vao == 0)
+  {
+    createGL();
+  }
+  // un-indexed data is drawn with a sequential index list so everything goes through one draw type
+  std::vector<GLuint> sequence;
+  if(_indices == nullptr)
+  {
+    sequence.resize(_numVerts);
+    std::iota(sequence.begin(),sequence.end(),0u);
+    _indices=sequence.data();
+    _numIndices=_numVerts;
+  }
+  Mesh mesh;
+  mesh.numVerts=_numVerts;
+  mesh.numIndices=_numIndices;
+  mesh.live=true;
+  mesh.firstVertex=m_vertexAlloc.allocate(_numVerts);
+  if(mesh.firstVertex == RangeAllocator::INVALID)
+  {
+    growVertices(_numVerts);
+    mesh.firstVertex=m_vertexAlloc.allocate(_numVerts);
+  }
+  mesh.firstIndex=m_indexAlloc.allocate(_numIndices);
+  if(mesh.firstIndex == RangeAllocator::INVALID)
+  {
+    growIndices(_numIndices);
+    mesh.firstIndex=m_indexAlloc.allocate(_numIndices);
+  }
+  // upload through the copy target so the VAO's element binding isn't disturbed
+  size_t bytes=VERTEXSIZE*sizeof(Real);
+  glBindBuffer(GL_COPY_WRITE_BUFFER,m_vertexBuffer);
+  glBufferSubData(GL_COPY_WRITE_BUFFER,static_cast<GLintptr>(mesh.firstVertex*bytes),static_cast<GLsizeiptr>(_numVerts*bytes),_verts);
+  FrameStats::instance()->addBufferUpload(_numVerts*bytes);
+  glBindBuffer(GL_COPY_WRITE_BUFFER,m_indexBuffer);
+  glBufferSubData(GL_COPY_WRITE_BUFFER,static_cast<GLintptr>(mesh.firstIndex*sizeof(GLuint)),
+                  static_cast<GLsizeiptr>(_numIndices*sizeof(GLuint)),_indices);
+  FrameStats::instance()->addBufferUpload(_numIndices*sizeof(GLuint));
+  size_t id;
+  if(!m_freeIDs.empty())
+  {
+    id=m_freeIDs.back();
+    m_freeIDs.pop_back();
+    m_meshes[id]=mesh;
+  }
+  else
+  {
+    id=m_meshes.size();
+    m_meshes.push_back(mesh);
+  }
+  ++m_numMeshes;
+  return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::removeMesh(size_t _id) noexcept
+{
+  if(_id >= m_meshes.size() || !m_meshes[_id].live)
+  {
+    return;
+  }
+  Mesh &mesh=m_meshes[_id];
+  m_vertexAlloc.release(mesh.firstVertex,mesh.numVerts);
+  m_indexAlloc.release(mesh.firstIndex,mesh.numIndices);
+  mesh.live=false;
+  m_freeIDs.push_back(_id);
+  --m_numMeshes;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::defragment() noexcept
+{
+  if(m_vao == 0)
+  {
+    return;
+  }
+  std::vector<size_t> order;
+  for(size_t i=0; i<m_meshes.size(); ++i)
+  {
+    if(m_meshes[i].live)
+    {
+      order.push_back(i);
+    }
+  }
+  // pack the vertices in their current order then the indices in theirs
+  std::vector<size_t> ranges;
+  size_t bytes=VERTEXSIZE*sizeof(Real);
+  std::sort(order.begin(),order.end(),[this](size_t _a, size_t _b){return m_meshes[_a].firstVertex < m_meshes[_b].firstVertex;});
+  size_t used=0;
+  for(auto i : order)
+  {
+    Mesh &mesh=m_meshes[i];
+    ranges.insert(ranges.end(),{mesh.firstVertex*bytes,used*bytes,mesh.numVerts*bytes});
+    mesh.firstVertex=used;
+    used+=mesh.numVerts;
+  }
+  reallocate(m_vertexBuffer,GL_ARRAY_BUFFER,m_vertexAlloc.getCapacity()*bytes,ranges);
+  m_vertexAlloc.reset(m_vertexAlloc.getCapacity(),used);
+
+  ranges.clear();
+  std::sort(order.begin(),order.end(),[this](size_t _a, size_t _b){return m_meshes[_a].firstIndex < m_meshes[_b].firstIndex;});
+  used=0;
+  for(auto i : order)
+  {
+    Mesh &mesh=m_meshes[i];
+    ranges.insert(ranges.end(),{mesh.firstIndex*sizeof(GLuint),used*sizeof(GLuint),mesh.numIndices*sizeof(GLuint)});
+    mesh.firstIndex=used;
+    used+=mesh.numIndices;
+  }
+  reallocate(m_indexBuffer,GL_ELEMENT_ARRAY_BUFFER,m_indexAlloc.getCapacity()*sizeof(GLuint),ranges);
+  m_indexAlloc.reset(m_indexAlloc.getCapacity(),used);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::addDraw(size_t _id, const Mat4 &_transform) noexcept
+{
+  NGL_ASSERT(_id < m_meshes.size() && m_meshes[_id].live);
+  const Mesh &mesh=m_meshes[_id];
+  DrawCommand cmd;
+  cmd.count=static_cast<GLuint>(mesh.numIndices);
+  cmd.instanceCount=1;
+  cmd.firstIndex=static_cast<GLuint>(mesh.firstIndex);
+  cmd.baseVertex=static_cast<GLint>(mesh.firstVertex);
+  // the base instance picks this draw's transform out of the instanced attribute
+  cmd.baseInstance=static_cast<GLuint>(m_transforms.size());
+  m_commands.push_back(cmd);
+  m_transforms.push_back(_transform);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GeometryPool::submit() noexcept
+{
+  if(m_commands.empty())
+  {
+    return;
+  }
+  static_assert(sizeof(Mat4) == 16*sizeof(Real),"Mat4 must be 16 packed Reals to be used as instance data");
+  // orphan and refill the per frame buffers
+  size_t oldSize=m_transformSize+m_indirectSize;
+  size_t transformSize=m_transforms.size()*sizeof(Mat4);
+  m_transformSize=std::max(m_transformSize,transformSize);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_transformBuffer);
+  glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(m_transformSize),nullptr,GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER,0,static_cast<GLsizeiptr>(transformSize),m_transforms.data());
+  FrameStats::instance()->addBufferUpload(transformSize);
+  GLState::instance()->bindVertexArray(m_vao);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_transformBuffer);
+  for(GLuint i=0; i<4; ++i)
+  {
+    glVertexAttribPointer(m_transformAttribute+i,4,GL_FLOAT,GL_FALSE,sizeof(Mat4),static_cast<Real *>(nullptr)+i*4);
+    glEnableVertexAttribArray(m_transformAttribute+i);
+    glVertexAttribDivisor(m_transformAttribute+i,1);
+  }
+  if(m_multiDraw)
+  {
+    size_t commandSize=m_commands.size()*sizeof(DrawCommand);
+    m_indirectSize=std::max(m_indirectSize,commandSize);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER,m_indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER,static_cast<GLsizeiptr>(m_indirectSize),nullptr,GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER,0,static_cast<GLsizeiptr>(commandSize),m_commands.data());
+    FrameStats::instance()->addBufferUpload(commandSize);
+    glMultiDrawElementsIndirect(GL_TRIANGLES,GL_UNSIGNED_INT,nullptr,static_cast<GLsizei>(m_commands.size()),0);
+    // one call for all the commands
+    FrameStats *stats=FrameStats::instance();
+    stats->add(FrameStats::DRAWCALLS);
+    for(auto &cmd : m_commands)
+    {
+      stats->add(FrameStats::INSTANCES,cmd.instanceCount);
+      stats->add(FrameStats::TRIANGLES,static_cast<uint64_t>(cmd.count/3)*cmd.instanceCount);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER,0);
+  }
+  else
+  {
+    // no base instance here so point the transform attribute at each draw's matrix instead
+    for(auto &cmd : m_commands)
+    {
+      for(GLuint i=0; i<4; ++i)
+      {
+        glVertexAttribPointer(m_transformAttribute+i,4,GL_FLOAT,GL_FALSE,sizeof(Mat4),
+                              static_cast<Real *>(nullptr)+cmd.baseInstance*16+i*4);
+      }
+      FrameStats::instance()->addDraw(GL_TRIANGLES,cmd.count,cmd.instanceCount);
+      glDrawElementsBaseVertex(GL_TRIANGLES,static_cast<GLsizei>(cmd.count),GL_UNSIGNED_INT,
+                               static_cast<GLuint *>(nullptr)+cmd.firstIndex,cmd.baseVertex);
+    }
+  }
+  GLState::instance()->bindVertexArray(0);
+  if(m_transformSize+m_indirectSize != oldSize)
+  {
+    trackMemory();
+  }
+  m_commands.clear();
+  m_transforms.clear();
+}
+
+} // end ngl namespace
@@ -15,6 +15,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "HoudiniGeo.h"
+#include "GLDispatch.h"
 #include <boost/lexical_cast.hpp>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file HoudiniGeo.cpp
@@ -23,6 +24,7 @@
 
 namespace ngl
 {
+using namespace dispatch;
 
 //----------------------------------------------------------------------------------------------------------------------
 bool HoudiniGeo::load(
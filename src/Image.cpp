@@ -19,6 +19,7 @@
 /// @brief implementation files for Image class
 //----------------------------------------------------------------------------------------------------------------------
 #include "Image.h"
+#include "GLDispatch.h"
 #include "NGLassert.h"
 #if defined(USEQIMAGE)
   #include <QtGui/QImage>
@@ -34,6 +35,7 @@
 
 namespace ngl
 {
+using namespace dispatch;
 
 #define IMAGE_DEBUG_ON 1
 
@@ -0,0 +1,165 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "InstancedVAO.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
+#include <iostream>
+
+namespace ngl
+{
+using namespace dispatch;
+  constexpr unsigned int InstancedVAO::MAXSTREAMS;
+
+  InstancedVAO::~InstancedVAO()
+  {
+    removeVAO();
+  }
+
+  void InstancedVAO::draw() const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    glDrawArrays(m_mode, 0, static_cast<GLsizei>(m_indicesCount));
+    FrameStats::instance()->addDraw(m_mode,m_indicesCount);
+  }
+
+  void InstancedVAO::removeVAO()
+  {
+    if(m_bound == true)
+    {
+      unbind();
+    }
+    if( m_allocated ==true)
+    {
+        GLState::instance()->deleteBuffers(1,&m_buffer);
+    }
+    for(unsigned int i=0; i<MAXSTREAMS; ++i)
+    {
+      if(m_instanceBuffers[i] != 0)
+      {
+        GLState::instance()->deleteBuffers(1,&m_instanceBuffers[i]);
+        m_instanceBuffers[i]=0;
+        m_instanceSize[i]=0;
+        ResourceTracker::instance()->release(ResourceTracker::BUFFER,&m_instanceBuffers[i]);
+      }
+    }
+    ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
+    GLState::instance()->deleteVertexArrays(1,&m_id);
+    m_allocated=false;
+  }
+
+  void InstancedVAO::setData(const VertexData &_data)
+  {
+    if(m_bound == false)
+    {
+      std::cerr<<"trying to set VOA data when unbound\n";
+    }
+    if( m_allocated ==true)
+    {
+        GLState::instance()->deleteBuffers(1,&m_buffer);
+    }
+    glGenBuffers(1, &m_buffer);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>( _data.m_size), &_data.m_data, _data.m_mode);
+    FrameStats::instance()->addBufferUpload(_data.m_size);
+    ResourceTracker::instance()->track(ResourceTracker::BUFFER,this,_data.m_size,"InstancedVAO");
+    m_allocated=true;
+  }
+
+  void InstancedVAO::setInstanceData(unsigned int _stream, size_t _size, const GLvoid *_data, GLenum _usage)
+  {
+    if(_stream >= MAXSTREAMS)
+    {
+      std::cerr<<"InstancedVAO stream "<<_stream<<" out of range\n";
+      return;
+    }
+    if(m_instanceBuffers[_stream] == 0)
+    {
+      glGenBuffers(1, &m_instanceBuffers[_stream]);
+    }
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_instanceBuffers[_stream]);
+    if(_size > m_instanceSize[_stream])
+    {
+      glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_size),_data,_usage);
+      FrameStats::instance()->addBufferUpload(_size);
+      m_instanceSize[_stream]=_size;
+      ResourceTracker::instance()->track(ResourceTracker::BUFFER,&m_instanceBuffers[_stream],_size,"InstancedVAO instances");
+    }
+    else
+    {
+      // orphan the old storage so the update doesn't wait for draws still using it
+      glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(m_instanceSize[_stream]),nullptr,_usage);
+      glBufferSubData(GL_ARRAY_BUFFER,0,static_cast<GLsizeiptr>(_size),_data);
+      FrameStats::instance()->addBufferUpload(_size);
+    }
+  }
+
+  void InstancedVAO::setInstanceAttributePointer(unsigned int _stream, GLuint _id, GLint _size, GLenum _type, GLsizei _stride,
+                                                 unsigned int _dataOffset, GLuint _divisor, bool _normalise)
+  {
+    if(m_bound !=true)
+    {
+      std::cerr<<"Warning trying to set attribute on Unbound VOA\n";
+    }
+    if(_stream >= MAXSTREAMS || m_instanceBuffers[_stream] == 0)
+    {
+      std::cerr<<"InstancedVAO stream "<<_stream<<" has no data\n";
+      return;
+    }
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_instanceBuffers[_stream]);
+    glVertexAttribPointer(_id,_size,_type,_normalise,_stride,static_cast<Real *>(NULL)  + _dataOffset);
+    glEnableVertexAttribArray(_id);
+    glVertexAttribDivisor(_id,_divisor);
+  }
+
+  void InstancedVAO::setInstanceMatrices(const std::vector<Mat4> &_matrices, GLuint _firstAttrib)
+  {
+    static_assert(sizeof(Mat4) == 16*sizeof(Real),"Mat4 must be 16 packed Reals to be used as instance data");
+    setInstanceData(MATRIX,_matrices.size()*sizeof(Mat4),_matrices.data());
+    // a mat4 attribute takes 4 consecutive locations, one per vec4 column
+    for(GLuint i=0; i<4; ++i)
+    {
+      setInstanceAttributePointer(MATRIX,_firstAttrib+i,4,GL_FLOAT,sizeof(Mat4),i*4);
+    }
+    m_numInstances=static_cast<unsigned int>(_matrices.size());
+  }
+
+  void InstancedVAO::setInstanceColours(const std::vector<Vec4> &_colours, GLuint _attrib)
+  {
+    static_assert(sizeof(Vec4) == 4*sizeof(Real),"Vec4 must be 4 packed Reals to be used as instance data");
+    setInstanceData(COLOUR,_colours.size()*sizeof(Vec4),_colours.data());
+    setInstanceAttributePointer(COLOUR,_attrib,4,GL_FLOAT,sizeof(Vec4),0);
+  }
+
+  GLuint InstancedVAO::getBufferID(unsigned int _buffer)
+  {
+    if(_buffer == 0)
+    {
+      return m_buffer;
+    }
+    return _buffer <= MAXSTREAMS ? m_instanceBuffers[_buffer-1] : 0;
+  }
+
+}
@@ -0,0 +1,142 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "LODManager.h"
+#include "Camera.h"
+#include "Util.h"
+#include "ParallelFor.h"
+#include "NGLassert.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file LODManager.cpp
+/// @brief implementation files for LODManager class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+constexpr int LODManager::MAXLODS;
+
+//----------------------------------------------------------------------------------------------------------------------
+LODManager::LODManager(Real _pixelError, Real _hysteresis) noexcept :
+  m_pixelError(_pixelError),m_hysteresis(_hysteresis)
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int LODManager::addLODGroup(const std::vector<Real> &_errors)
+{
+  NGL_ASSERT(!_errors.empty());
+  int id=static_cast<int>(m_groupError.size()/MAXLODS);
+  for(int i=0; i<MAXLODS; ++i)
+  {
+    Real e= i<static_cast<int>(_errors.size()) ? _errors[static_cast<size_t>(i)] : std::numeric_limits<Real>::infinity();
+    // keep the errors increasing so the level search can just count
+    if(i > 0)
+    {
+      e=std::max(e,m_groupError.back());
+    }
+    m_groupError.push_back(e);
+  }
+  m_switchDistance.resize(m_groupError.size());
+  return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t LODManager::addObject(const Vec3 &_center, Real _radius, int _group)
+{
+  NGL_ASSERT(_group >= 0 && static_cast<size_t>(_group) < m_groupError.size()/MAXLODS);
+  m_x.push_back(_center.m_x);
+  m_y.push_back(_center.m_y);
+  m_z.push_back(_center.m_z);
+  m_radius.push_back(_radius);
+  m_group.push_back(_group);
+  m_lod.push_back(0);
+  return m_lod.size()-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODManager::setObjectPosition(size_t _id, const Vec3 &_center) noexcept
+{
+  m_x[_id]=_center.m_x;
+  m_y[_id]=_center.m_y;
+  m_z[_id]=_center.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODManager::clear() noexcept
+{
+  m_groupError.clear();
+  m_switchDistance.clear();
+  m_x.clear();
+  m_y.clear();
+  m_z.clear();
+  m_radius.clear();
+  m_group.clear();
+  m_lod.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODManager::update(const Camera &_cam, int _viewportHeight)
+{
+  // an error e at distance d covers e*k/d pixels, so level i is good enough once d >= e_i*k/pixelError
+  Real k=static_cast<Real>(_viewportHeight)/(2.0f*std::tan(radians(_cam.getFOV())*0.5f));
+  Real scale=k/std::max(m_pixelError,std::numeric_limits<Real>::epsilon());
+  for(size_t i=0; i<m_groupError.size(); ++i)
+  {
+    m_switchDistance[i]=m_groupError[i]*scale;
+  }
+  Vec4 eye=_cam.getEye();
+  Real ex=eye.m_x;
+  Real ey=eye.m_y;
+  Real ez=eye.m_z;
+  Real zNear=_cam.getNear();
+  // only change level once the distance is past the switch point by the hysteresis fraction
+  Real coarseScale=1.0f/(1.0f+m_hysteresis);
+  Real fineScale=1.0f/std::max(1.0f-m_hysteresis,std::numeric_limits<Real>::epsilon());
+  parallelFor(0,m_lod.size(),[=](size_t _b, size_t _e)
+  {
+    const Real *switchDistance=m_switchDistance.data();
+    const Real * __restrict x=m_x.data();
+    const Real * __restrict y=m_y.data();
+    const Real * __restrict z=m_z.data();
+    const Real * __restrict radius=m_radius.data();
+    const int * __restrict group=m_group.data();
+    int * __restrict lod=m_lod.data();
+    for(size_t i=_b; i<_e; ++i)
+    {
+      Real dx=x[i]-ex;
+      Real dy=y[i]-ey;
+      Real dz=z[i]-ez;
+      Real d=std::max(std::sqrt(dx*dx+dy*dy+dz*dz)-radius[i],zNear);
+      Real dCoarse=d*coarseScale;
+      Real dFine=d*fineScale;
+      const Real *sd=switchDistance+group[i]*MAXLODS;
+      // level 0 is always allowed so count how many of the others are
+      int lodCoarse=0;
+      int lodFine=0;
+      for(int l=1; l<MAXLODS; ++l)
+      {
+        lodCoarse+= sd[l] <= dCoarse ? 1 : 0;
+        lodFine+= sd[l] <= dFine ? 1 : 0;
+      }
+      // stay put unless the current level is outside the band the hysteresis allows
+      lod[i]=std::min(std::max(lod[i],lodCoarse),lodFine);
+    }
+  },8192);
+}
+
+} // end ngl namespace
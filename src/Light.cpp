@@ -17,6 +17,7 @@
 
 #include "Light.h"
 #include "ShaderLib.h"
+#include "UniformBuffer.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Light.cpp
@@ -104,40 +105,98 @@ void Light::setAttenuation(Real _constant, Real _linear,  Real _quadratic  ) noe
 
 void Light::loadToShader(std::string _uniformName )const noexcept
 {
+  // only look the uniforms up when the shader or name changes, not every frame
+  const ShaderProgram *program=ShaderLib::instance()->getCurrentProgram();
+  if(program!=m_uniformProgram || _uniformName!=m_uniformName)
+  {
+    m_uniforms=getUniforms(_uniformName);
+    m_uniformProgram=program;
+    m_uniformName=_uniformName;
+  }
+  loadToShader(m_uniforms);
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+Light::Uniforms Light::getUniforms(const std::string &_uniformName) noexcept
+{
   ShaderLib *shader=ShaderLib::instance();
 /*
 /// struct Lights
 /// {
-///   vec3 position;
+///   vec4 position;
 ///   vec4 ambient;
 ///   vec4 diffuse;
 ///   vec4 specular;
 /// };
   */
+  Uniforms uniforms;
+  uniforms.position=shader->getUniformHandle<Vec4>(_uniformName+".position");
+  uniforms.ambient=shader->getUniformHandle<Colour>(_uniformName+".ambient");
+  uniforms.diffuse=shader->getUniformHandle<Colour>(_uniformName+".diffuse");
+  uniforms.specular=shader->getUniformHandle<Colour>(_uniformName+".specular");
+  return uniforms;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Light::loadToShader(const Uniforms &_uniforms)const noexcept
+{
   if(m_active==true)
   {
     Vec4 pos=m_transform*m_position;
-    shader->setShaderParam4f(_uniformName+".position",pos.m_x,pos.m_y,pos.m_z,Real(m_lightMode));
-    shader->setShaderParam4f(_uniformName+".ambient",m_ambient.m_r,m_ambient.m_g,m_ambient.m_b,m_ambient.m_a);
-    shader->setShaderParam4f(_uniformName+".diffuse",m_diffuse.m_r,m_diffuse.m_g,m_diffuse.m_b,m_diffuse.m_a);
-    shader->setShaderParam4f(_uniformName+".specular",m_specular.m_r,m_specular.m_g,m_specular.m_b,m_specular.m_a);
-   // shader->setShaderParam1f(_uniformName+".constantAttenuation",m_constantAtten);
-   // shader->setShaderParam1f(_uniformName+".linearAttenuation",m_linearAtten);
-   // shader->setShaderParam1f(_uniformName+".quadraticAttenuation",m_quadraticAtten);
-   // shader->setShaderParam1f(_uniformName+".spotCosCutoff",m_cutoffAngle);
-
+    pos.m_w=Real(m_lightMode);
+    _uniforms.position.set(pos);
+    _uniforms.ambient.set(m_ambient);
+    _uniforms.diffuse.set(m_diffuse);
+    _uniforms.specular.set(m_specular);
   }
   else
   {
     // turn light off by setting 0 values
-    shader->setShaderParam4f(_uniformName+".position",0,0,0,Real(m_lightMode));
-    shader->setShaderParam4f(_uniformName+".ambient",0,0,0,0);
-    shader->setShaderParam4f(_uniformName+".diffuse",0,0,0,0);
-    shader->setShaderParam4f(_uniformName+".specular",0,0,0,0);
+    static const Colour off(0,0,0,0);
+    _uniforms.position.set(Vec4(0,0,0,Real(m_lightMode)));
+    _uniforms.ambient.set(off);
+    _uniforms.diffuse.set(off);
+    _uniforms.specular.set(off);
   }
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+void Light::writeStd140(Std140Writer &_w) const noexcept
+{
+  writeStd140Light(_w,Vec4(0.0f,0.0f,0.0f,0.0f),m_cutoffAngle,0.0f);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Light::writeStd140Light(Std140Writer &_w, const Vec4 &_dir, Real _innerCutoff, Real _exponent) const noexcept
+{
+  // an inactive light is written with no colour as loadToShader does
+  static const Colour off(0,0,0,0);
+  Vec4 pos=m_active ? m_transform*m_position : Vec4(0,0,0,0);
+  pos.m_w=Real(m_lightMode);
+  _w.beginStruct();
+  _w.write("position",pos);
+  _w.write("ambient",m_active ? m_ambient : off);
+  _w.write("diffuse",m_active ? m_diffuse : off);
+  _w.write("specular",m_active ? m_specular : off);
+  _w.write("direction",m_transform*_dir);
+  _w.write("spotCosCutoff",m_cutoffAngle);
+  _w.write("spotCosInnerCutoff",_innerCutoff);
+  _w.write("spotExponent",_exponent);
+  _w.write("constantAttenuation",m_constantAtten);
+  _w.write("linearAttenuation",m_linearAtten);
+  _w.write("quadraticAttenuation",m_quadraticAtten);
+  _w.endStruct();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t Light::getStd140Size() noexcept
+{
+  // position, ambient, diffuse, specular, direction then the six cutoff and attenuation values as
+  // written by writeStd140Light
+  return std140Size<Vec4,Colour,Colour,Colour,Vec4,Real,Real,Real,Real,Real,Real>();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 void Light::setTransform(Mat4 &_t) noexcept
 {
   m_transform=_t;
@@ -18,6 +18,7 @@
 #include "NGLStream.h"
 #include "Material.h"
 #include "ShaderLib.h"
+#include "UniformBuffer.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Material.cpp
 /// @brief implementation files for Material class
@@ -134,6 +135,26 @@ void Material::loadToShader( std::string _uniformName  )const noexcept
 }
 
 
+//----------------------------------------------------------------------------------------------------------------------
+void Material::writeStd140(Std140Writer &_w) const noexcept
+{
+  _w.beginStruct();
+  _w.write("ambient",m_ambient);
+  _w.write("diffuse",m_diffuse);
+  _w.write("specular",m_specular);
+  _w.write("shininess",m_specularExponent);
+  _w.write("transparency",m_transparency);
+  _w.write("roughness",m_surfaceRoughness);
+  _w.endStruct();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t Material::getStd140Size() noexcept
+{
+  // ambient, diffuse, specular, shininess, transparency and roughness as written by writeStd140
+  return std140Size<Colour,Colour,Colour,Real,Real,Real>();
+}
+
 } // end ngl namespace
 
 
@@ -1,8 +1,13 @@
 #include "MultiBufferVAO.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include <iostream>
 #include <NGLassert.h>
 namespace ngl
 {
+using namespace dispatch;
   MultiBufferVAO::~MultiBufferVAO()
   {
     removeVAO();
@@ -19,6 +24,7 @@ namespace ngl
       std::cerr<<"Warning trying to draw an unbound VOA\n";
     }
     glDrawArrays(m_mode, 0, static_cast<GLsizei>(m_indicesCount));
+    FrameStats::instance()->addDraw(m_mode,m_indicesCount);
   }
 
   void MultiBufferVAO::removeVAO()
@@ -31,9 +37,10 @@ namespace ngl
     {
       for(auto b : m_vboIDs)
       {
-        glDeleteBuffers(1,&b);
+        GLState::instance()->deleteBuffers(1,&b);
       }
-      glDeleteVertexArrays(1,&m_id);
+      GLState::instance()->deleteVertexArrays(1,&m_id);
+      ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
       m_allocated=false;
     }
   }
@@ -48,8 +55,10 @@ namespace ngl
     glGenBuffers(1, &vboID);
     m_vboIDs.push_back(vboID);
     // now we will bind an array buffer to the first one and load the data for the verts
-    glBindBuffer(GL_ARRAY_BUFFER, vboID);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, vboID);
     glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_data.m_size), &_data.m_data, _data.m_mode);
+    FrameStats::instance()->addBufferUpload(_data.m_size);
+    ResourceTracker::instance()->add(ResourceTracker::BUFFER,this,_data.m_size,"MultiBufferVAO");
     m_allocated=true;
 
   }
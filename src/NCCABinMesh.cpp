@@ -17,6 +17,9 @@
 #include <cstring>
 #include <iostream>
 #include "NCCABinMesh.h"
+#include "FrameStats.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include <memory>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NCCABinMesh.cpp
@@ -100,16 +103,19 @@ bool NCCABinMesh::load(const std::string &_fname,bool _calcBB) noexcept
   file.close();
   // and now allocate this as a vbo
   glGenBuffers(1, &m_vboBuffers);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vboBuffers);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_vboBuffers);
 
   // resize buffer
   glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr> (m_indexSize*m_bufferPackSize*sizeof(GLfloat)), vboMem.get(), GL_DYNAMIC_DRAW);
+  FrameStats::instance()->addBufferUpload(m_indexSize*m_bufferPackSize*sizeof(GLfloat));
+  ResourceTracker::instance()->track(ResourceTracker::BUFFER,this,m_indexSize*m_bufferPackSize*sizeof(GLfloat),_fname);
   // create the BBox for the obj
   if(_calcBB)
   {
     m_ext.reset(new BBox(m_minX,m_maxX,m_minY,m_maxY,m_minZ,m_maxZ) );
   }
   m_vbo=true;
+  trackMemory(_fname);
   return true;
 }
 
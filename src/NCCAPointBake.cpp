@@ -16,9 +16,12 @@
 */
 
 #include "NCCAPointBake.h"
-#include "rapidxml/rapidxml.hpp"
-#include <boost/lexical_cast.hpp>
-#include <boost/tokenizer.hpp>
+#include "CPUProfiler.h"
+#include "ParallelFor.h"
+#include "ResourceTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NCCAPointBake.cpp
@@ -27,7 +30,205 @@
 
 namespace ngl
 {
-  typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+
+namespace
+{
+  // the number of Reals per vertex in the AbstractMesh VBO
+  constexpr size_t c_vboStride=8;
+  // the bytes held by the frame data
+  size_t frameBytes(const std::vector<std::vector<Vec3>> &_data) noexcept
+  {
+    size_t bytes=0;
+    for(auto &frame : _data)
+    {
+      bytes+=frame.size()*sizeof(Vec3);
+    }
+    return bytes;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  // small hand written scanners for the point bake xml, they work directly on the file buffer and
+  // are a lot quicker than tokenising each vertex into strings and lexical_casting them
+  //----------------------------------------------------------------------------------------------------------------------
+  // find _tag (which starts with <) in [_p,_end) returns _end if not found
+  const char *findTag(const char *_p, const char *_end, const char *_tag) noexcept
+  {
+    size_t len=std::strlen(_tag);
+    while(_p < _end)
+    {
+      _p=static_cast<const char *>(std::memchr(_p,'<',static_cast<size_t>(_end-_p)));
+      if(_p == nullptr)
+      {
+        return _end;
+      }
+      if(static_cast<size_t>(_end-_p) >= len && std::memcmp(_p,_tag,len) == 0)
+      {
+        return _p;
+      }
+      ++_p;
+    }
+    return _end;
+  }
+
+  inline bool isSpace(char _c) noexcept
+  {
+    return _c == ' ' || _c == '\t' || _c == '\n' || _c == '\r';
+  }
+
+  inline bool isDigit(char _c) noexcept
+  {
+    return _c >= '0' && _c <= '9';
+  }
+
+  // get the trimmed text between <_name> and </_name>
+  bool tagValue(const char *_begin, const char *_end, const std::string &_name, std::string &o_value)
+  {
+    std::string open="<"+_name+">";
+    const char *p=findTag(_begin,_end,open.c_str());
+    if(p == _end)
+    {
+      return false;
+    }
+    p+=open.size();
+    const char *e=findTag(p,_end,("</"+_name).c_str());
+    while(p < e && isSpace(*p))
+    {
+      ++p;
+    }
+    while(e > p && isSpace(*(e-1)))
+    {
+      --e;
+    }
+    o_value.assign(p,e);
+    return true;
+  }
+
+  // find _name=" in the current tag and return a pointer to the value
+  const char *attributeValue(const char *_p, const char *_end, const char *_name) noexcept
+  {
+    size_t len=std::strlen(_name);
+    for(; _p+len+1 < _end && *_p != '>'; ++_p)
+    {
+      if(std::memcmp(_p,_name,len) == 0 && _p[len] == '=')
+      {
+        _p+=len+1;
+        return (*_p == '"' || *_p == '\'') ? _p+1 : _p;
+      }
+    }
+    return nullptr;
+  }
+
+  const char *scanUnsigned(const char *_p, const char *_end, unsigned int &o_value) noexcept
+  {
+    while(_p < _end && isSpace(*_p))
+    {
+      ++_p;
+    }
+    if(_p == _end || !isDigit(*_p))
+    {
+      return nullptr;
+    }
+    unsigned int v=0;
+    while(_p < _end && isDigit(*_p))
+    {
+      v=v*10+static_cast<unsigned int>(*_p-'0');
+      ++_p;
+    }
+    o_value=v;
+    return _p;
+  }
+
+  // decimal float with optional sign, fraction and exponent, anything else (inf / nan) goes to strtod.
+  // The digits are gathered into an integer and scaled once by an exact power of 10 so the result
+  // matches strtof apart from the odd last bit double rounding case.
+  const char *scanReal(const char *_p, const char *_end, Real &o_value) noexcept
+  {
+    static const double powers[]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+                                  1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+    while(_p < _end && isSpace(*_p))
+    {
+      ++_p;
+    }
+    const char *start=_p;
+    bool negative=false;
+    if(_p < _end && (*_p == '-' || *_p == '+'))
+    {
+      negative= *_p == '-';
+      ++_p;
+    }
+    uint64_t mantissa=0;
+    int digits=0;
+    int exponent=0;
+    bool any=false;
+    for(; _p < _end && isDigit(*_p); ++_p)
+    {
+      any=true;
+      if(digits < 19)
+      {
+        mantissa=mantissa*10+static_cast<uint64_t>(*_p-'0');
+        digits+= mantissa != 0 ? 1 : 0;
+      }
+      else
+      {
+        ++exponent;
+      }
+    }
+    if(_p < _end && *_p == '.')
+    {
+      for(++_p; _p < _end && isDigit(*_p); ++_p)
+      {
+        any=true;
+        if(digits < 19)
+        {
+          mantissa=mantissa*10+static_cast<uint64_t>(*_p-'0');
+          digits+= mantissa != 0 ? 1 : 0;
+          --exponent;
+        }
+      }
+    }
+    if(!any)
+    {
+      char *e;
+      double v=std::strtod(start,&e);
+      if(e == start)
+      {
+        return nullptr;
+      }
+      o_value=static_cast<Real>(v);
+      return e;
+    }
+    if(_p < _end && (*_p == 'e' || *_p == 'E'))
+    {
+      const char *e=_p+1;
+      bool negativeExp=false;
+      if(e < _end && (*e == '-' || *e == '+'))
+      {
+        negativeExp= *e == '-';
+        ++e;
+      }
+      if(e < _end && isDigit(*e))
+      {
+        int exp=0;
+        for(; e < _end && isDigit(*e); ++e)
+        {
+          exp=std::min(exp*10+(*e-'0'),1000);
+        }
+        exponent+= negativeExp ? -exp : exp;
+        _p=e;
+      }
+    }
+    double v=static_cast<double>(mantissa);
+    if(exponent < 0)
+    {
+      v= exponent >= -22 ? v/powers[-exponent] : v*std::pow(10.0,exponent);
+    }
+    else if(exponent > 0)
+    {
+      v= exponent <= 22 ? v*powers[exponent] : v*std::pow(10.0,exponent);
+    }
+    o_value=static_cast<Real>(negative ? -v : v);
+    return _p;
+  }
+}
 
 //----------------------------------------------------------------------------------------------------------------------
 NCCAPointBake::NCCAPointBake() noexcept
@@ -39,10 +240,12 @@ NCCAPointBake::NCCAPointBake() noexcept
 	m_endFrame=0;
 	m_mesh=0;
 	m_binFile=false;
+	m_recomputeNormals=false;
 }
 
 bool NCCAPointBake::loadPointBake(const std::string &_fileName) noexcept
 {
+	NGL_PROFILE_SCOPE("NCCAPointBake::loadPointBake");
 	m_numFrames=0;
 	m_currFrame=0;
 	m_nVerts=0;
@@ -50,81 +253,133 @@ bool NCCAPointBake::loadPointBake(const std::string &_fileName) noexcept
 	m_endFrame=0;
 	m_mesh=0;
 	m_binFile=false;
-	rapidxml::xml_node<> * rootNode;
-	// Read the xml file into a vector
-	std::ifstream xmlFile (_fileName.c_str() );
+	// Read the whole xml file into a buffer in one go
+	std::ifstream xmlFile (_fileName.c_str(),std::ios::in | std::ios::binary);
 	if(!xmlFile.is_open())
 	{
 		std::cerr<<"Could not open file\n";
 		return false;
 	}
-	std::vector<char> buffer((std::istreambuf_iterator<char>(xmlFile)), std::istreambuf_iterator<char>());
-	buffer.push_back('\0');
-	rapidxml::xml_document<> doc;
-
-	doc.parse<rapidxml::parse_trim_whitespace>(&buffer[0]);
-	rootNode=doc.first_node();
-	if(rootNode->name() !=std::string("NCCAPointBake"))
+	xmlFile.seekg(0,std::ios::end);
+	size_t fileSize=static_cast<size_t>(xmlFile.tellg());
+	xmlFile.seekg(0,std::ios::beg);
+	std::vector<char> buffer(fileSize+1);
+	xmlFile.read(&buffer[0],static_cast<std::streamsize>(fileSize));
+	buffer[fileSize]='\0';
+	const char *begin=&buffer[0];
+	const char *end=begin+fileSize;
+
+	if(findTag(begin,end,"<NCCAPointBake")==end)
 	{
 		std::cerr<<"this is not a pointbake file \n";
 		return false;
 	}
+	// the header is everything before the first frame
+	const char *headerEnd=findTag(begin,end,"<Frame");
+	std::string value;
+	if(!tagValue(begin,headerEnd,"MeshName",m_meshName) ||
+		 !tagValue(begin,headerEnd,"NumVerts",value) || !scanUnsigned(value.c_str(),value.c_str()+value.size(),m_nVerts) ||
+		 !tagValue(begin,headerEnd,"StartFrame",value) || !scanUnsigned(value.c_str(),value.c_str()+value.size(),m_startFrame) ||
+		 !tagValue(begin,headerEnd,"EndFrame",value) || !scanUnsigned(value.c_str(),value.c_str()+value.size(),m_endFrame) ||
+		 !tagValue(begin,headerEnd,"NumFrames",value) || !scanUnsigned(value.c_str(),value.c_str()+value.size(),m_numFrames))
+	{
+		std::cerr<<"error reading pointbake header in "<<_fileName<<"\n";
+		return false;
+	}
+	std::cerr<<"found mesh "<<m_meshName<<" NumVerts "<<m_nVerts<<" StartFrame "<<m_startFrame
+					 <<" EndFrame "<<m_endFrame<<" NumFrames "<<m_numFrames<<"\n";
+
+	// find the start of every frame, each thread searches its own part of the file
+	size_t numChunks=std::min<size_t>(numWorkerThreads(),std::max<size_t>(1,fileSize/(1<<20)));
+	std::vector<std::vector<const char *>> chunkFrames(numChunks);
+	size_t searchSize=static_cast<size_t>(end-headerEnd);
+	parallelForChunks(0,searchSize,numChunks,[headerEnd,end,&chunkFrames](size_t _c, size_t _b, size_t _e)
+	{
+		// a tag may run past the end of the chunk but must start inside it
+		const char *p=headerEnd+_b;
+		const char *chunkEnd=headerEnd+_e;
+		while((p=findTag(p,end,"<Frame")) < chunkEnd)
+		{
+			chunkFrames[_c].push_back(p);
+			++p;
+		}
+	});
+	std::vector<const char *> frameStart;
+	for(auto &c : chunkFrames)
+	{
+		frameStart.insert(frameStart.end(),c.begin(),c.end());
+	}
+	frameStart.push_back(end);
+
+	// every frame must be in the file exactly once, a missing frame would be left empty and a repeated
+	// one written by two threads
+	std::vector<unsigned int> frameIndex(frameStart.size()-1);
+	std::vector<char> seen(m_numFrames,0);
+	bool framesOK= frameIndex.size() == m_numFrames;
+	for(size_t f=0; framesOK && f<frameIndex.size(); ++f)
+	{
+		unsigned int frame;
+		const char *p=attributeValue(frameStart[f],frameStart[f+1],"number");
+		framesOK= p != nullptr && scanUnsigned(p,frameStart[f+1],frame) && frame >= m_startFrame &&
+							frame-m_startFrame < m_numFrames && !seen[frame-m_startFrame];
+		if(framesOK)
+		{
+			frameIndex[f]=frame-m_startFrame;
+			seen[frameIndex[f]]=1;
+		}
+	}
+	if(!framesOK)
+	{
+		std::cerr<<"missing or repeated frames in "<<_fileName<<"\n";
+		return false;
+	}
 
-  rapidxml::xml_node<> * child=rootNode->first_node("MeshName");
-  m_meshName=child->value();
-  std::cerr<<"found mesh "<<m_meshName<<"\n";
-
-
-  child=rootNode->first_node("NumVerts");
-  m_nVerts=boost::lexical_cast<unsigned int>(child->value());
-  std::cerr<<"NumVerts "<<m_nVerts<<"\n";
-  child=rootNode->first_node("StartFrame");
-  m_startFrame=boost::lexical_cast<unsigned int>(child->value());
-  std::cerr<<"StartFrame"<<m_startFrame<<"\n";
-  child=rootNode->first_node("EndFrame");
-  m_endFrame=boost::lexical_cast<unsigned int>(child->value());
-  std::cerr<<"EndFrame"<<m_endFrame<<"\n";
-  child=rootNode->first_node("NumFrames");
-  m_numFrames=boost::lexical_cast< unsigned int>(child->value());
-  std::cerr<<"EndFrame  "<<m_numFrames<<"\n";
-  //first allocate base pointer [vertex]
-  m_data.resize(m_numFrames);
-  //cout <<"Size is now"<<m_data.size()<<endl;
-  //now for each of these we need to allocate more space
-  // NOTE the use of a reference here as we are changing the size
-  for(auto &data : m_data)
-  {
-    data.resize(m_nVerts);
-  }
-  unsigned int CurrentFrame=0;
-  // this is the line we wish to parse
-  std::string lineBuffer;
-  // say which separators should be used in this
-  // case Spaces, Tabs and return \ new line
-  boost::char_separator<char> sep(" \t\r\n");
-  // now traverse each frame and grab the data
-  for(child=rootNode->first_node("Frame"); child; child=child->next_sibling())
-  {
-    std::cerr<<"doing frame "<<child->first_attribute("number")->value()<<"\n";
-    CurrentFrame=boost::lexical_cast<unsigned int>(child->first_attribute("number")->value());
-    CurrentFrame-=m_startFrame;
-    std::flush(std::cerr);
-
-    for(rapidxml::xml_node<> * vertex=child->first_node("Vertex"); vertex; vertex=vertex->next_sibling())
-    {
-      unsigned int index=boost::lexical_cast<unsigned int>(vertex->first_attribute("number")->value());
-      lineBuffer=vertex->value();
-      tokenizer tokens(lineBuffer, sep);
-      tokenizer::iterator  firstWord = tokens.begin();
-      Real x=boost::lexical_cast<Real>(*firstWord++);
-      Real y=boost::lexical_cast<Real>(*firstWord++);
-      Real z=boost::lexical_cast<Real>(*firstWord++);
-      m_data[CurrentFrame][index].set(x,y,z);
-
-    }
+	m_data.resize(m_numFrames);
+	std::vector<char> frameOK(frameIndex.size(),1);
+	// parse the frames in parallel, each frame only writes its own vector so no locking is needed
+	parallelFor(0,frameIndex.size(),[this,&frameStart,&frameIndex,&frameOK](size_t _b, size_t _e)
+	{
+		for(size_t f=_b; f<_e; ++f)
+		{
+			frameOK[f]=parseFrame(frameStart[f],frameStart[f+1],frameIndex[f]) ? 1 : 0;
+		}
+	},1);
+	if(std::find(frameOK.begin(),frameOK.end(),0) != frameOK.end())
+	{
+		std::cerr<<"error parsing frame data in "<<_fileName<<"\n";
+		return false;
+	}
+	ResourceTracker::instance()->track(ResourceTracker::POINTBAKE,this,frameBytes(m_data),_fileName);
+	return true;
+}
 
-  }
-  return true;
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCAPointBake::parseFrame(const char *_begin, const char *_end, unsigned int _frame) noexcept
+{
+	NGL_PROFILE_SCOPE("NCCAPointBake::parseFrame");
+	const char *p=_begin;
+	std::vector<Vec3> &data=m_data[_frame];
+	data.resize(m_nVerts);
+	while((p=findTag(p,_end,"<Vertex")) != _end)
+	{
+		unsigned int index;
+		Real x,y,z;
+		p=attributeValue(p,_end,"number");
+		if(p == nullptr || (p=scanUnsigned(p,_end,index)) == nullptr || index >= m_nVerts)
+		{
+			return false;
+		}
+		p=static_cast<const char *>(std::memchr(p,'>',static_cast<size_t>(_end-p)));
+		if(p == nullptr ||
+			 (p=scanReal(p+1,_end,x)) == nullptr ||
+			 (p=scanReal(p,_end,y)) == nullptr ||
+			 (p=scanReal(p,_end,z)) == nullptr)
+		{
+			return false;
+		}
+		data[index].set(x,y,z);
+	}
+	return true;
 }
 
 
@@ -133,7 +388,7 @@ bool NCCAPointBake::loadPointBake(const std::string &_fileName) noexcept
 //----------------------------------------------------------------------------------------------------------------------
 NCCAPointBake::~NCCAPointBake() noexcept
 {
-
+  ResourceTracker::instance()->release(ResourceTracker::POINTBAKE,this);
 }
 //----------------------------------------------------------------------------------------------------------------------
 NCCAPointBake::NCCAPointBake( const std::string &_fileName) noexcept
@@ -148,6 +403,7 @@ void NCCAPointBake::setFrame( const unsigned int _frame) noexcept
 
 bool NCCAPointBake::loadBinaryPointBake( const std::string &_fileName) noexcept
 {
+  NGL_PROFILE_SCOPE("NCCAPointBake::loadBinaryPointBake");
   // open a file stream for ip in binary mode
   std::fstream file;
   file.open(_fileName.c_str(),std::ios::in | std::ios::binary);
@@ -186,18 +442,19 @@ bool NCCAPointBake::loadBinaryPointBake( const std::string &_fileName) noexcept
   std::cout<<m_startFrame<<"\n";
   std::cout<<m_binFile<<"\n";
 
+  static_assert(sizeof(Vec3) == 3*sizeof(Real),"Vec3 must be packed x,y,z to be read as a block");
   m_data.resize(m_numFrames);
-  for(unsigned int frame =0; frame<m_numFrames; ++frame)
+  // the frame is stored as packed x,y,z so read it in one go
+  for(auto &frame : m_data)
   {
-    m_data[frame].resize(m_nVerts);
-    for(unsigned int v=0; v< m_nVerts; ++v)
+    frame.resize(m_nVerts);
+    if(m_nVerts !=0)
     {
-     file.read( reinterpret_cast <char *>(&m_data[frame][v].m_x),sizeof(Real));
-     file.read( reinterpret_cast <char *>(&m_data[frame][v].m_y),sizeof(Real));
-     file.read( reinterpret_cast <char *>(&m_data[frame][v].m_z),sizeof(Real));
-   }
+      file.read(reinterpret_cast <char *>(&frame[0]),static_cast<std::streamsize>(m_nVerts*sizeof(Vec3)));
+    }
   }
-  return true;
+  ResourceTracker::instance()->track(ResourceTracker::POINTBAKE,this,frameBytes(m_data),_fileName);
+  return file.good();
 }
 
 bool NCCAPointBake::saveBinaryPointBake( const std::string &_fileName) noexcept
@@ -229,71 +486,184 @@ bool NCCAPointBake::saveBinaryPointBake( const std::string &_fileName) noexcept
     std::cout<<m_binFile<<"\n";
 
     // now write out data
-    for(unsigned int frame =0; frame<m_numFrames; ++frame)
+    for(auto &frame : m_data)
     {
-      for(unsigned int v=0; v< m_nVerts; ++v)
+      if(m_nVerts !=0)
       {
-       file.write( reinterpret_cast <char *>(&m_data[frame][v].m_x),sizeof(Real));
-       file.write( reinterpret_cast <char *>(&m_data[frame][v].m_y),sizeof(Real));
-       file.write( reinterpret_cast <char *>(&m_data[frame][v].m_z),sizeof(Real));
-     }
+        file.write(reinterpret_cast <char *>(&frame[0]),static_cast<std::streamsize>(m_nVerts*sizeof(Vec3)));
+      }
     }
 
     file.close();
     return true;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
 void NCCAPointBake::setMeshToFrame(  const unsigned int _frame) noexcept
 {
-    // map the m_obj's vbo dat
-    Real *ptr=m_mesh->mapVAOVerts();
-    std::vector <Face> faces=m_mesh->getFaceList();
-    //unsigned int nFaces=faces.size();
-    // loop for each of the faces
-    unsigned int step=0;
-    for(auto face : faces)
-    {
-      // now for each triangle in the face (remember we ensured tri when loading)
-      // loop for all the verts and set the new vert value
-      // the data is packed uv, nx,ny,nz then x,y,z
-      // as we only want to change x,y,z, we need to skip over
-      // stuff
+  updateMesh(_frame,_frame,0.0f);
+}
 
-      for(unsigned int j=0;j<3;++j)
+//----------------------------------------------------------------------------------------------------------------------
+void NCCAPointBake::setMeshToSubFrame( Real _frame) noexcept
+{
+  if(m_data.empty())
+  {
+    return;
+  }
+  unsigned int last=static_cast<unsigned int>(m_data.size()-1);
+  Real f=std::min(std::max(_frame,0.0f),static_cast<Real>(last));
+  unsigned int a=static_cast<unsigned int>(f);
+  updateMesh(a,std::min(a+1,last),f-static_cast<Real>(a));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void NCCAPointBake::updateMesh(unsigned int _a, unsigned int _b, Real _t) noexcept
+{
+  NGL_PROFILE_SCOPE("NCCAPointBake::updateMesh");
+  NGL_ASSERT(m_mesh != nullptr && _a < m_data.size() && _b < m_data.size());
+  const Vec3 *pos=&m_data[_a][0];
+  // only lerp when we are between frames, whole frames are gathered straight from the cache
+  if(_t != 0.0f && _a != _b)
+  {
+    m_framePos.resize(m_nVerts);
+    const Vec3 * __restrict a=&m_data[_a][0];
+    const Vec3 * __restrict b=&m_data[_b][0];
+    Vec3 * __restrict out=&m_framePos[0];
+    parallelFor(0,m_nVerts,[=](size_t _begin, size_t _end)
+    {
+      for(size_t i=_begin; i<_end; ++i)
       {
-        ptr[step+5]=m_data[_frame][face.m_vert[j]].m_x;
-        ptr[step+6]=m_data[_frame][face.m_vert[j]].m_y;
-        ptr[step+7]=m_data[_frame][face.m_vert[j]].m_z;
-        step+=8;
+        out[i].m_x=a[i].m_x+(b[i].m_x-a[i].m_x)*_t;
+        out[i].m_y=a[i].m_y+(b[i].m_y-a[i].m_y)*_t;
+        out[i].m_z=a[i].m_z+(b[i].m_z-a[i].m_z)*_t;
       }
-
-    }
-
-    // unmap the vbo as we have finished updating
-    m_mesh->unMapVAO();
-    m_currFrame=_frame;
- }
-
-
-
+    },16384);
+    pos=&m_framePos[0];
+  }
+  const Real *normal=m_cornerNormal.data();
+  const uint32_t *cornerVert=m_cornerVert.data();
+  if(m_recomputeNormals)
+  {
+    // area weighted face normals then gather the faces around each vertex, both passes
+    // only write their own element so they split across threads without locking
+    size_t nFaces=m_cornerVert.size()/3;
+    m_faceNormal.resize(nFaces);
+    m_vertNormal.resize(m_nVerts);
+    Vec3 *faceNormal=&m_faceNormal[0];
+    parallelFor(0,nFaces,[=](size_t _begin, size_t _end)
+    {
+      for(size_t f=_begin; f<_end; ++f)
+      {
+        const Vec3 &p0=pos[cornerVert[f*3]];
+        faceNormal[f]=(pos[cornerVert[f*3+1]]-p0).cross(pos[cornerVert[f*3+2]]-p0);
+      }
+    },8192);
+    const uint32_t *start=m_vertFaceStart.data();
+    const uint32_t *faces=m_vertFaces.data();
+    Vec3 *vertNormal=&m_vertNormal[0];
+    parallelFor(0,m_nVerts,[=](size_t _begin, size_t _end)
+    {
+      for(size_t v=_begin; v<_end; ++v)
+      {
+        Vec3 n(0.0f,0.0f,0.0f);
+        for(uint32_t i=start[v]; i<start[v+1]; ++i)
+        {
+          n+=faceNormal[faces[i]];
+        }
+        Real len=n.length();
+        vertNormal[v]= len > 0.0f ? n/len : n;
+      }
+    },8192);
+  }
+  // the VBO is packed u,v,nx,ny,nz,x,y,z (see AbstractMesh::createVAO) and every corner is rewritten
+  // so it can be mapped write only and filled sequentially
+  Real *ptr=m_mesh->mapVAOVertsWrite();
+  if(ptr != nullptr)
+  {
+    const Real *uv=m_cornerUV.data();
+    const Vec3 *vertNormal=m_recomputeNormals ? &m_vertNormal[0] : nullptr;
+    parallelFor(0,m_cornerVert.size(),[=](size_t _begin, size_t _end)
+    {
+      for(size_t c=_begin; c<_end; ++c)
+      {
+        Real * __restrict out=ptr+c*c_vboStride;
+        uint32_t v=cornerVert[c];
+        out[0]=uv[c*2];
+        out[1]=uv[c*2+1];
+        if(vertNormal != nullptr)
+        {
+          out[2]=vertNormal[v].m_x;
+          out[3]=vertNormal[v].m_y;
+          out[4]=vertNormal[v].m_z;
+        }
+        else
+        {
+          out[2]=normal[c*3];
+          out[3]=normal[c*3+1];
+          out[4]=normal[c*3+2];
+        }
+        out[5]=pos[v].m_x;
+        out[6]=pos[v].m_y;
+        out[7]=pos[v].m_z;
+      }
+    },16384);
+  }
+  // unmap the vbo as we have finished updating
+  m_mesh->unMapVAO();
+  m_currFrame=_a;
+}
 
 //----------------------------------------------------------------------------------------------------------------------
 bool NCCAPointBake::attachMesh(AbstractMesh *_mesh) noexcept
 {
-  std::cout<<"doing attach mesh\n";
   if(_mesh->m_nVerts != m_nVerts)
   {
     std::cerr <<" Mesh can't be attached to this data as vert count does not match\n";
     std::cerr<<"mesh verts "<<_mesh->m_nVerts<<" file verts "<<m_nVerts<<"\n";
     return false;
   }
-
-  else
+  m_mesh=_mesh;
+  // build the corner tables in the same order AbstractMesh::createVAO packs the VBO
+  size_t nCorners=static_cast<size_t>(_mesh->m_nFaces)*3;
+  m_cornerVert.resize(nCorners);
+  m_cornerUV.assign(nCorners*2,0.0f);
+  m_cornerNormal.assign(nCorners*3,0.0f);
+  m_vertFaceStart.assign(m_nVerts+1,0);
+  for(size_t f=0; f<_mesh->m_nFaces; ++f)
   {
-    m_mesh=_mesh;
-    return true;
+    const Face &face=_mesh->m_face[f];
+    for(size_t j=0; j<3; ++j)
+    {
+      size_t c=f*3+j;
+      m_cornerVert[c]=face.m_vert[j];
+      ++m_vertFaceStart[face.m_vert[j]+1];
+      if(_mesh->m_nTex > 0)
+      {
+        m_cornerUV[c*2]=_mesh->m_tex[face.m_tex[j]].m_x;
+        m_cornerUV[c*2+1]=_mesh->m_tex[face.m_tex[j]].m_y;
+      }
+      if(_mesh->m_nNorm > 0)
+      {
+        const Vec3 &n=_mesh->m_norm[face.m_norm[j]];
+        m_cornerNormal[c*3]=n.m_x;
+        m_cornerNormal[c*3+1]=n.m_y;
+        m_cornerNormal[c*3+2]=n.m_z;
+      }
+    }
   }
-
+  // prefix sum the face counts then fill the vertex to face lists
+  for(size_t v=0; v<m_nVerts; ++v)
+  {
+    m_vertFaceStart[v+1]+=m_vertFaceStart[v];
+  }
+  m_vertFaces.resize(nCorners);
+  std::vector<uint32_t> fill(m_vertFaceStart.begin(),m_vertFaceStart.end()-1);
+  for(size_t c=0; c<nCorners; ++c)
+  {
+    m_vertFaces[fill[m_cornerVert[c]]++]=static_cast<uint32_t>(c/3);
+  }
+  return true;
 }
 
 
@@ -15,12 +15,15 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "NGLInit.h"
+#include "GLDispatch.h"
 #include "ShaderLib.h"
 #include "VAOPrimitives.h"
 #include "VAOFactory.h"
 #include "SimpleVAO.h"
 #include "MultiBufferVAO.h"
 #include "SimpleIndexVAO.h"
+#include "StreamingVAO.h"
+#include "InstancedVAO.h"
 
 #if defined(LINUX) || defined(WIN32)
   #include <cstdlib>
@@ -33,6 +36,7 @@
 
 namespace ngl
 {
+using namespace dispatch;
 //----------------------------------------------------------------------------------------------------------------------
 
 
@@ -68,6 +72,8 @@ NGLInit::NGLInit()
   VAOFactory::registerVAOCreator(simpleVAO,SimpleVAO::create);
   VAOFactory::registerVAOCreator(multiBufferVAO,MultiBufferVAO::create);
   VAOFactory::registerVAOCreator(simpleIndexVAO,SimpleIndexVAO::create);
+  VAOFactory::registerVAOCreator(streamingVAO,StreamingVAO::create);
+  VAOFactory::registerVAOCreator(instancedVAO,InstancedVAO::create);
 #endif
 }
 
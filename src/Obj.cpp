@@ -19,6 +19,7 @@
 #include "boost/spirit.hpp"
 /// @todo re-write this at some stage to use boost::spirit::qi
 #include "Obj.h"
+#include "CPUProfiler.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Obj.cpp
 /// @brief implementation files for Obj class
@@ -176,6 +177,7 @@ void Obj::parseFace(const char * _begin   )  noexcept
 //----------------------------------------------------------------------------------------------------------------------
 bool Obj::load(const std::string &_fname,bool _calcBB )  noexcept
 {
+  NGL_PROFILE_SCOPE("Obj::load");
  // here we build up our ebnf rules for parsing
   // so first we have a comment
   srule comment = spt::comment_p("#");
@@ -204,10 +206,13 @@ bool Obj::load(const std::string &_fname,bool _calcBB )  noexcept
 
   }
   std::string str;
-  // loop grabbing a line and then pass it to our parsing framework
-  while(std::getline(in, str))
   {
-    spt::parse(str.c_str(), vertex_type  | face | comment, spt::space_p);
+    NGL_PROFILE_SCOPE("Obj::load parse");
+    // loop grabbing a line and then pass it to our parsing framework
+    while(std::getline(in, str))
+    {
+      spt::parse(str.c_str(), vertex_type  | face | comment, spt::space_p);
+    }
   }
   // now we are done close the file
   in.close();
@@ -222,8 +227,10 @@ bool Obj::load(const std::string &_fname,bool _calcBB )  noexcept
   // Calculate the center of the object.
   if(_calcBB == true)
   {
+    NGL_PROFILE_SCOPE("Obj::load calcDimensions");
     this->calcDimensions();
   }
+  trackMemory(_fname);
   return true;
 
 }
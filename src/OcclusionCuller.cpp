@@ -0,0 +1,449 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "OcclusionCuller.h"
+#include "AbstractMesh.h"
+#include "BBox.h"
+#include "ParallelFor.h"
+#include "NGLassert.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OcclusionCuller.cpp
+/// @brief implementation files for OcclusionCuller class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+constexpr int OcclusionCuller::TILESIZE;
+// pixels in a tile
+constexpr int c_tilePixels=OcclusionCuller::TILESIZE*OcclusionCuller::TILESIZE;
+// depth of the cleared buffer (the far plane)
+constexpr Real c_farDepth=1.0f;
+
+//----------------------------------------------------------------------------------------------------------------------
+OcclusionCuller::OcclusionCuller(int _width, int _height)
+{
+  resize(_width,_height);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::resize(int _width, int _height)
+{
+  NGL_ASSERT(_width > 0 && _height > 0);
+  m_tilesX=(_width+TILESIZE-1)/TILESIZE;
+  m_tilesY=(_height+TILESIZE-1)/TILESIZE;
+  m_width=m_tilesX*TILESIZE;
+  m_height=m_tilesY*TILESIZE;
+  m_depth.resize(static_cast<size_t>(m_width*m_height));
+  m_tileMax.resize(static_cast<size_t>(m_tilesX*m_tilesY));
+  clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::clear() noexcept
+{
+  std::fill(m_depth.begin(),m_depth.end(),c_farDepth);
+  std::fill(m_tileMax.begin(),m_tileMax.end(),c_farDepth);
+  m_triangles.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::addOccluder(const Vec3 *_verts, const uint32_t *_indices, size_t _numIndices, const Mat4 &_tx)
+{
+  Mat4 mvp=_tx*m_viewProject;
+  for(size_t i=0; i+2<_numIndices; i+=3)
+  {
+    const Vec3 &a=_verts[_indices[i]];
+    const Vec3 &b=_verts[_indices[i+1]];
+    const Vec3 &c=_verts[_indices[i+2]];
+    addClipTriangle(Vec4(a.m_x,a.m_y,a.m_z,1.0f)*mvp,
+                    Vec4(b.m_x,b.m_y,b.m_z,1.0f)*mvp,
+                    Vec4(c.m_x,c.m_y,c.m_z,1.0f)*mvp);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::addOccluder(const AbstractMesh &_mesh, const Mat4 &_tx)
+{
+  Mat4 mvp=_tx*m_viewProject;
+  // transform each vertex once as they are shared by many faces
+  std::vector<Vec4> clip(_mesh.m_verts.size());
+  for(size_t i=0; i<clip.size(); ++i)
+  {
+    const Vec3 &v=_mesh.m_verts[i];
+    clip[i]=Vec4(v.m_x,v.m_y,v.m_z,1.0f)*mvp;
+  }
+  for(auto &f : _mesh.m_face)
+  {
+    for(size_t i=1; i+1<f.m_vert.size(); ++i)
+    {
+      addClipTriangle(clip[f.m_vert[0]],clip[f.m_vert[i]],clip[f.m_vert[i+1]]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::addClipTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c)
+{
+  // distance to the near plane z=-w, inside is positive
+  const Vec4 *in[3]={&_a,&_b,&_c};
+  Real d[3];
+  int numInside=0;
+  for(int i=0; i<3; ++i)
+  {
+    d[i]=in[i]->m_z+in[i]->m_w;
+    numInside+= d[i] >= 0.0f ? 1 : 0;
+  }
+  if(numInside == 3)
+  {
+    setupTriangle(_a,_b,_c);
+    return;
+  }
+  if(numInside == 0)
+  {
+    return;
+  }
+  // Sutherland Hodgman against the one plane gives 3 or 4 vertices
+  Vec4 poly[4];
+  int n=0;
+  for(int i=0; i<3; ++i)
+  {
+    int j=(i+1)%3;
+    if(d[i] >= 0.0f)
+    {
+      poly[n++]=*in[i];
+    }
+    if((d[i] >= 0.0f) != (d[j] >= 0.0f))
+    {
+      // Vec4 arithmetic leaves w alone so lerp each component by hand
+      Real t=d[i]/(d[i]-d[j]);
+      const Vec4 &a=*in[i];
+      const Vec4 &b=*in[j];
+      poly[n++].set(a.m_x+(b.m_x-a.m_x)*t,a.m_y+(b.m_y-a.m_y)*t,a.m_z+(b.m_z-a.m_z)*t,a.m_w+(b.m_w-a.m_w)*t);
+    }
+  }
+  for(int i=1; i+1<n; ++i)
+  {
+    setupTriangle(poly[0],poly[i],poly[i+1]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::setupTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c)
+{
+  const Vec4 *v[3]={&_a,&_b,&_c};
+  Real x[3],y[3],z[3];
+  for(int i=0; i<3; ++i)
+  {
+    Real w=v[i]->m_w;
+    if(w <= std::numeric_limits<Real>::epsilon())
+    {
+      return;
+    }
+    Real invW=1.0f/w;
+    x[i]=(v[i]->m_x*invW*0.5f+0.5f)*m_width;
+    y[i]=(v[i]->m_y*invW*0.5f+0.5f)*m_height;
+    z[i]=v[i]->m_z*invW;
+  }
+  Real area=(x[1]-x[0])*(y[2]-y[0])-(x[2]-x[0])*(y[1]-y[0]);
+  if(std::abs(area) < 1e-6f)
+  {
+    return;
+  }
+  // occluders are drawn double sided, flip clockwise triangles so the edge tests are always >= 0 inside
+  if(area < 0.0f)
+  {
+    std::swap(x[1],x[2]);
+    std::swap(y[1],y[2]);
+    std::swap(z[1],z[2]);
+    area=-area;
+  }
+  Triangle t;
+  t.zMin=std::min(z[0],std::min(z[1],z[2]));
+  if(t.zMin > c_farDepth)
+  {
+    return;
+  }
+  // pixel centres are at +0.5 so only pixels whose centre is inside the bounds are touched
+  Real minX=std::min(x[0],std::min(x[1],x[2]));
+  Real maxX=std::max(x[0],std::max(x[1],x[2]));
+  Real minY=std::min(y[0],std::min(y[1],y[2]));
+  Real maxY=std::max(y[0],std::max(y[1],y[2]));
+  t.minX=std::max(0,static_cast<int>(std::ceil(std::max(minX-0.5f,-1.0f))));
+  t.maxX=std::min(m_width-1,static_cast<int>(std::floor(std::min(maxX-0.5f,static_cast<Real>(m_width)))));
+  t.minY=std::max(0,static_cast<int>(std::ceil(std::max(minY-0.5f,-1.0f))));
+  t.maxY=std::min(m_height-1,static_cast<int>(std::floor(std::min(maxY-0.5f,static_cast<Real>(m_height)))));
+  if(t.minX > t.maxX || t.minY > t.maxY)
+  {
+    return;
+  }
+  for(int i=0; i<3; ++i)
+  {
+    int j=(i+1)%3;
+    t.ea[i]=y[i]-y[j];
+    t.eb[i]=x[j]-x[i];
+    t.ec[i]=-(t.ea[i]*x[i]+t.eb[i]*y[i]);
+  }
+  Real invArea=1.0f/area;
+  t.za=((z[1]-z[0])*(y[2]-y[0])-(z[2]-z[0])*(y[1]-y[0]))*invArea;
+  t.zb=((z[2]-z[0])*(x[1]-x[0])-(z[1]-z[0])*(x[2]-x[0]))*invArea;
+  t.zc=z[0]-t.za*x[0]-t.zb*y[0];
+  m_triangles.push_back(t);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::rasterise()
+{
+  // each thread owns a band of tile rows so no two threads write the same pixels
+  size_t numChunks=std::min<size_t>(numWorkerThreads(),static_cast<size_t>(m_tilesY));
+  if(m_triangles.size() < 64)
+  {
+    numChunks=1;
+  }
+  parallelForChunks(0,static_cast<size_t>(m_tilesY),numChunks,[this](size_t ,size_t _b, size_t _e)
+  {
+    rasteriseBand(static_cast<int>(_b),static_cast<int>(_e));
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::rasteriseBand(int _tileY0, int _tileY1) noexcept
+{
+  int bandMinY=_tileY0*TILESIZE;
+  int bandMaxY=_tileY1*TILESIZE-1;
+  for(auto &t : m_triangles)
+  {
+    if(t.maxY < bandMinY || t.minY > bandMaxY)
+    {
+      continue;
+    }
+    int tx0=t.minX/TILESIZE;
+    int tx1=t.maxX/TILESIZE;
+    int ty0=std::max(t.minY/TILESIZE,_tileY0);
+    int ty1=std::min(t.maxY/TILESIZE,_tileY1-1);
+    for(int ty=ty0; ty<=ty1; ++ty)
+    {
+      for(int tx=tx0; tx<=tx1; ++tx)
+      {
+        int tile=ty*m_tilesX+tx;
+        // nothing in the tile is farther than the nearest point of the triangle
+        if(t.zMin >= m_tileMax[tile])
+        {
+          continue;
+        }
+        Real px=tx*TILESIZE+0.5f;
+        Real py=ty*TILESIZE+0.5f;
+        Real ex[3];
+        bool outside=false;
+        for(int e=0; e<3; ++e)
+        {
+          // the edge function is linear so its max over the tile is at one of the corners
+          ex[e]=t.ea[e]*px+t.eb[e]*py+t.ec[e];
+          Real maxE=ex[e]+std::max(0.0f,t.ea[e]*(TILESIZE-1))+std::max(0.0f,t.eb[e]*(TILESIZE-1));
+          outside|= maxE < 0.0f;
+        }
+        if(outside)
+        {
+          continue;
+        }
+        Real *depth=&m_depth[static_cast<size_t>(tile*c_tilePixels)];
+        Real zRow=t.za*px+t.zb*py+t.zc;
+        for(int ly=0; ly<TILESIZE; ++ly)
+        {
+          Real e0=ex[0]+t.eb[0]*ly;
+          Real e1=ex[1]+t.eb[1]*ly;
+          Real e2=ex[2]+t.eb[2]*ly;
+          Real z=zRow+t.zb*ly;
+          Real *row=depth+ly*TILESIZE;
+          // fixed width and branch free so this becomes a couple of SIMD ops per row
+          for(int lx=0; lx<TILESIZE; ++lx)
+          {
+            Real w0=e0+t.ea[0]*lx;
+            Real w1=e1+t.ea[1]*lx;
+            Real w2=e2+t.ea[2]*lx;
+            Real d=z+t.za*lx;
+            bool inside=(w0 >= 0.0f) & (w1 >= 0.0f) & (w2 >= 0.0f) & (d < row[lx]);
+            row[lx]= inside ? d : row[lx];
+          }
+        }
+        Real tileMax=depth[0];
+        for(int i=1; i<c_tilePixels; ++i)
+        {
+          tileMax=std::max(tileMax,depth[i]);
+        }
+        m_tileMax[tile]=tileMax;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionCuller::testCorners(const Vec4 *_corners) const noexcept
+{
+  Real minX=std::numeric_limits<Real>::max();
+  Real minY=minX;
+  Real zMin=minX;
+  Real maxX=-minX;
+  Real maxY=-minX;
+  int numBehind=0;
+  for(int i=0; i<8; ++i)
+  {
+    numBehind+= _corners[i].m_z < -_corners[i].m_w ? 1 : 0;
+  }
+  if(numBehind == 8)
+  {
+    return false;
+  }
+  // crossing the near plane, we can't say anything useful so treat as visible
+  if(numBehind != 0)
+  {
+    return true;
+  }
+  for(int i=0; i<8; ++i)
+  {
+    const Vec4 &c=_corners[i];
+    if(c.m_w <= std::numeric_limits<Real>::epsilon())
+    {
+      return true;
+    }
+    Real invW=1.0f/c.m_w;
+    Real x=c.m_x*invW;
+    Real y=c.m_y*invW;
+    minX=std::min(minX,x);
+    maxX=std::max(maxX,x);
+    minY=std::min(minY,y);
+    maxY=std::max(maxY,y);
+    zMin=std::min(zMin,c.m_z*invW);
+  }
+  if(maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f || zMin > c_farDepth)
+  {
+    return false;
+  }
+  // every pixel the screen rectangle touches
+  int x0=std::max(0,static_cast<int>(std::floor((minX*0.5f+0.5f)*m_width)));
+  int x1=std::min(m_width-1,static_cast<int>(std::floor((maxX*0.5f+0.5f)*m_width)));
+  int y0=std::max(0,static_cast<int>(std::floor((minY*0.5f+0.5f)*m_height)));
+  int y1=std::min(m_height-1,static_cast<int>(std::floor((maxY*0.5f+0.5f)*m_height)));
+  for(int ty=y0/TILESIZE; ty<=y1/TILESIZE; ++ty)
+  {
+    for(int tx=x0/TILESIZE; tx<=x1/TILESIZE; ++tx)
+    {
+      int tile=ty*m_tilesX+tx;
+      if(zMin > m_tileMax[tile])
+      {
+        continue;
+      }
+      int px0=std::max(x0,tx*TILESIZE)-tx*TILESIZE;
+      int px1=std::min(x1,tx*TILESIZE+TILESIZE-1)-tx*TILESIZE;
+      int py0=std::max(y0,ty*TILESIZE)-ty*TILESIZE;
+      int py1=std::min(y1,ty*TILESIZE+TILESIZE-1)-ty*TILESIZE;
+      // if the box covers the whole tile the farthest pixel is under it
+      if(px0 == 0 && py0 == 0 && px1 == TILESIZE-1 && py1 == TILESIZE-1)
+      {
+        return true;
+      }
+      const Real *depth=&m_depth[static_cast<size_t>(tile*c_tilePixels)];
+      for(int ly=py0; ly<=py1; ++ly)
+      {
+        for(int lx=px0; lx<=px1; ++lx)
+        {
+          if(zMin <= depth[ly*TILESIZE+lx])
+          {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionCuller::testBox(const Vec3 &_min, const Vec3 &_max, const Mat4 &_mvp) const noexcept
+{
+  // transform the min corner once then step along the edges by the scaled matrix rows
+  Vec4 corners[8];
+  corners[0]=Vec4(_min.m_x,_min.m_y,_min.m_z,1.0f)*_mvp;
+  Real ext[3]={_max.m_x-_min.m_x,_max.m_y-_min.m_y,_max.m_z-_min.m_z};
+  for(int axis=0; axis<3; ++axis)
+  {
+    int step=1<<axis;
+    for(int i=0; i<step; ++i)
+    {
+      const Vec4 &c=corners[i];
+      corners[i+step].set(c.m_x+_mvp.m_m[axis][0]*ext[axis],
+                          c.m_y+_mvp.m_m[axis][1]*ext[axis],
+                          c.m_z+_mvp.m_m[axis][2]*ext[axis],
+                          c.m_w+_mvp.m_m[axis][3]*ext[axis]);
+    }
+  }
+  return testCorners(corners);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionCuller::isVisible(const Vec3 &_min, const Vec3 &_max) const noexcept
+{
+  return testBox(_min,_max,m_viewProject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionCuller::isVisible(const BBox &_box) const noexcept
+{
+  return testBox(Vec3(_box.minX(),_box.minY(),_box.minZ()),Vec3(_box.maxX(),_box.maxY(),_box.maxZ()),m_viewProject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionCuller::isVisible(const BBox &_box, const Mat4 &_tx) const noexcept
+{
+  return testBox(Vec3(_box.minX(),_box.minY(),_box.minZ()),Vec3(_box.maxX(),_box.maxY(),_box.maxZ()),_tx*m_viewProject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::testVisibility(const Vec3 *_min, const Vec3 *_max, size_t _size, std::vector<uint8_t> &o_visible) const
+{
+  o_visible.resize(_size);
+  parallelFor(0,_size,[this,_min,_max,&o_visible](size_t _b, size_t _e)
+  {
+    for(size_t i=_b; i<_e; ++i)
+    {
+      o_visible[i]=isVisible(_min[i],_max[i]) ? 1 : 0;
+    }
+  },1024);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real OcclusionCuller::getDepth(int _x, int _y) const noexcept
+{
+  NGL_ASSERT(_x >= 0 && _x < m_width && _y >= 0 && _y < m_height);
+  int tile=(_y/TILESIZE)*m_tilesX+_x/TILESIZE;
+  return m_depth[static_cast<size_t>(tile*c_tilePixels+(_y%TILESIZE)*TILESIZE+_x%TILESIZE)];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionCuller::getDepthBuffer(std::vector<Real> &o_depth) const
+{
+  o_depth.resize(m_depth.size());
+  for(int y=0; y<m_height; ++y)
+  {
+    for(int x=0; x<m_width; ++x)
+    {
+      o_depth[static_cast<size_t>(y*m_width+x)]=getDepth(x,y);
+    }
+  }
+}
+
+} // end ngl namespace
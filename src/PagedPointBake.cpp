@@ -0,0 +1,403 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "PagedPointBake.h"
+#include "NCCAPointBake.h"
+#include "NGLassert.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <limits>
+
+#ifdef WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PagedPointBake.cpp
+/// @brief implementation files for PagedPointBake class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  // the on disk header, frames start at dataOffset and are frameStride apart
+  //----------------------------------------------------------------------------------------------------------------------
+  struct FileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t numFrames;
+    uint32_t numVerts;
+    uint32_t startFrame;
+    uint64_t frameStride;
+    uint64_t dataOffset;
+  };
+  const char c_magic[8]={'n','g','l','p','b','v','2','\0'};
+  constexpr uint32_t c_version=2;
+  // frames are aligned to 16k so they cover whole pages on 4k and 16k page systems
+  constexpr uint64_t c_frameAlign=16384;
+
+  inline uint64_t alignUp(uint64_t _v) noexcept
+  {
+    return (_v+c_frameAlign-1) & ~(c_frameAlign-1);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  // the platform specific mapping calls
+  //----------------------------------------------------------------------------------------------------------------------
+  const char *mapFile(const std::string &_fileName, size_t &o_size) noexcept
+  {
+#ifdef WIN32
+    HANDLE file=CreateFileA(_fileName.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+      return nullptr;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file,&size);
+    o_size=static_cast<size_t>(size.QuadPart);
+    HANDLE mapping=CreateFileMappingA(file,nullptr,PAGE_READONLY,0,0,nullptr);
+    const char *data=nullptr;
+    if(mapping != nullptr)
+    {
+      data=static_cast<const char *>(MapViewOfFile(mapping,FILE_MAP_READ,0,0,0));
+      // the view keeps the file open
+      CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    return data;
+#else
+    int fd=::open(_fileName.c_str(),O_RDONLY);
+    if(fd < 0)
+    {
+      return nullptr;
+    }
+    struct stat info;
+    if(fstat(fd,&info) != 0 || info.st_size == 0)
+    {
+      ::close(fd);
+      return nullptr;
+    }
+    o_size=static_cast<size_t>(info.st_size);
+    void *data=mmap(nullptr,o_size,PROT_READ,MAP_SHARED,fd,0);
+    // the mapping keeps the file open
+    ::close(fd);
+    if(data == MAP_FAILED)
+    {
+      return nullptr;
+    }
+    // we do our own read ahead so stop the kernel guessing
+    madvise(data,o_size,MADV_RANDOM);
+    return static_cast<const char *>(data);
+#endif
+  }
+
+  void unmapFile(const char *_data, size_t _size) noexcept
+  {
+#ifdef WIN32
+    NGL_UNUSED(_size);
+    UnmapViewOfFile(_data);
+#else
+    munmap(const_cast<char *>(_data),_size);
+#endif
+  }
+
+  // drop a frame from memory, the mapping stays valid and will fault the data back in if touched
+  void evictPages(const char *_data, size_t _size) noexcept
+  {
+#ifdef WIN32
+    // unlocking pages that aren't locked removes them from the working set
+    VirtualUnlock(const_cast<char *>(_data),_size);
+#else
+    madvise(const_cast<char *>(_data),_size,MADV_DONTNEED);
+#endif
+  }
+
+  // bring a frame into memory
+  void loadPages(const char *_data, size_t _size) noexcept
+  {
+#ifndef WIN32
+    madvise(const_cast<char *>(_data),_size,MADV_WILLNEED);
+#endif
+    // touch every page so the frame is really resident when playback gets there
+    volatile char sum=0;
+    for(size_t i=0; i<_size; i+=4096)
+    {
+      sum+=_data[i];
+    }
+    NGL_UNUSED(sum);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+PagedPointBake::PagedPointBake(unsigned int _residentFrames, unsigned int _prefetchFrames) noexcept :
+  m_residentBudget(std::max(1u,_residentFrames)),m_prefetchFrames(_prefetchFrames)
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+PagedPointBake::~PagedPointBake() noexcept
+{
+  close();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool PagedPointBake::open(const std::string &_fileName) noexcept
+{
+  close();
+  size_t size=0;
+  const char *data=mapFile(_fileName,size);
+  if(data == nullptr)
+  {
+    std::cerr<<"problems Opening File "<<_fileName<<"\n";
+    return false;
+  }
+  FileHeader header;
+  if(size < sizeof(FileHeader))
+  {
+    std::cerr<<_fileName<<" is not a v2 point bake file\n";
+    unmapFile(data,size);
+    return false;
+  }
+  std::memcpy(&header,data,sizeof(FileHeader));
+  if(std::memcmp(header.magic,c_magic,sizeof(c_magic)) != 0 || header.version != c_version ||
+     header.frameStride < header.numVerts*3*sizeof(Real) ||
+     header.dataOffset+header.frameStride*header.numFrames > size)
+  {
+    std::cerr<<_fileName<<" is not a v2 point bake file\n";
+    unmapFile(data,size);
+    return false;
+  }
+  m_data=data;
+  m_mappedSize=size;
+  m_numFrames=header.numFrames;
+  m_numVerts=header.numVerts;
+  m_startFrame=header.startFrame;
+  m_frameStride=static_cast<size_t>(header.frameStride);
+  m_dataOffset=static_cast<size_t>(header.dataOffset);
+  m_lastUse.assign(m_numFrames,0);
+  m_useCounter=0;
+  m_numResident=0;
+  m_currentFrame=0;
+  m_direction=1;
+  m_quit=false;
+  m_prefetchQueue.clear();
+  m_prefetchThread=std::thread(&PagedPointBake::prefetchLoop,this);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void PagedPointBake::close() noexcept
+{
+  if(m_data == nullptr)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit=true;
+  }
+  m_wake.notify_one();
+  m_prefetchThread.join();
+  unmapFile(m_data,m_mappedSize);
+  m_data=nullptr;
+  m_mappedSize=0;
+  m_numFrames=0;
+  m_numVerts=0;
+  m_lastUse.clear();
+  m_numResident=0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void PagedPointBake::setResidentFrames(unsigned int _frames) noexcept
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_residentBudget=std::max(1u,_frames);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void PagedPointBake::setPrefetchFrames(unsigned int _frames) noexcept
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_prefetchFrames=_frames;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+unsigned int PagedPointBake::getNumResidentFrames() const noexcept
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_numResident;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void PagedPointBake::makeResident(unsigned int _frame) noexcept
+{
+  if(m_lastUse[_frame] == 0)
+  {
+    ++m_numResident;
+  }
+  m_lastUse[_frame]=++m_useCounter;
+  while(m_numResident > m_residentBudget)
+  {
+    // the budget is small compared to the frame count so a scan is fine here
+    unsigned int oldest=m_currentFrame;
+    uint64_t oldestUse=std::numeric_limits<uint64_t>::max();
+    for(unsigned int f=0; f<m_numFrames; ++f)
+    {
+      if(m_lastUse[f] != 0 && m_lastUse[f] < oldestUse && f != m_currentFrame && f != _frame)
+      {
+        oldest=f;
+        oldestUse=m_lastUse[f];
+      }
+    }
+    if(oldest == m_currentFrame)
+    {
+      break;
+    }
+    evictPages(frameData(oldest),m_frameStride);
+    m_lastUse[oldest]=0;
+    --m_numResident;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const Vec3 *PagedPointBake::getFrame(unsigned int _frame) noexcept
+{
+  NGL_ASSERT(m_data != nullptr && _frame < m_numFrames);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(_frame > m_currentFrame)
+    {
+      m_direction=1;
+    }
+    else if(_frame < m_currentFrame)
+    {
+      m_direction=-1;
+    }
+    bool resident=m_lastUse[_frame] != 0;
+    m_currentFrame=_frame;
+    makeResident(_frame);
+    if(!resident)
+    {
+      // start the read now, the pages will fault in as they are used
+#ifndef WIN32
+      madvise(const_cast<char *>(frameData(_frame)),m_frameStride,MADV_WILLNEED);
+#endif
+    }
+    // keep the prefetch window inside the budget or it will evict itself
+    unsigned int window=std::min(m_prefetchFrames,m_residentBudget-1);
+    m_prefetchQueue.clear();
+    for(unsigned int i=1; i<=window; ++i)
+    {
+      int64_t f=static_cast<int64_t>(_frame)+m_direction*static_cast<int64_t>(i);
+      if(f < 0 || f >= static_cast<int64_t>(m_numFrames))
+      {
+        break;
+      }
+      m_prefetchQueue.push_back(static_cast<unsigned int>(f));
+    }
+  }
+  m_wake.notify_one();
+  return reinterpret_cast<const Vec3 *>(frameData(_frame));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void PagedPointBake::prefetchLoop() noexcept
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while(!m_quit)
+  {
+    if(m_prefetchQueue.empty())
+    {
+      m_wake.wait(lock);
+      continue;
+    }
+    unsigned int frame=m_prefetchQueue.front();
+    m_prefetchQueue.erase(m_prefetchQueue.begin());
+    if(m_lastUse[frame] != 0)
+    {
+      continue;
+    }
+    makeResident(frame);
+    const char *data=frameData(frame);
+    // do the actual IO without the lock so playback isn't blocked, if the frame is evicted
+    // meanwhile the mapping is still valid so the worst case is wasted IO
+    lock.unlock();
+    loadPages(data,m_frameStride);
+    lock.lock();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool PagedPointBake::save(const std::string &_fileName, const std::vector<std::vector<Vec3>> &_frames, unsigned int _startFrame) noexcept
+{
+  static_assert(sizeof(Vec3) == 3*sizeof(Real),"Vec3 must be packed x,y,z to be written as a block");
+  uint32_t numVerts= _frames.empty() ? 0 : static_cast<uint32_t>(_frames[0].size());
+  for(auto &f : _frames)
+  {
+    if(f.size() != numVerts)
+    {
+      std::cerr<<"all frames must have the same number of vertices to save "<<_fileName<<"\n";
+      return false;
+    }
+  }
+  std::ofstream file(_fileName.c_str(),std::ios::out | std::ios::binary);
+  if(!file.is_open())
+  {
+    std::cerr<<"problems Opening File "<<_fileName<<"\n";
+    return false;
+  }
+  FileHeader header;
+  std::memcpy(header.magic,c_magic,sizeof(c_magic));
+  header.version=c_version;
+  header.numFrames=static_cast<uint32_t>(_frames.size());
+  header.numVerts=numVerts;
+  header.startFrame=_startFrame;
+  uint64_t frameSize=numVerts*3*sizeof(Real);
+  header.frameStride=std::max<uint64_t>(c_frameAlign,alignUp(frameSize));
+  header.dataOffset=alignUp(sizeof(FileHeader));
+  file.write(reinterpret_cast<const char *>(&header),sizeof(FileHeader));
+  std::vector<char> padding(static_cast<size_t>(std::max<uint64_t>(1,std::max(header.dataOffset-sizeof(FileHeader),header.frameStride-frameSize))),0);
+  file.write(&padding[0],static_cast<std::streamsize>(header.dataOffset-sizeof(FileHeader)));
+  for(auto &f : _frames)
+  {
+    if(numVerts != 0)
+    {
+      file.write(reinterpret_cast<const char *>(&f[0]),static_cast<std::streamsize>(frameSize));
+    }
+    file.write(&padding[0],static_cast<std::streamsize>(header.frameStride-frameSize));
+  }
+  return file.good();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool PagedPointBake::save(const std::string &_fileName, NCCAPointBake &_bake) noexcept
+{
+  return save(_fileName,_bake.getRawDataPointer(),_bake.getStartFrame());
+}
+
+} // end ngl namespace
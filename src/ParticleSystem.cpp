@@ -0,0 +1,218 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ParticleSystem.h"
+#include "GLState.h"
+#include "ParallelFor.h"
+#include "Random.h"
+#include "VAOPrimitives.h"
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ParticleSystem.cpp
+/// @brief implementation files for ParticleSystem class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+// the number of particles worth giving to a thread
+constexpr size_t c_grainSize=16384;
+
+//----------------------------------------------------------------------------------------------------------------------
+ParticleSystem::ParticleSystem(size_t _maxParticles, const Vec3 &_emitterPos) :
+  m_maxParticles(_maxParticles),m_emitterPos(_emitterPos)
+{
+  m_px.resize(_maxParticles);
+  m_py.resize(_maxParticles);
+  m_pz.resize(_maxParticles);
+  m_vx.resize(_maxParticles);
+  m_vy.resize(_maxParticles);
+  m_vz.resize(_maxParticles);
+  m_life.resize(_maxParticles);
+  m_invLifeSpan.resize(_maxParticles);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+ParticleSystem::~ParticleSystem()
+{
+  if(m_instanceBuffer !=0)
+  {
+    GLState::instance()->deleteBuffers(1,&m_instanceBuffer);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t ParticleSystem::emit(size_t _count)
+{
+  _count=std::min(_count,m_maxParticles-m_numParticles);
+  if(_count == 0)
+  {
+    return 0;
+  }
+  size_t first=m_numParticles;
+  size_t numChunks=std::min<size_t>(numWorkerThreads(),(_count+c_grainSize-1)/c_grainSize);
+  // ngl::Random isn't thread safe so it is used to seed a generator per chunk
+  std::vector<unsigned int> seeds(numChunks);
+  Random *rng=Random::instance();
+  for(auto &s : seeds)
+  {
+    s=static_cast<unsigned int>(rng->randomPositiveNumber(2147483647.0f));
+  }
+  Vec3 dir=m_emitDir;
+  dir.normalize();
+  parallelForChunks(first,first+_count,numChunks,[this,&seeds,dir](size_t _c, size_t _b, size_t _e)
+  {
+    std::minstd_rand gen(seeds[_c]);
+    std::uniform_real_distribution<Real> plusMinusOne(-1.0f,1.0f);
+    std::uniform_real_distribution<Real> speed(m_minSpeed,m_maxSpeed);
+    std::uniform_real_distribution<Real> life(m_minLife,m_maxLife);
+    for(size_t i=_b; i<_e; ++i)
+    {
+      Vec3 v(dir.m_x+plusMinusOne(gen)*m_spread,
+             dir.m_y+plusMinusOne(gen)*m_spread,
+             dir.m_z+plusMinusOne(gen)*m_spread);
+      v.normalize();
+      v*=speed(gen);
+      m_px[i]=m_emitterPos.m_x;
+      m_py[i]=m_emitterPos.m_y;
+      m_pz[i]=m_emitterPos.m_z;
+      m_vx[i]=v.m_x;
+      m_vy[i]=v.m_y;
+      m_vz[i]=v.m_z;
+      Real l=life(gen);
+      m_life[i]=l;
+      m_invLifeSpan[i]=1.0f/l;
+    }
+  });
+  m_numParticles+=_count;
+  return _count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ParticleSystem::update(Real _dt)
+{
+  Real ax=m_acceleration.m_x*_dt;
+  Real ay=m_acceleration.m_y*_dt;
+  Real az=m_acceleration.m_z*_dt;
+  Real damp=std::max(0.0f,1.0f-m_drag*_dt);
+  parallelFor(0,m_numParticles,[=](size_t _b, size_t _e)
+  {
+    // plain SoA loops with no aliasing between the arrays so the compiler can vectorise them
+    Real * __restrict px=&m_px[0];
+    Real * __restrict py=&m_py[0];
+    Real * __restrict pz=&m_pz[0];
+    Real * __restrict vx=&m_vx[0];
+    Real * __restrict vy=&m_vy[0];
+    Real * __restrict vz=&m_vz[0];
+    Real * __restrict life=&m_life[0];
+    for(size_t i=_b; i<_e; ++i)
+    {
+      vx[i]=vx[i]*damp+ax;
+      vy[i]=vy[i]*damp+ay;
+      vz[i]=vz[i]*damp+az;
+      px[i]+=vx[i]*_dt;
+      py[i]+=vy[i]*_dt;
+      pz[i]+=vz[i]*_dt;
+      life[i]-=_dt;
+    }
+  },c_grainSize);
+  compact();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ParticleSystem::compact() noexcept
+{
+  size_t i=0;
+  size_t n=m_numParticles;
+  while(i<n)
+  {
+    if(m_life[i] <= 0.0f)
+    {
+      // move the last live particle into the gap, order isn't important
+      --n;
+      m_px[i]=m_px[n];
+      m_py[i]=m_py[n];
+      m_pz[i]=m_pz[n];
+      m_vx[i]=m_vx[n];
+      m_vy[i]=m_vy[n];
+      m_vz[i]=m_vz[n];
+      m_life[i]=m_life[n];
+      m_invLifeSpan[i]=m_invLifeSpan[n];
+    }
+    else
+    {
+      ++i;
+    }
+  }
+  m_numParticles=n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ParticleSystem::draw(const std::string &_primitive)
+{
+  if(m_numParticles == 0)
+  {
+    return;
+  }
+  AbstractVAO *vao=VAOPrimitives::instance()->getVAOFromName(_primitive);
+  if(vao == nullptr)
+  {
+    std::cerr<<"Warning VAO not know in Primitive list "<<_primitive<<"\n";
+    return;
+  }
+  GLsizeiptr bufferSize=static_cast<GLsizeiptr>(m_maxParticles*4*sizeof(GLfloat));
+  if(m_instanceBuffer == 0)
+  {
+    glGenBuffers(1,&m_instanceBuffer);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER,bufferSize,nullptr,GL_STREAM_DRAW);
+  }
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_instanceBuffer);
+  // invalidate so the driver can hand back fresh memory rather than wait for the last draw
+  GLfloat *dst=static_cast<GLfloat *>(glMapBufferRange(GL_ARRAY_BUFFER,0,
+                                      static_cast<GLsizeiptr>(m_numParticles*4*sizeof(GLfloat)),
+                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if(dst == nullptr)
+  {
+    std::cerr<<"ParticleSystem unable to map instance buffer\n";
+    return;
+  }
+  parallelFor(0,m_numParticles,[this,dst](size_t _b, size_t _e)
+  {
+    for(size_t i=_b; i<_e; ++i)
+    {
+      dst[i*4]=m_px[i];
+      dst[i*4+1]=m_py[i];
+      dst[i*4+2]=m_pz[i];
+      dst[i*4+3]=1.0f-m_life[i]*m_invLifeSpan[i];
+    }
+  },c_grainSize);
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+
+  vao->bind();
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_instanceBuffer);
+  glVertexAttribPointer(m_instanceAttribute,4,GL_FLOAT,GL_FALSE,0,nullptr);
+  glEnableVertexAttribArray(m_instanceAttribute);
+  glVertexAttribDivisor(m_instanceAttribute,1);
+  vao->drawInstanced(static_cast<unsigned int>(m_numParticles));
+  // leave the shared primitive VAO as we found it
+  glVertexAttribDivisor(m_instanceAttribute,0);
+  glDisableVertexAttribArray(m_instanceAttribute);
+  vao->unbind();
+}
+
+} // end ngl namespace
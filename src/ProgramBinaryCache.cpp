@@ -0,0 +1,237 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ProgramBinaryCache.h"
+#include "GLDispatch.h"
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "ShaderPreprocessor.h"
+#include "fmt/format.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ProgramBinaryCache.cpp
+/// @brief implementation files for ProgramBinaryCache class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+using namespace dispatch;
+namespace
+{
+  // bump if the file layout changes
+  constexpr uint32_t c_version=1;
+  constexpr char c_magic[4]={'N','G','L','B'};
+
+  uint64_t hashString(const std::string &_s, uint64_t _hash) noexcept
+  {
+    // include the length so "ab"+"c" and "a"+"bc" differ
+    uint64_t size=_s.size();
+    _hash=ShaderPreprocessor::hashBytes(&size,sizeof(size),_hash);
+    return ShaderPreprocessor::hash(_s,_hash);
+  }
+
+  template <class T>
+  void writeValue(std::ofstream &_file, const T &_v)
+  {
+    _file.write(reinterpret_cast<const char *>(&_v),sizeof(T));
+  }
+
+  template <class T>
+  bool readValue(std::ifstream &_file, T &o_v)
+  {
+    _file.read(reinterpret_cast<char *>(&o_v),sizeof(T));
+    return _file.good();
+  }
+
+  // the bytes between the read position and the end of the file, sizes read from the file are checked
+  // against this so a damaged file can't ask for a huge allocation
+  uint64_t bytesLeft(std::ifstream &_file)
+  {
+    std::streampos pos=_file.tellg();
+    _file.seekg(0,std::ios::end);
+    std::streampos end=_file.tellg();
+    _file.seekg(pos);
+    return end > pos ? static_cast<uint64_t>(end-pos) : 0;
+  }
+
+  const char *glString(GLenum _name) noexcept
+  {
+    const GLubyte *s=glGetString(_name);
+    return s != nullptr ? reinterpret_cast<const char *>(s) : "";
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+ProgramBinaryCache::ProgramBinaryCache(const std::string &_directory) noexcept : m_directory(_directory)
+{
+  m_driver=fmt::format("{0}\n{1}\n{2}",glString(GL_VENDOR),glString(GL_RENDERER),glString(GL_VERSION));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ProgramBinaryCache::isSupported() noexcept
+{
+  if(glGetProgramBinary == nullptr || glProgramBinary == nullptr)
+  {
+    return false;
+  }
+  GLint formats=0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+  return formats > 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::string ProgramBinaryCache::getFileName(uint64_t _key) const
+{
+  return fmt::format("{0}/{1:016x}.nglbin",m_directory,_key);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t ProgramBinaryCache::getKey(const ShaderProgram &_program, const std::string &_defines) const noexcept
+{
+  uint64_t hash=14695981039346656037ull;
+  hash=hashString(m_driver,hash);
+  // attribute locations change the link so are part of the key, sorted as the map order isn't fixed
+  std::vector<std::pair<std::string,GLuint>> attribs(_program.m_attribs.begin(),_program.m_attribs.end());
+  std::sort(attribs.begin(),attribs.end());
+  for(auto &a : attribs)
+  {
+    hash=hashString(a.first,hash);
+    hash=ShaderPreprocessor::hashBytes(&a.second,sizeof(GLuint),hash);
+  }
+  for(auto shader : _program.m_shaders)
+  {
+    hash=hashString(shader->getShaderSource(),hash);
+  }
+  return hashString(_defines,hash);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ProgramBinaryCache::prepare(const ShaderProgram &_program) const noexcept
+{
+  glProgramParameteri(_program.m_programID,GL_PROGRAM_BINARY_RETRIEVABLE_HINT,GL_TRUE);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ProgramBinaryCache::load(ShaderProgram &io_program, uint64_t _key) noexcept
+{
+  std::ifstream file(getFileName(_key).c_str(),std::ios::in | std::ios::binary);
+  char magic[4];
+  uint32_t version=0;
+  uint64_t key=0;
+  GLenum format=0;
+  uint32_t size=0;
+  if(!file.is_open() || !readValue(file,magic) || !std::equal(magic,magic+4,c_magic) ||
+     !readValue(file,version) || version != c_version || !readValue(file,key) || key != _key ||
+     !readValue(file,format) || !readValue(file,size) || size == 0 || size > bytesLeft(file))
+  {
+    ++m_misses;
+    return false;
+  }
+  std::vector<char> binary(size);
+  file.read(binary.data(),size);
+  // the uniforms are read before touching GL so a truncated file leaves the program as it was
+  uint32_t numUniforms=0;
+  std::vector<ShaderProgram::uniformData> uniforms;
+  bool ok=file.good() && readValue(file,numUniforms);
+  for(uint32_t i=0; ok && i<numUniforms; ++i)
+  {
+    ShaderProgram::uniformData data;
+    uint32_t nameSize=0;
+    uint8_t shadowed=0;
+    ok=readValue(file,nameSize) && nameSize <= bytesLeft(file);
+    if(ok)
+    {
+      data.name.resize(nameSize);
+      file.read(&data.name[0],nameSize);
+      ok=readValue(file,data.loc) && readValue(file,data.type) && readValue(file,shadowed);
+      data.shadow=UniformShadow(shadowed != 0);
+      uniforms.push_back(data);
+    }
+  }
+  if(!ok)
+  {
+    ++m_misses;
+    return false;
+  }
+
+  GLuint id=io_program.m_programID;
+  glProgramBinary(id,format,binary.data(),static_cast<GLsizei>(size));
+  GLint linked=GL_FALSE;
+  glGetProgramiv(id,GL_LINK_STATUS,&linked);
+  if(linked == GL_FALSE)
+  {
+    // the driver has changed the format, rebuild from source
+    ++m_misses;
+    return false;
+  }
+  io_program.m_registeredUniforms.clear();
+  for(auto &u : uniforms)
+  {
+    io_program.m_registeredUniforms[u.name]=u;
+  }
+  io_program.buildUniformHashes();
+  io_program.m_linked=true;
+  GLState::instance()->useProgram(id);
+  ++m_hits;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ProgramBinaryCache::save(const ShaderProgram &_program, uint64_t _key) const noexcept
+{
+  GLuint id=_program.m_programID;
+  GLint size=0;
+  glGetProgramiv(id,GL_PROGRAM_BINARY_LENGTH,&size);
+  if(size <= 0)
+  {
+    return false;
+  }
+  std::vector<char> binary(static_cast<size_t>(size));
+  GLenum format=0;
+  GLsizei written=0;
+  glGetProgramBinary(id,size,&written,&format,binary.data());
+  if(written <= 0)
+  {
+    return false;
+  }
+
+  std::ofstream file(getFileName(_key).c_str(),std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!file.is_open())
+  {
+    std::cerr<<"unable to write program cache file "<<getFileName(_key)<<"\n";
+    return false;
+  }
+  file.write(c_magic,sizeof(c_magic));
+  writeValue(file,c_version);
+  writeValue(file,_key);
+  writeValue(file,format);
+  writeValue(file,static_cast<uint32_t>(written));
+  file.write(binary.data(),written);
+  writeValue(file,static_cast<uint32_t>(_program.m_registeredUniforms.size()));
+  for(auto &u : _program.m_registeredUniforms)
+  {
+    writeValue(file,static_cast<uint32_t>(u.second.name.size()));
+    file.write(u.second.name.data(),static_cast<std::streamsize>(u.second.name.size()));
+    writeValue(file,u.second.loc);
+    writeValue(file,u.second.type);
+    writeValue(file,static_cast<uint8_t>(u.second.shadow.isActive() ? 1 : 0));
+  }
+  return file.good();
+}
+
+} // end ngl namespace
@@ -18,6 +18,7 @@
 #include "Random.h"
 #include <cstdlib> // for time
 #include <ctime>
+#include <iostream>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Random.cpp
@@ -25,8 +26,8 @@
 //----------------------------------------------------------------------------------------------------------------------
 namespace ngl
 {
-  constexpr auto RandomFloat="RandomFloat";
-  constexpr auto RandomPositiveFloat="RandomPositiveFloat";
+  constexpr StringID RandomFloat("RandomFloat");
+  constexpr StringID RandomPositiveFloat("RandomPositiveFloat");
 
 //----------------------------------------------------------------------------------------------------------------------
 void Random::setSeed()
@@ -58,6 +59,18 @@ Random::Random()
 
 //----------------------------------------------------------------------------------------------------------------------
 Real Random::getFloatFromGeneratorName(const std::string &_name  )
+{
+  StringID id(_name);
+  if(m_floatGenerators.find(id) == m_floatGenerators.end())
+  {
+    std::cerr<<"Warning no random generator named "<<_name<<" returning 0\n";
+    return 0;
+  }
+  return getFloatFromGeneratorName(id);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real Random::getFloatFromGeneratorName(StringID _name  )
 {
   // grab a function pointer based on the _name from the map
   //auto func=m_floatGenerators[_name];
@@ -71,6 +84,7 @@ Real Random::getFloatFromGeneratorName(const std::string &_name  )
   else
   {
     // otherwise we return the safest possible value 0
+    std::cerr<<"Warning no random generator named "<<_name.getString()<<" returning 0\n";
     return 0;
   }
 }
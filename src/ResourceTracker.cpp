@@ -0,0 +1,242 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ResourceTracker.h"
+#include "Logger.h"
+#include <algorithm>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ResourceTracker.cpp
+/// @brief implementation files for ResourceTracker class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+ResourceTracker *ResourceTracker::instance() noexcept
+{
+  // never deleted so resources freed by other statics' destructors at exit can still be released
+  static ResourceTracker *s_tracker=new ResourceTracker;
+  return s_tracker;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+ResourceTracker::ResourceTracker() noexcept
+{
+  m_current.fill(0);
+  m_peak.fill(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const char *ResourceTracker::getName(Category _category) noexcept
+{
+  static const char *names[NUMCATEGORIES]={"GPU buffers","GPU textures","CPU meshes","CPU point bakes"};
+  return _category < NUMCATEGORIES ? names[_category] : "unknown";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ResourceTracker::update(Category _category, uintptr_t _handle, size_t _bytes, bool _add, const std::string &_tag)
+{
+  auto entry=m_resources.find(Key(_category,_handle));
+  if(entry == m_resources.end())
+  {
+    entry=m_resources.insert({Key(_category,_handle),Resource{_category,_handle,0,_tag,m_serial++}}).first;
+  }
+  Resource &r=entry->second;
+  if(!_tag.empty())
+  {
+    r.tag=_tag;
+  }
+  size_t bytes= _add ? r.bytes+_bytes : _bytes;
+  m_current[_category]=m_current[_category]-r.bytes+bytes;
+  m_totalCurrent=m_totalCurrent-r.bytes+bytes;
+  r.bytes=bytes;
+  m_peak[_category]=std::max(m_peak[_category],m_current[_category]);
+  m_totalPeak=std::max(m_totalPeak,m_totalCurrent);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ResourceTracker::track(Category _category, uintptr_t _handle, size_t _bytes, const std::string &_tag)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  update(_category,_handle,_bytes,false,_tag);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ResourceTracker::add(Category _category, uintptr_t _handle, size_t _bytes, const std::string &_tag)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  update(_category,_handle,_bytes,true,_tag);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ResourceTracker::release(Category _category, uintptr_t _handle)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto entry=m_resources.find(Key(_category,_handle));
+  if(entry == m_resources.end())
+  {
+    return;
+  }
+  m_current[_category]-=entry->second.bytes;
+  m_totalCurrent-=entry->second.bytes;
+  m_resources.erase(entry);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ResourceTracker::setTag(Category _category, uintptr_t _handle, const std::string &_tag)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto entry=m_resources.find(Key(_category,_handle));
+  if(entry != m_resources.end())
+  {
+    entry->second.tag=_tag;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::string ResourceTracker::getTag(Category _category, uintptr_t _handle) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto entry=m_resources.find(Key(_category,_handle));
+  return entry != m_resources.end() ? entry->second.tag : std::string();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t ResourceTracker::getCurrent(Category _category) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_current[_category];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t ResourceTracker::getPeak(Category _category) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_peak[_category];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t ResourceTracker::getTotalCurrent() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_totalCurrent;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t ResourceTracker::getTotalPeak() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_totalPeak;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t ResourceTracker::getNumResources(Category _category) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // the map is ordered by category first so this is one range
+  auto begin=m_resources.lower_bound(Key(_category,0));
+  auto end=m_resources.lower_bound(Key(_category+1,0));
+  return static_cast<size_t>(std::distance(begin,end));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<ResourceTracker::Resource> ResourceTracker::getResources() const
+{
+  std::vector<Resource> resources;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    resources.reserve(m_resources.size());
+    for(auto &r : m_resources)
+    {
+      resources.push_back(r.second);
+    }
+  }
+  std::sort(resources.begin(),resources.end(),[](const Resource &_a, const Resource &_b)
+  {
+    return _a.bytes > _b.bytes;
+  });
+  return resources;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<std::pair<std::string,size_t>> ResourceTracker::getBytesByTag(Category _category) const
+{
+  std::unordered_map<std::string,size_t> tags;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto end=m_resources.lower_bound(Key(_category+1,0));
+    for(auto r=m_resources.lower_bound(Key(_category,0)); r!=end; ++r)
+    {
+      tags[r->second.tag]+=r->second.bytes;
+    }
+  }
+  std::vector<std::pair<std::string,size_t>> bytes(tags.begin(),tags.end());
+  std::sort(bytes.begin(),bytes.end(),[](const std::pair<std::string,size_t> &_a,
+                                         const std::pair<std::string,size_t> &_b)
+  {
+    return _a.second > _b.second;
+  });
+  return bytes;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ResourceTracker::report(size_t _top) const
+{
+  Logger *log=Logger::instance();
+  log->logMessage("Resource memory current %zu peak %zu bytes\n",getTotalCurrent(),getTotalPeak());
+  for(int c=0; c<NUMCATEGORIES; ++c)
+  {
+    Category category=static_cast<Category>(c);
+    log->logMessage("%-16s %6zu resources current %12zu peak %12zu bytes\n",getName(category),
+                    getNumResources(category),getCurrent(category),getPeak(category));
+    auto tags=getBytesByTag(category);
+    for(size_t i=0; i<std::min(_top,tags.size()); ++i)
+    {
+      log->logMessage("  %-40.40s %12zu bytes\n",tags[i].first.c_str(),tags[i].second);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t ResourceTracker::reportLeaks() const
+{
+  std::vector<Resource> resources=getResources();
+  std::sort(resources.begin(),resources.end(),[](const Resource &_a, const Resource &_b)
+  {
+    return _a.serial < _b.serial;
+  });
+  Logger *log=Logger::instance();
+  for(auto &r : resources)
+  {
+    log->logWarning("Resource not released %s %s handle %#zx %zu bytes\n",getName(r.category),r.tag.c_str(),
+                    static_cast<size_t>(r.handle),r.bytes);
+  }
+  return resources.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ResourceTracker::reset()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_resources.clear();
+  m_current.fill(0);
+  m_peak.fill(0);
+  m_totalCurrent=0;
+  m_totalPeak=0;
+  m_serial=0;
+}
+
+} // end ngl namespace
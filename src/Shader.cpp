@@ -18,6 +18,7 @@
 //#include <QFile>
 #include <fstream>
 #include "Shader.h"
+#include "CPUProfiler.h"
 #include <string> // needed for windows build as get error otherwise
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -79,6 +80,13 @@ Shader::~Shader()
 
 void Shader::compile() noexcept
 {
+  submitCompile();
+  checkCompileStatus();
+}
+
+void Shader::submitCompile() noexcept
+{
+  NGL_PROFILE_SCOPE("Shader::submitCompile");
   if (m_source.empty() )
   {
     std::cerr<<"Warning no shader source loaded\n";
@@ -86,6 +94,30 @@ void Shader::compile() noexcept
   }
 
   glCompileShader(m_shaderHandle);
+  m_compilePending=true;
+}
+
+bool Shader::isCompileComplete() const noexcept
+{
+#ifndef USINGIOS_
+  if(m_compilePending && GLEW_ARB_parallel_shader_compile)
+  {
+    GLint complete=GL_TRUE;
+    glGetShaderiv(m_shaderHandle,GL_COMPLETION_STATUS_ARB,&complete);
+    return complete == GL_TRUE;
+  }
+#endif
+  return true;
+}
+
+void Shader::checkCompileStatus() noexcept
+{
+  NGL_PROFILE_SCOPE("Shader::checkCompileStatus");
+  if(!m_compilePending)
+  {
+    return;
+  }
+  m_compilePending=false;
   if(m_debugState==true)
   {
     GLint infologLength = 0;
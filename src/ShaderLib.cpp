@@ -19,11 +19,13 @@
 #include <memory>
 #include <algorithm>
 #include "ShaderLib.h"
+#include "GLState.h"
 #include "TextShaders.h"
 #include "ColourShaders.h"
 #include "DiffuseShaders.h"
 #include "ToonShaders.h"
 #include "rapidjson/document.h"
+#include "fmt/format.h"
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -38,61 +40,61 @@ namespace ngl
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParamFromMat4(const std::string &_paramName, Mat4 _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,_p1.openGL());
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformFromMat4(const std::string &_registeredUniformName, Mat4 _p1  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix4fv(_registeredUniformName,1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setRegisteredUniformMatrix4fv(_registeredUniformName,1,GL_FALSE,_p1.openGL());
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParamFromMat3(const std::string &_paramName, Mat3 _p1  ) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,_p1.openGL());
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformFromMat3( const std::string &_paramName, Mat3 _p1  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,_p1.openGL());
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParamFromVec4(const std::string &_paramName,	Vec4 _p1 ) noexcept
 {
 
-  (*this)[m_currentShader]->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
+  m_currentProgram->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformVec4( const std::string &_paramName, Vec4 _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z,_p1.m_w);
+  m_currentProgram->setRegisteredUniform4f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z,_p1.m_w);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParamFromColour( const std::string &_paramName,Colour _p1  ) noexcept
 {
 
-  (*this)[m_currentShader]->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
+  m_currentProgram->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformFromColour(const std::string &_paramName, Colour _p1  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName,_p1.m_r,_p1.m_g,_p1.m_b,_p1.m_a);
+  m_currentProgram->setRegisteredUniform4f(_paramName,_p1.m_r,_p1.m_g,_p1.m_b,_p1.m_a);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformVec3(const std::string &_paramName,Vec3 _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z);
+  m_currentProgram->setRegisteredUniform3f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformVec2( const std::string &_paramName, Vec2 _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName,_p1.m_x,_p1.m_y);
+  m_currentProgram->setRegisteredUniform2f(_paramName,_p1.m_x,_p1.m_y);
 }
 
 
@@ -101,50 +103,50 @@ void ShaderLib::setRegisteredUniformVec2( const std::string &_paramName, Vec2 _p
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam4f(const std::string &_paramName, float _p1,float _p2, float _p3, float _p4 ) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_p1,_p2,_p3,_p4);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_p1,_p2,_p3,_p4);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform4f(const std::string &_paramName,float _p1,float _p2, float _p3, float _p4 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName,_p1,_p2,_p3,_p4);
+  m_currentProgram->setRegisteredUniform4f(_paramName,_p1,_p2,_p3,_p4);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam3f(const std::string &_paramName, float _p1, float _p2,  float _p3  ) noexcept
 {
-  (*this)[m_currentShader]->setUniform3f(_paramName.c_str(),_p1,_p2,_p3);
+  m_currentProgram->setUniform3f(_paramName.c_str(),_p1,_p2,_p3);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform3f( const std::string &_paramName, float _p1, float _p2,  float _p3 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName,_p1,_p2,_p3);
+  m_currentProgram->setRegisteredUniform3f(_paramName,_p1,_p2,_p3);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam2f( const std::string &_paramName,float _p1, float _p2  ) noexcept
 {
-  (*this)[m_currentShader]->setUniform2f(_paramName.c_str(),_p1,_p2);
+  m_currentProgram->setUniform2f(_paramName.c_str(),_p1,_p2);
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform2f( const std::string &_paramName, float _p1, float _p2  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName,_p1,_p2);
+  m_currentProgram->setRegisteredUniform2f(_paramName,_p1,_p2);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam1i(const std::string &_paramName,  int _p1  ) noexcept
 {
-  (*this)[m_currentShader]->setUniform1i(_paramName.c_str(),_p1);
+  m_currentProgram->setUniform1i(_paramName.c_str(),_p1);
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform1i(const std::string &_paramName, int _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1i(_paramName,_p1);
+  m_currentProgram->setRegisteredUniform1i(_paramName,_p1);
 }
 
 
@@ -152,14 +154,14 @@ void ShaderLib::setRegisteredUniform1i(const std::string &_paramName, int _p1 )
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam1f( const std::string &_paramName, float _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setUniform1f(_paramName.c_str(),_p1);
+  m_currentProgram->setUniform1f(_paramName.c_str(),_p1);
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform1f(const std::string &_paramName, float _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1f(_paramName,_p1);
+  m_currentProgram->setRegisteredUniform1f(_paramName,_p1);
 }
 
 
@@ -199,6 +201,10 @@ void ShaderLib::reset() noexcept
     delete programs.second;
   for(auto shader : m_shaders)
     delete shader.second;
+  m_pendingLinks.clear();
+  m_permutations.clear();
+  m_permutationShaders.clear();
+  m_permutationPrograms.clear();
 }
 
 
@@ -234,8 +240,10 @@ ShaderLib::ShaderLib()  noexcept
  m_debugState=false;
  m_numShaders=0;
  m_nullProgram = new ShaderProgram("NULL");
- m_currentShader="NULL";
+ StringID::intern("NULL",m_currentShader);
+ m_currentProgram=m_nullProgram;
  m_shaderPrograms["NULL"]=m_nullProgram;
+ m_programIDs[m_currentShader]=m_nullProgram;
  loadTextShaders();
  loadColourShaders();
  loadDiffuseShaders();
@@ -254,7 +262,7 @@ GLuint ShaderLib::getShaderID(const std::string &_shaderName) noexcept
   }
   else
   {
-    std::cout<<"Warning: No shader named "<< _shaderName << " in " << m_currentShader <<" shader program \n";
+    std::cout<<"Warning: No shader named "<< _shaderName << " in " << m_currentShader.getString() <<" shader program \n";
   }
   return value;
 }
@@ -271,7 +279,7 @@ ngl::Shader* ShaderLib::getShader(const std::string &_shaderName) noexcept
   else
   {
     shaderPointer = nullptr;
-    std::cout<<"Warning: No shader named "<< _shaderName << " in " << m_currentShader <<" shader program \n";
+    std::cout<<"Warning: No shader named "<< _shaderName << " in " << m_currentShader.getString() <<" shader program \n";
   }
   return shaderPointer;
 }
@@ -292,7 +300,14 @@ void ShaderLib::compileShader( const std::string &_name  ) noexcept
   if(shader!=m_shaders.end())
   {
     // grab the pointer to the shader and call compile
-    shader->second->compile();
+    if(m_asyncCompile)
+    {
+      shader->second->submitCompile();
+    }
+    else
+    {
+      shader->second->compile();
+    }
   }
   else {std::cerr<<"Warning shader not know in compile "<<_name.c_str();}
 
@@ -302,7 +317,14 @@ void ShaderLib::createShaderProgram(const std::string &_name  ) noexcept
 {
   if(m_debugState)
     std::cerr<<"creating empty ShaderProgram "<<_name.c_str()<<"\n";
- m_shaderPrograms[_name]= new ShaderProgram(_name);
+ StringID id;
+ if(!StringID::intern(_name,id))
+ {
+   return;
+ }
+ ShaderProgram *program=new ShaderProgram(_name);
+ m_shaderPrograms[_name]=program;
+ m_programIDs[id]=program;
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::attachShaderToProgram( const std::string &_program, const std::string &_shader   ) noexcept
@@ -335,7 +357,12 @@ void ShaderLib::loadShaderSource(std::string _shaderName,	std::string _sourceFil
   // make sure we have a valid shader and program
   if(shader!=m_shaders.end() )
   {
-    shader->second->load(_sourceFile);
+    std::string source;
+    if(!m_preprocessor.loadFile(_sourceFile,source))
+    {
+      exit(EXIT_FAILURE);
+    }
+    shader->second->loadFromString(source);
   }
   else {std::cerr<<"Warning shader not know in loadShaderSource "<<_shaderName.c_str();}
 
@@ -418,54 +445,99 @@ bool ShaderLib::loadFromJson(const std::string &_fname)  noexcept
       std::cerr<<"ShaderProgram must have a name (or could be 0 length) \n";
       return false;
     }
-    createShaderProgram(progName);
+    // a program with features is a permutation set and its variants are built when first used
+    bool permuted=itr->value.HasMember("features");
+    if(permuted)
+    {
+      const rj::Value &features=itr->value["features"];
+      std::vector<std::string> featureNames;
+      for (rj::SizeType f = 0; f < features.Size(); f++)
+      {
+        featureNames.push_back(features[f].GetString());
+      }
+      if(!createShaderPermutations(progName,featureNames))
+      {
+        return false;
+      }
+    }
+    else
+    {
+      createShaderProgram(progName);
+    }
     const rj::Value& shaders = itr->value["Shaders"];
+    std::vector<std::string> shaderNames;
     for (rj::SizeType i = 0; i < shaders.Size(); i++)
     {
       const rj::Value &currentShader = shaders[i];
       const rj::Value::Ch *name=currentShader["name"].GetString();
       ShaderType shadertype=getShaderType(currentShader["type"].GetString());
 
-      attachShader(name,shadertype);
       const rj::Value& paths = currentShader["path"];
       std::string shaderSource;
       for (rj::SizeType p = 0; p < paths.Size(); p++)
       {
-        // load the shader sources in order.
-        std::ifstream source;
-        source.open(paths[p].GetString(), std::ios::in);
+        // load the shader sources in order expanding any #includes
         if(debug)
         {
           std::cout<<"attempting to load "<<paths[p].GetString()<<"\n";
         }
-        if (source.fail())
+        std::string f;
+        if (!m_preprocessor.loadFile(paths[p].GetString(),f))
         {
             std::cerr<<"error opening shader file\n";
             exit(EXIT_FAILURE);
         }
-        std::unique_ptr<std::string> f( new std::string((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>()));
         if(debug)
         {
-          std::cout<<"loaded data string \n"<< const_cast<char *>(f->c_str())<<"\n";
+          std::cout<<"loaded data string \n"<< f<<"\n";
         }
-        source.close();
-        shaderSource+=*f;
+        shaderSource+=f;
         shaderSource+="\n";
       }
-      loadShaderSourceFromString(name,shaderSource);
+      if(currentShader.HasMember("defines"))
+      {
+        const rj::Value &defines=currentShader["defines"];
+        std::vector<std::string> defineList;
+        for (rj::SizeType d = 0; d < defines.Size(); d++)
+        {
+          defineList.push_back(defines[d].GetString());
+        }
+        shaderSource=ShaderPreprocessor::injectDefines(shaderSource,defineList);
+      }
       if(debug)
       {
         std::cout<<"********* Final Shader String ***************\n";
         std::cout<<shaderSource<<"\n";
       }
-      compileShader(name);
+      if(permuted)
+      {
+        addPermutationStage(progName,shadertype,shaderSource);
+        continue;
+      }
+      attachShader(name,shadertype);
+      loadShaderSourceFromString(name,shaderSource);
+      shaderNames.push_back(name);
       attachShaderToProgram(progName,name);
     } // end parse shader loop
-    if(debug)
+    if(permuted)
     {
-      std::cout<<"Linking and registering Uniforms to ShaderLib\n";
+      std::cout<<"**********************DONE********************\n";
+      continue;
+    }
+    // a cached binary means none of the shaders need compiling
+    ShaderProgram *program=m_shaderPrograms[progName];
+    if(!linkFromCache(*program))
+    {
+      for(auto &name : shaderNames)
+      {
+        compileShader(name);
+      }
+      if(debug)
+      {
+        std::cout<<"Linking and registering Uniforms to ShaderLib\n";
+      }
+      linkAndCache(*program);
     }
-    linkProgramObject(progName);
     //autoRegisterUniforms(progName);
     std::cout<<"**********************DONE********************\n";
   }
@@ -497,28 +569,332 @@ void ShaderLib::linkProgramObject(const std::string &_name	) noexcept
   if(program!=m_shaderPrograms.end() )
   {
     std::cerr<<"Linking "<<_name.c_str()<<"\n";
-    program->second->link();
+    if(!linkFromCache(*program->second))
+    {
+      linkAndCache(*program->second);
+    }
   }
   else {std::cerr<<"Warning Program not known in link "<<_name.c_str();}
 
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderLib::setProgramCache(const std::string &_directory) noexcept
+{
+  m_programCache.reset();
+  if(_directory.empty())
+  {
+    return false;
+  }
+  if(!ProgramBinaryCache::isSupported())
+  {
+    std::cerr<<"Program binaries not supported, shaders will not be cached\n";
+    return false;
+  }
+  m_programCache.reset(new ProgramBinaryCache(_directory));
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderLib::linkFromCache(ShaderProgram &_program) noexcept
+{
+  return m_programCache && m_programCache->load(_program,m_programCache->getKey(_program));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::linkAndCache(ShaderProgram &_program) noexcept
+{
+  if(m_programCache)
+  {
+    m_programCache->prepare(_program);
+  }
+  if(m_asyncCompile)
+  {
+    // the key is got now as the sources could change before the link is finished
+    _program.submitLink();
+    PendingLink link{&_program,m_programCache != nullptr,m_programCache ? m_programCache->getKey(_program) : 0};
+    // a program linked again before the last link finished keeps one entry with the newest key
+    auto pending=std::find_if(m_pendingLinks.begin(),m_pendingLinks.end(),
+                              [&_program](const PendingLink &_p){return _p.program == &_program;});
+    if(pending != m_pendingLinks.end())
+    {
+      *pending=link;
+    }
+    else
+    {
+      m_pendingLinks.push_back(link);
+    }
+    return;
+  }
+  _program.link();
+  if(m_programCache)
+  {
+    m_programCache->save(_program,m_programCache->getKey(_program));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderLib::createShaderPermutations(const std::string &_name, const std::vector<std::string> &_features) noexcept
+{
+  if(_features.size() > 32)
+  {
+    std::cerr<<"Permutations "<<_name<<" has more than 32 features\n";
+    return false;
+  }
+  Permutations &permutations=m_permutations[_name];
+  permutations.features=_features;
+  permutations.stages.clear();
+  permutations.variants.clear();
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderLib::attachPermutationShader(const std::string &_name, ShaderType _type, const std::string &_sourceFile) noexcept
+{
+  std::string source;
+  if(!m_preprocessor.loadFile(_sourceFile,source))
+  {
+    return false;
+  }
+  return addPermutationStage(_name,_type,source);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderLib::addPermutationStage(const std::string &_name, ShaderType _type, const std::string &_source) noexcept
+{
+  auto permutations=m_permutations.find(_name);
+  if(permutations == m_permutations.end())
+  {
+    std::cerr<<"Warning permutations not known in attachPermutationShader "<<_name<<"\n";
+    return false;
+  }
+  permutations->second.stages.push_back({_type,_source});
+  permutations->second.variants.clear();
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t ShaderLib::getFeatureMask(const std::string &_name, const std::vector<std::string> &_features) const noexcept
+{
+  auto permutations=m_permutations.find(_name);
+  if(permutations == m_permutations.end())
+  {
+    std::cerr<<"Warning permutations not known in getFeatureMask "<<_name<<"\n";
+    return 0;
+  }
+  auto &names=permutations->second.features;
+  uint32_t mask=0;
+  for(auto &f : _features)
+  {
+    auto bit=std::find(names.begin(),names.end(),f);
+    if(bit == names.end())
+    {
+      std::cerr<<"Warning feature "<<f<<" not known in "<<_name<<"\n";
+      continue;
+    }
+    mask|=1u<<(bit-names.begin());
+  }
+  return mask;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::string ShaderLib::preparePermutation(const std::string &_name, uint32_t _features) noexcept
+{
+  auto permutations=m_permutations.find(_name);
+  if(permutations == m_permutations.end() || permutations->second.stages.empty())
+  {
+    std::cerr<<"Warning permutations not known or empty "<<_name<<"\n";
+    return std::string();
+  }
+  Permutations &p=permutations->second;
+  // bits past the last feature don't change the source so drop them from the key
+  _features&=static_cast<uint32_t>((uint64_t(1)<<p.features.size())-1);
+  auto variant=p.variants.find(_features);
+  if(variant != p.variants.end())
+  {
+    return variant->second;
+  }
+
+  std::vector<std::string> defines;
+  for(size_t i=0; i<p.features.size(); ++i)
+  {
+    if(_features & (1u<<i))
+    {
+      defines.push_back(p.features[i]);
+    }
+  }
+  // each stage is keyed by its type and preprocessed source, the program by its stages' keys
+  std::vector<std::string> shaderNames;
+  uint64_t programKey=ShaderPreprocessor::hash(std::string());
+  for(auto &stage : p.stages)
+  {
+    // a feature a stage never mentions can't change it so isn't defined, letting variants share it
+    std::vector<std::string> used;
+    for(auto &d : defines)
+    {
+      if(stage.second.find(d) != std::string::npos)
+      {
+        used.push_back(d);
+      }
+    }
+    std::string source=ShaderPreprocessor::injectDefines(stage.second,used);
+    uint64_t key=ShaderPreprocessor::hash(source,ShaderPreprocessor::hash(std::to_string(static_cast<int>(stage.first))));
+    programKey=ShaderPreprocessor::hash(fmt::format("{0:016x}",key),programKey);
+    auto shader=m_permutationShaders.find(key);
+    if(shader == m_permutationShaders.end())
+    {
+      std::string shaderName=fmt::format("{0}#{1:016x}",_name,key);
+      attachShader(shaderName,stage.first);
+      loadShaderSourceFromString(shaderName,source);
+      shader=m_permutationShaders.insert({key,shaderName}).first;
+    }
+    shaderNames.push_back(shader->second);
+  }
+
+  auto program=m_permutationPrograms.find(programKey);
+  if(program == m_permutationPrograms.end())
+  {
+    std::string programName=fmt::format("{0}#{1:x}",_name,_features);
+    createShaderProgram(programName);
+    for(auto &name : shaderNames)
+    {
+      attachShaderToProgram(programName,name);
+    }
+    // a cached binary means none of the shaders need compiling
+    ShaderProgram *shaderProgram=m_shaderPrograms[programName];
+    if(!linkFromCache(*shaderProgram))
+    {
+      for(auto &name : shaderNames)
+      {
+        Shader *shader=m_shaders[name];
+        if(!shader->isCompiled() && !shader->isCompilePending())
+        {
+          compileShader(name);
+        }
+      }
+      linkAndCache(*shaderProgram);
+    }
+    program=m_permutationPrograms.insert({programKey,programName}).first;
+  }
+  p.variants[_features]=program->second;
+  return program->second;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::usePermutation(const std::string &_name, uint32_t _features) noexcept
+{
+  std::string program=preparePermutation(_name,_features);
+  if(!program.empty())
+  {
+    use(program);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+ShaderProgram * ShaderLib::getPermutation(const std::string &_name, uint32_t _features) noexcept
+{
+  std::string program=preparePermutation(_name,_features);
+  if(program.empty())
+  {
+    return m_nullProgram;
+  }
+  return (*this)[program];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::setAsyncCompile(bool _state) noexcept
+{
+  m_asyncCompile=_state;
+#ifndef USINGIOS_
+  if(_state && GLEW_ARB_parallel_shader_compile)
+  {
+    // let the driver pick the number of compiler threads
+    glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+  }
+#endif
+  if(!_state)
+  {
+    finishCompiles();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::finishProgram(ShaderProgram *_program) noexcept
+{
+  if(_program->isLinkPending())
+  {
+    _program->finishLink();
+  }
+  // the link may already have been finished by ShaderProgram::use or finishLink so the entry
+  // is always removed here, otherwise finishCompiles would never see the list empty
+  auto pending=std::find_if(m_pendingLinks.begin(),m_pendingLinks.end(),
+                            [_program](const PendingLink &_p){return _p.program == _program;});
+  if(pending != m_pendingLinks.end())
+  {
+    if(pending->cache && m_programCache)
+    {
+      m_programCache->save(*_program,pending->key);
+    }
+    m_pendingLinks.erase(pending);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderLib::isCompileComplete() noexcept
+{
+  // copy as finishProgram removes entries
+  std::vector<PendingLink> pending=m_pendingLinks;
+  for(auto &p : pending)
+  {
+    if(p.program->isLinkComplete())
+    {
+      finishProgram(p.program);
+    }
+  }
+  return m_pendingLinks.empty();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::finishCompiles() noexcept
+{
+  while(!m_pendingLinks.empty())
+  {
+    finishProgram(m_pendingLinks.back().program);
+  }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::use( const std::string &_name  )  noexcept
 {
-  auto program=m_shaderPrograms.find(_name);
+  StringID id(_name);
+  if(m_programIDs.find(id) == m_programIDs.end())
+  {
+    // warn here as only the string has the name, then fall back to the null program
+    std::cerr<<"Warning Program not know in use "<<_name<<"\n";
+    id=StringID("NULL");
+  }
+  use(id);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::use( StringID _name  )  noexcept
+{
+  auto program=m_programIDs.find(_name);
   // make sure we have a valid  program
-  if(program!=m_shaderPrograms.end() )
+  if(program!=m_programIDs.end() )
   {
     //std::cerr<<"Shader manager Use\n";
     m_currentShader=_name;
+    m_currentProgram=program->second;
+    finishProgram(program->second);
     program->second->use();
   }
   else
   {
-    std::cerr<<"Warning Program not know in use "<<_name.c_str()<<"\n";
-    m_currentShader="NULL";
-    glUseProgram(0);
+    std::cerr<<"Warning Program not know in use "<<_name.getString()<<"\n";
+    m_currentShader=StringID("NULL");
+    m_currentProgram=m_nullProgram;
+    GLState::instance()->useProgram(0);
   }
 
 }
@@ -593,36 +969,39 @@ void ceckGLError( const std::string  &_file, const int _line  ) noexcept
 //----------------------------------------------------------------------------------------------------------------------
 ShaderProgram * ShaderLib::operator[](const std::string &_name  ) noexcept
 {
-  auto program=m_shaderPrograms.find(_name);
-  // make sure we have a valid  program
-  if(program!=m_shaderPrograms.end() )
-  {
-    m_currentShader=_name;
-    return  program->second;
-  }
-  else
+  StringID id(_name);
+  if(m_programIDs.find(id) == m_programIDs.end())
   {
-    std::cerr<<"Warning Program not know in [] "<<_name.c_str();
+    std::cerr<<"Warning Program not know in [] "<<_name;
     std::cerr<<"returning a null program and hoping for the best\n";
     return m_nullProgram;
   }
+  return (*this)[id];
 }
 
 
 //----------------------------------------------------------------------------------------------------------------------
 ShaderProgram * ShaderLib::operator[]( const char *_name ) noexcept
 {
-  auto program=m_shaderPrograms.find(_name);
+  return (*this)[std::string(_name)];
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+ShaderProgram * ShaderLib::operator[]( StringID _name ) noexcept
+{
+  auto program=m_programIDs.find(_name);
   // make sure we have a valid  program
-  if(program!=m_shaderPrograms.end() )
+  if(program!=m_programIDs.end() )
   {
     m_currentShader=_name;
-
+    m_currentProgram=program->second;
+    finishProgram(program->second);
     return  program->second;
   }
   else
   {
-    std::cerr<<"Warning Program not know in [] "<<_name;
+    std::cerr<<"Warning Program not know in [] "<<_name.getString();
     std::cerr<<"returning a null program and hoping for the best\n";
     return m_nullProgram;
   }
@@ -631,7 +1010,8 @@ ShaderProgram * ShaderLib::operator[]( const char *_name ) noexcept
 
 void ShaderLib::useNullProgram() noexcept
 {
-  m_currentShader="NULL";
+  m_currentShader=StringID("NULL");
+  m_currentProgram=m_nullProgram;
   m_nullProgram->use();
 }
 
@@ -642,9 +1022,9 @@ GLuint ShaderLib::getUniformBlockIndex( const std::string &_uniformBlockName  )
   GLuint id=0;
 
   // get an iterator to the shaders
-  auto shader=m_shaderPrograms.find(m_currentShader);
+  auto shader=m_programIDs.find(m_currentShader);
   // make sure we have a valid shader
-  if(shader!=m_shaderPrograms.end())
+  if(shader!=m_programIDs.end())
   {
     // grab the pointer to the shader and call compile
     id=shader->second->getUniformBlockIndex(_uniformBlockName);
@@ -781,17 +1161,17 @@ void ShaderLib::printRegisteredUniforms(const std::string &_shader) const  noexc
 void ShaderLib::printProperties() const noexcept
 {
 
-  auto program=m_shaderPrograms.find(m_currentShader);
+  auto program=m_programIDs.find(m_currentShader);
   // make sure we have a valid  program
-  if(program!=m_shaderPrograms.end() )
+  if(program!=m_programIDs.end() )
   {
     std::cerr<<"_______________________________________________________________________________________________________________________\n";
-    std::cerr<<"Printing Properties for ShaderProgram "<<m_currentShader<<"\n";
+    std::cerr<<"Printing Properties for ShaderProgram "<<m_currentShader.getString()<<"\n";
     std::cerr<<"_______________________________________________________________________________________________________________________\n";
     program->second->printProperties();
     std::cerr<<"_______________________________________________________________________________________________________________________\n";
   }
-  else {std::cerr<<"Warning no currently active shader to print properties for "<<m_currentShader<<"\n";}
+  else {std::cerr<<"Warning no currently active shader to print properties for "<<m_currentShader.getString()<<"\n";}
 
 
 
@@ -801,130 +1181,130 @@ void ShaderLib::printProperties() const noexcept
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform1f(_paramName.c_str(),_v0);
+  m_currentProgram->setUniform1f(_paramName.c_str(),_v0);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1f(_paramName.c_str(),_v0);
+  m_currentProgram->setRegisteredUniform1f(_paramName.c_str(),_v0);
 
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0,Real _v1) noexcept
 {
-  (*this)[m_currentShader]->setUniform2f(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setUniform2f(_paramName.c_str(),_v0,_v1);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0,Real _v1) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setRegisteredUniform2f(_paramName.c_str(),_v0,_v1);
 
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2) noexcept
 {
-  (*this)[m_currentShader]->setUniform3f(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setUniform3f(_paramName.c_str(),_v0,_v1,_v2);
 
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setRegisteredUniform3f(_paramName.c_str(),_v0,_v1,_v2);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2,Real _v3) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2,Real _v3) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform1i(_paramName.c_str(),_v0);
+  m_currentProgram->setUniform1i(_paramName.c_str(),_v0);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1i(_paramName.c_str(),_v0);
+  m_currentProgram->setRegisteredUniform1i(_paramName.c_str(),_v0);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0,GLint _v1) noexcept
 {
-  (*this)[m_currentShader]->setUniform2i(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setUniform2i(_paramName.c_str(),_v0,_v1);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0,GLint _v1) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2i(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setRegisteredUniform2i(_paramName.c_str(),_v0,_v1);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2) noexcept
 {
-  (*this)[m_currentShader]->setUniform3i(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setUniform3i(_paramName.c_str(),_v0,_v1,_v2);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3i(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setRegisteredUniform3i(_paramName.c_str(),_v0,_v1,_v2);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2,GLint _v3) noexcept
 {
-  (*this)[m_currentShader]->setUniform4i(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setUniform4i(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2,GLint _v3) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Colour _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Colour _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
 }
 void ShaderLib::setUniform(const std::string &_paramName,Vec2 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
+  m_currentProgram->setUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Vec2 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
+  m_currentProgram->setRegisteredUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
 }
 void ShaderLib::setUniform(const std::string &_paramName,Vec3 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
+  m_currentProgram->setUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Vec3 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
+  m_currentProgram->setRegisteredUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
 }
 void ShaderLib::setUniform(const std::string &_paramName,Vec4 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Vec4 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Mat3 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,_v0.openGL());
+  m_currentProgram->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,_v0.openGL());
 
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Mat3 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,_v0.openGL());
+  m_currentProgram->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,_v0.openGL());
 
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Mat4 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,_v0.openGL());
+  m_currentProgram->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,_v0.openGL());
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Mat4 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix4fv(_paramName,1,GL_FALSE,_v0.openGL());
+  m_currentProgram->setRegisteredUniformMatrix4fv(_paramName,1,GL_FALSE,_v0.openGL());
 }
 
 
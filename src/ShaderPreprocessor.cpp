@@ -0,0 +1,261 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ShaderPreprocessor.h"
+#include "fmt/format.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ShaderPreprocessor.cpp
+/// @brief implementation files for ShaderPreprocessor class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+namespace
+{
+  bool readFile(const std::string &_fname, std::string &o_source)
+  {
+    std::ifstream file(_fname.c_str(),std::ios::in);
+    if(!file.is_open())
+    {
+      return false;
+    }
+    o_source.assign(std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>());
+    return true;
+  }
+
+  std::string directoryOf(const std::string &_fname)
+  {
+    size_t slash=_fname.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : _fname.substr(0,slash);
+  }
+
+  // if the line is a preprocessor directive starting with _directive return the position after it
+  size_t matchDirective(const std::string &_line, const char *_directive)
+  {
+    size_t pos=_line.find_first_not_of(" \t");
+    if(pos == std::string::npos || _line[pos] != '#')
+    {
+      return std::string::npos;
+    }
+    pos=_line.find_first_not_of(" \t",pos+1);
+    size_t length=strlen(_directive);
+    if(pos == std::string::npos || _line.compare(pos,length,_directive) != 0)
+    {
+      return std::string::npos;
+    }
+    return pos+length;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderPreprocessor::addIncludePath(const std::string &_path)
+{
+  if(std::find(m_includePaths.begin(),m_includePaths.end(),_path) == m_includePaths.end())
+  {
+    m_includePaths.push_back(_path);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderPreprocessor::loadFile(const std::string &_fname, std::string &o_source)
+{
+  m_files.assign(1,_fname);
+  std::string source;
+  if(!readFile(_fname,source))
+  {
+    std::cerr<<"File not found "<<_fname<<"\n";
+    return false;
+  }
+  std::vector<std::string> stack(1,_fname);
+  o_source.clear();
+  return expand(source,directoryOf(_fname),0,stack,o_source);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderPreprocessor::process(const std::string &_source, const std::string &_directory, std::string &o_source)
+{
+  m_files.assign(1,std::string());
+  std::vector<std::string> stack;
+  o_source.clear();
+  return expand(_source,_directory,0,stack,o_source);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::string ShaderPreprocessor::resolve(const std::string &_name, const std::string &_directory) const
+{
+  std::vector<std::string> candidates;
+  if(!_name.empty() && _name[0] == '/')
+  {
+    candidates.push_back(_name);
+  }
+  else
+  {
+    candidates.push_back(_directory.empty() ? _name : _directory+"/"+_name);
+    for(auto &path : m_includePaths)
+    {
+      candidates.push_back(path+"/"+_name);
+    }
+  }
+  for(auto &c : candidates)
+  {
+    std::ifstream file(c.c_str(),std::ios::in);
+    if(file.is_open())
+    {
+      return c;
+    }
+  }
+  return std::string();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderPreprocessor::expand(const std::string &_source, const std::string &_directory, size_t _fileIndex,
+                                std::vector<std::string> &_stack, std::string &o_source)
+{
+  size_t lineNumber=0;
+  size_t start=0;
+  while(start < _source.size())
+  {
+    size_t end=_source.find('\n',start);
+    bool newline=end != std::string::npos;
+    if(!newline)
+    {
+      end=_source.size();
+    }
+    std::string line=_source.substr(start,end-start);
+    start=end+1;
+    ++lineNumber;
+
+    size_t pos=matchDirective(line,"include");
+    if(pos == std::string::npos)
+    {
+      o_source+=line;
+      if(newline)
+      {
+        o_source+='\n';
+      }
+      continue;
+    }
+
+    pos=line.find_first_not_of(" \t",pos);
+    char close=(pos != std::string::npos && line[pos] == '<') ? '>' : '"';
+    size_t nameEnd=pos == std::string::npos ? pos : line.find(close,pos+1);
+    if(nameEnd == std::string::npos || (line[pos] != '"' && line[pos] != '<'))
+    {
+      std::cerr<<"badly formed #include in "<<m_files[_fileIndex]<<" line "<<lineNumber<<"\n";
+      return false;
+    }
+    std::string name=line.substr(pos+1,nameEnd-pos-1);
+    std::string path=resolve(name,_directory);
+    if(path.empty())
+    {
+      std::cerr<<"unable to find include "<<name<<" from "<<m_files[_fileIndex]<<" line "<<lineNumber<<"\n";
+      return false;
+    }
+    if(std::find(_stack.begin(),_stack.end(),path) != _stack.end())
+    {
+      std::cerr<<"include loop, "<<path<<" includes itself\n";
+      return false;
+    }
+    std::string included;
+    if(!readFile(path,included))
+    {
+      std::cerr<<"unable to read include "<<path<<"\n";
+      return false;
+    }
+
+    size_t index=m_files.size();
+    m_files.push_back(path);
+    _stack.push_back(path);
+    o_source+=fmt::format("#line 1 {0}\n",index);
+    if(!expand(included,directoryOf(path),index,_stack,o_source))
+    {
+      return false;
+    }
+    _stack.pop_back();
+    if(!o_source.empty() && o_source.back() != '\n')
+    {
+      o_source+='\n';
+    }
+    // carry on from the line after the include in this file
+    o_source+=fmt::format("#line {0} {1}\n",lineNumber+1,_fileIndex);
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::string ShaderPreprocessor::injectDefines(const std::string &_source, const std::vector<std::string> &_defines)
+{
+  if(_defines.empty())
+  {
+    return _source;
+  }
+  std::string defines;
+  for(auto &d : _defines)
+  {
+    size_t equals=d.find('=');
+    if(equals == std::string::npos)
+    {
+      defines+=fmt::format("#define {0} 1\n",d);
+    }
+    else
+    {
+      defines+=fmt::format("#define {0} {1}\n",d.substr(0,equals),d.substr(equals+1));
+    }
+  }
+
+  // #version has to come first so the defines go after it
+  size_t lineNumber=0;
+  size_t start=0;
+  while(start < _source.size())
+  {
+    size_t end=_source.find('\n',start);
+    if(end == std::string::npos)
+    {
+      end=_source.size();
+    }
+    ++lineNumber;
+    if(matchDirective(_source.substr(start,end-start),"version") != std::string::npos)
+    {
+      std::string result=_source.substr(0,end);
+      result+='\n';
+      result+=defines;
+      result+=fmt::format("#line {0}\n",lineNumber+1);
+      if(end < _source.size())
+      {
+        result.append(_source,end+1,std::string::npos);
+      }
+      return result;
+    }
+    start=end+1;
+  }
+  return defines+"#line 1\n"+_source;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint64_t ShaderPreprocessor::hashBytes(const void *_data, size_t _size, uint64_t _hash) noexcept
+{
+  const unsigned char *bytes=static_cast<const unsigned char *>(_data);
+  for(size_t i=0; i<_size; ++i)
+  {
+    _hash=(_hash ^ bytes[i])*1099511628211ull;
+  }
+  return _hash;
+}
+
+} // end ngl namespace
@@ -20,10 +20,18 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "ShaderProgram.h"
+#include "CPUProfiler.h"
+#include "FrameStats.h"
+#include "GLState.h"
 #include "fmt/format.h"
 
 namespace ngl
 {
+constexpr size_t UniformShadow::MAXSIZE;
+bool UniformShadow::s_enabled=true;
+uint64_t UniformShadow::s_issued=0;
+uint64_t UniformShadow::s_skipped=0;
+
 //----------------------------------------------------------------------------------------------------------------------
 ShaderProgram::ShaderProgram(std::string _name) noexcept
 {
@@ -46,13 +54,14 @@ if (_name !="NULL")
 ShaderProgram::~ShaderProgram()
 {
   std::cerr<<"removing ShaderProgram "<< m_programName<<"\n";
-  glDeleteProgram(m_programID);
+  GLState::instance()->deleteProgram(m_programID);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::use() noexcept
 {
+  finishLink();
  // std::cerr<<"Using shader "<<m_programName<<" id "<<m_programID<<"\n";
-  glUseProgram(m_programID);
+  GLState::instance()->useProgram(m_programID);
   //NGLCheckGLError(__FILE__,__LINE__);
   m_active=true;
 }
@@ -61,7 +70,7 @@ void ShaderProgram::use() noexcept
 void ShaderProgram::unbind() noexcept
 {
   m_active=false;
-  glUseProgram(0);
+  GLState::instance()->useProgram(0);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -101,7 +110,47 @@ void ShaderProgram::bindFragDataLocation(GLuint _index, const std::string &_attr
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::link() noexcept
 {
+  submitLink();
+  finishLink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderProgram::submitLink() noexcept
+{
+  NGL_PROFILE_SCOPE("ShaderProgram::submitLink");
   glLinkProgram(m_programID);
+  m_linkPending=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::isLinkComplete() const noexcept
+{
+#ifndef USINGIOS_
+  if(m_linkPending && GLEW_ARB_parallel_shader_compile)
+  {
+    // the link can't complete before the compiles so this covers them too
+    GLint complete=GL_TRUE;
+    glGetProgramiv(m_programID,GL_COMPLETION_STATUS_ARB,&complete);
+    return complete == GL_TRUE;
+  }
+#endif
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderProgram::finishLink() noexcept
+{
+  NGL_PROFILE_SCOPE("ShaderProgram::finishLink");
+  if(!m_linkPending)
+  {
+    return;
+  }
+  m_linkPending=false;
+  // a compile error is clearer than the link error it causes
+  for(auto shader : m_shaders)
+  {
+    shader->checkCompileStatus();
+  }
   if(m_debugState==true)
   {
     std::cerr <<"linking Shader "<< m_programName.c_str()<<"\n";
@@ -128,7 +177,7 @@ void ShaderProgram::link() noexcept
   }
 
   m_linked=true;
-  glUseProgram(m_programID);
+  GLState::instance()->useProgram(m_programID);
   autoRegisterUniforms();
 
 }
@@ -156,6 +205,26 @@ GLint ShaderProgram::getUniformLocation(const char* _name   ) const noexcept
   return -1;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+GLint ShaderProgram::uploadLocation(const std::string &_name, const void *_data, size_t _size, bool _warn) const noexcept
+{
+  auto uniform=m_registeredUniforms.find(_name);
+  if(uniform==m_registeredUniforms.end())
+  {
+    if(_warn)
+    {
+      std::cerr<<"Uniform \""<<_name<<"\" not found in Program \""<<m_programName<<"\"\n";
+    }
+    return -1;
+  }
+  if(!uniform->second.shadow.update(_data,_size))
+  {
+    return -1;
+  }
+  FrameStats::instance()->add(FrameStats::UNIFORMUPLOADS);
+  return uniform->second.loc;
+}
+
 void ShaderProgram::printProperties() const noexcept
 {
   printActiveUniforms();
@@ -220,35 +289,45 @@ void ShaderProgram::printActiveAttributes() const noexcept
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform1f( const char* _varname,  float _v0  ) const noexcept
 {
-  glUniform1f(getUniformLocation(_varname),_v0);
+  const float v[]={_v0};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform1f(loc,_v0);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform1f( const std::string &_varname, float _v0    ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float v[]={_v0};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform1f(uniform->second.loc,_v0);
+    glUniform1f(loc,_v0);
   }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform2f(const char* _varname, float _v0, float _v1 ) const noexcept
 {
-  glUniform2f(getUniformLocation(_varname),_v0,_v1);
+  const float v[]={_v0,_v1};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform2f(loc,_v0,_v1);
+  }
 }
 
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform2f(const std::string &_varname, float _v0, float _v1 ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float v[]={_v0,_v1};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform2f(uniform->second.loc,_v0,_v1);
+    glUniform2f(loc,_v0,_v1);
   }
 
 }
@@ -256,16 +335,21 @@ void ShaderProgram::setRegisteredUniform2f(const std::string &_varname, float _v
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform3f(const char* _varname, float _v0,  float _v1, float _v2  ) const noexcept
 {
-  glUniform3f(getUniformLocation(_varname),_v0,_v1,_v2);
+  const float v[]={_v0,_v1,_v2};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform3f(loc,_v0,_v1,_v2);
+  }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform3f( const std::string &_varname, float _v0, float _v1, float _v2  ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float v[]={_v0,_v1,_v2};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform3f(uniform->second.loc,_v0,_v1,_v2);
+    glUniform3f(loc,_v0,_v1,_v2);
   }
 
 }
@@ -273,16 +357,21 @@ void ShaderProgram::setRegisteredUniform3f( const std::string &_varname, float _
 void ShaderProgram::setUniform4f( const char* _varname, float _v0,float _v1,  float _v2, float _v3 ) const noexcept
 {
 
-  glUniform4f(getUniformLocation(_varname),_v0,_v1,_v2,_v3);
+  const float v[]={_v0,_v1,_v2,_v3};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform4f(loc,_v0,_v1,_v2,_v3);
+  }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform4f( const std::string &_varname, float _v0, float _v1,  float _v2, float _v3  ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float v[]={_v0,_v1,_v2,_v3};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform4f(uniform->second.loc,_v0,_v1,_v2,_v3);
+    glUniform4f(loc,_v0,_v1,_v2,_v3);
   }
 
 }
@@ -290,25 +379,41 @@ void ShaderProgram::setRegisteredUniform4f( const std::string &_varname, float _
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform1fv(const char* _varname,  size_t _count,  const float* _value ) const noexcept
 {
-  glUniform1fv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*1*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniform1fv(loc,_count,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform2fv(const char* _varname,  size_t _count,  const float* _value ) const noexcept
 {
-  glUniform2fv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*2*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniform2fv(loc,_count,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform3fv( const char* _varname, size_t _count, const float* _value  ) const noexcept
 {
-  glUniform3fv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*3*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniform3fv(loc,_count,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform4fv(const char* _varname,size_t _count, const float* _value  ) const noexcept
 {
-  glUniform4fv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*4*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniform4fv(loc,_count,_value);
+  }
 
 }
 
@@ -316,18 +421,23 @@ void ShaderProgram::setUniform4fv(const char* _varname,size_t _count, const floa
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform1i( const char* _varname, GLint _v0 ) const noexcept
 {
-  glUniform1i(getUniformLocation(_varname),_v0);
+  const GLint v[]={_v0};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform1i(loc,_v0);
+  }
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform1i( const std::string &_varname, int _v0  ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint v[]={_v0};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform1i(uniform->second.loc,_v0);
+    glUniform1i(loc,_v0);
   }
 
 }
@@ -335,11 +445,11 @@ void ShaderProgram::setRegisteredUniform1i( const std::string &_varname, int _v0
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform2i( const std::string &_varname, int _v0, int _v1   ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint v[]={_v0,_v1};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform2i(uniform->second.loc,_v0,_v1);
+    glUniform2i(loc,_v0,_v1);
   }
 
 }
@@ -348,77 +458,116 @@ void ShaderProgram::setRegisteredUniform2i( const std::string &_varname, int _v0
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform3i(const std::string &_varname,  int _v0,   int _v1,  int _v2   ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint v[]={_v0,_v1,_v2};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform3i(uniform->second.loc,_v0,_v1,_v2);
+    glUniform3i(loc,_v0,_v1,_v2);
   }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniform4i( const std::string &_varname,  int _v0,   int _v1, int _v2,  int _v3  ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint v[]={_v0,_v1,_v2,_v3};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),false);
+  if(loc!=-1)
   {
-    glUniform4i(uniform->second.loc,_v0,_v1,_v2,_v3);
+    glUniform4i(loc,_v0,_v1,_v2,_v3);
   }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform2i( const char* _varname,  GLint _v0,  GLint _v1 ) const noexcept
 {
-  glUniform2i(getUniformLocation(_varname),_v0,_v1);
+  const GLint v[]={_v0,_v1};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform2i(loc,_v0,_v1);
+  }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform3i( const char* _varname, GLint _v0,  GLint _v1,   GLint _v2  ) const noexcept
 {
-  glUniform3i(getUniformLocation(_varname),_v0,_v1,_v2);
+  const GLint v[]={_v0,_v1,_v2};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform3i(loc,_v0,_v1,_v2);
+  }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform4i( const char* _varname,   GLint _v0,GLint _v1,   GLint _v2, GLint _v3  ) const noexcept
 {
-  glUniform4i(getUniformLocation(_varname),_v0,_v1,_v2,_v3);
+  const GLint v[]={_v0,_v1,_v2,_v3};
+  GLint loc=uploadLocation(_varname,v,sizeof(v),true);
+  if(loc!=-1)
+  {
+    glUniform4i(loc,_v0,_v1,_v2,_v3);
+  }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform1iv( const char* _varname, size_t _count,  const GLint* _value ) const noexcept
 {
-  glUniform1iv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*1*sizeof(GLint),true);
+  if(loc!=-1)
+  {
+    glUniform1iv(loc,_count,_value);
+  }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform2iv( const char* _varname, size_t _count, const GLint* _value   ) const noexcept
 {
-  glUniform2iv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*2*sizeof(GLint),true);
+  if(loc!=-1)
+  {
+    glUniform2iv(loc,_count,_value);
+  }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform3iv( const char* _varname,size_t _count, const GLint* _value ) const noexcept
 {
-  glUniform3iv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*3*sizeof(GLint),true);
+  if(loc!=-1)
+  {
+    glUniform3iv(loc,_count,_value);
+  }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniform4iv(const char* _varname, size_t _count,const GLint* _value  ) const noexcept
 {
-  glUniform4iv(getUniformLocation(_varname),_count,_value);
+  GLint loc=uploadLocation(_varname,_value,_count*4*sizeof(GLint),true);
+  if(loc!=-1)
+  {
+    glUniform4iv(loc,_count,_value);
+  }
 }
 
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix2fv(const char* _varname,size_t _count, bool _transpose,const float* _value ) const noexcept
 {
-  glUniformMatrix2fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*2*2*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix2fv(loc,_count,_transpose,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix3fv( const char* _varname, size_t _count,bool _transpose, const float* _value ) const noexcept
 {
-  glUniformMatrix3fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*3*3*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix3fv(loc,_count,_transpose,_value);
+  }
 
 }
 
@@ -426,29 +575,31 @@ void ShaderProgram::setUniformMatrix3fv( const char* _varname, size_t _count,boo
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniformMatrix3fv( const std::string &_varname,size_t _count, bool _transpose,const float* _value) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*3*3*sizeof(float),false);
+  if(loc!=-1)
   {
-    glUniformMatrix3fv(uniform->second.loc,_count,_transpose,_value);
+    glUniformMatrix3fv(loc,_count,_transpose,_value);
   }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix4fv(const char* _varname, size_t _count, bool _transpose, const float* _value ) const noexcept
 {
-  glUniformMatrix4fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*4*4*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix4fv(loc,_count,_transpose,_value);
+  }
 }
 
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setRegisteredUniformMatrix4fv(const std::string &_varname, size_t _count, bool _transpose,  const float* _value ) const noexcept
 {
-  auto uniform=m_registeredUniforms.find(_varname);
-  // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*4*4*sizeof(float),false);
+  if(loc!=-1)
   {
-    glUniformMatrix4fv(uniform->second.loc,_count,_transpose,_value);
+    glUniformMatrix4fv(loc,_count,_transpose,_value);
   }
 
 }
@@ -459,39 +610,63 @@ void ShaderProgram::setRegisteredUniformMatrix4fv(const std::string &_varname, s
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix2x3fv(const char* _varname,size_t _count,bool _transpose, const float* _value  ) const noexcept
 {
-  glUniformMatrix2x3fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*2*3*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix2x3fv(loc,_count,_transpose,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix2x4fv(const char* _varname, size_t _count,bool _transpose,const float* _value) const noexcept
 {
-  glUniformMatrix2x4fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*2*4*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix2x4fv(loc,_count,_transpose,_value);
+  }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix3x2fv(const char* _varname,size_t _count,bool _transpose,const float* _value ) const noexcept
 {
-  glUniformMatrix3x2fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*3*2*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix3x2fv(loc,_count,_transpose,_value);
+  }
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix3x4fv(const char* _varname,size_t _count,bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix3x4fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*3*4*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix3x4fv(loc,_count,_transpose,_value);
+  }
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix4x2fv(const char* _varname,size_t _count,bool _transpose,const float* _value ) const noexcept
 {
-  glUniformMatrix4x2fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*4*2*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix4x2fv(loc,_count,_transpose,_value);
+  }
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::setUniformMatrix4x3fv(const char* _varname,size_t _count,bool _transpose,const float* _value) const noexcept
 {
-  glUniformMatrix4x3fv(getUniformLocation(_varname),_count,_transpose,_value);
+  GLint loc=uploadLocation(_varname,_transpose ? nullptr : _value,_count*4*3*sizeof(float),true);
+  if(loc!=-1)
+  {
+    glUniformMatrix4x3fv(loc,_count,_transpose,_value);
+  }
 
 }
 
@@ -543,6 +718,19 @@ GLuint ShaderProgram::getUniformBlockIndex( const std::string &_uniformBlockName
   return glGetUniformBlockIndex(m_programID,_uniformBlockName.c_str());
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::setUniformBlockBinding(const std::string &_uniformBlockName, GLuint _bindingPoint) const noexcept
+{
+  GLuint index=glGetUniformBlockIndex(m_programID,_uniformBlockName.c_str());
+  if(index == GL_INVALID_INDEX)
+  {
+    std::cerr<<"Uniform block \""<<_uniformBlockName<<"\" not found in Program \""<<m_programName<<"\"\n";
+    return false;
+  }
+  glUniformBlockBinding(m_programID,index,_bindingPoint);
+  return true;
+}
+
 
 void ShaderProgram::autoRegisterUniforms() noexcept
 {
@@ -568,6 +756,7 @@ void ShaderProgram::autoRegisterUniforms() noexcept
       data.name=name;
       data.loc=glGetUniformLocation(m_programID,name);
       data.type=type;
+      data.shadow=UniformShadow();
       m_registeredUniforms[name]=data;
     }
     else
@@ -582,10 +771,55 @@ void ShaderProgram::autoRegisterUniforms() noexcept
         data.name=name;
         data.loc=glGetUniformLocation(m_programID,name.c_str());
         data.type=type;
+        // an array set through an earlier element can change this one so it can't be shadowed
+        data.shadow=UniformShadow(false);
         m_registeredUniforms[name]=data;
       }
     }
   }
+  buildUniformHashes();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderProgram::buildUniformHashes() noexcept
+{
+  // index by hash as well, a collision is marked with nullptr so those names fall back to the string lookup
+  m_uniformHashes.clear();
+  for(auto &u : m_registeredUniforms)
+  {
+    uint32_t hash=hashUniformName(u.first.c_str());
+    auto found=m_uniformHashes.find(hash);
+    if(found==m_uniformHashes.end())
+    {
+      m_uniformHashes[hash]=&u.second;
+    }
+    else
+    {
+      found->second=nullptr;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const ShaderProgram::uniformData *ShaderProgram::findUniform(const std::string &_name) const noexcept
+{
+  auto uniform=m_registeredUniforms.find(_name);
+  return uniform!=m_registeredUniforms.end() ? &uniform->second : nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const ShaderProgram::uniformData *ShaderProgram::findUniform(const UniformName &_name) const noexcept
+{
+  auto uniform=m_uniformHashes.find(_name.m_hash);
+  if(uniform==m_uniformHashes.end())
+  {
+    return nullptr;
+  }
+  if(uniform->second!=nullptr && uniform->second->name==_name.m_name)
+  {
+    return uniform->second;
+  }
+  return findUniform(std::string(_name.m_name));
 }
 
 void ShaderProgram::printRegisteredUniforms() const noexcept
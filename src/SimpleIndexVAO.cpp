@@ -1,7 +1,12 @@
 #include "SimpleIndexVAO.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include <iostream>
 namespace ngl
 {
+using namespace dispatch;
   SimpleIndexVAO::~SimpleIndexVAO()
   {
     removeVAO();
@@ -18,6 +23,21 @@ namespace ngl
       std::cerr<<"Warning trying to draw an unbound VOA\n";
     }
     glDrawElements(m_mode,static_cast<GLsizei>(m_indicesCount),m_indexType,static_cast<GLvoid *>(nullptr));
+    FrameStats::instance()->addDraw(m_mode,m_indicesCount);
+  }
+
+  void SimpleIndexVAO::drawInstanced(unsigned int _instances) const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    glDrawElementsInstanced(m_mode,static_cast<GLsizei>(m_indicesCount),m_indexType,static_cast<GLvoid *>(nullptr),static_cast<GLsizei>(_instances));
+    FrameStats::instance()->addDraw(m_mode,m_indicesCount,_instances);
   }
 
   void SimpleIndexVAO::removeVAO()
@@ -28,9 +48,10 @@ namespace ngl
     }
     if( m_allocated ==true)
     {
-        glDeleteBuffers(1,&m_buffer);
+        GLState::instance()->deleteBuffers(1,&m_buffer);
     }
-    glDeleteVertexArrays(1,&m_id);
+    GLState::instance()->deleteVertexArrays(1,&m_id);
+    ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
     m_allocated=false;
     }
 
@@ -50,8 +71,10 @@ namespace ngl
     glGenBuffers(1, &iboID);
 
     // now we will bind an array buffer to the first one and load the data for the verts
-    glBindBuffer(GL_ARRAY_BUFFER, vboID);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, vboID);
     glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(data.m_size), &data.m_data, data.m_mode);
+    FrameStats::instance()->addBufferUpload(data.m_size);
+    ResourceTracker::instance()->track(ResourceTracker::BUFFER,this,data.m_size,"SimpleIndexVAO");
     // we need to determine the size of the data type before we set it
     // in default to a ushort
     int size=sizeof(GLushort);
@@ -63,8 +86,10 @@ namespace ngl
       default : std::cerr<<"wrong data type send for index value\n"; break;
     }
     // now for the indices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
+    GLState::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.m_indexSize * static_cast<GLsizeiptr>(size), const_cast<GLvoid *>(data.m_indexData),data.m_mode);
+    FrameStats::instance()->addBufferUpload(data.m_indexSize*static_cast<size_t>(size));
+    ResourceTracker::instance()->add(ResourceTracker::BUFFER,this,data.m_indexSize*static_cast<size_t>(size));
 
     m_allocated=true;
     m_indexType=data.m_indexType;
@@ -1,7 +1,12 @@
 #include "SimpleVAO.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include <iostream>
 namespace ngl
 {
+using namespace dispatch;
   SimpleVAO::~SimpleVAO()
   {
     removeVAO();
@@ -18,6 +23,7 @@ namespace ngl
       std::cerr<<"Warning trying to draw an unbound VOA\n";
     }
     glDrawArrays(m_mode, 0, static_cast<GLsizei>(m_indicesCount));
+    FrameStats::instance()->addDraw(m_mode,m_indicesCount);
   }
 
   void SimpleVAO::removeVAO()
@@ -28,9 +34,10 @@ namespace ngl
     }
     if( m_allocated ==true)
     {
-        glDeleteBuffers(1,&m_buffer);
+        GLState::instance()->deleteBuffers(1,&m_buffer);
     }
-    glDeleteVertexArrays(1,&m_id);
+    GLState::instance()->deleteVertexArrays(1,&m_id);
+    ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
     m_allocated=false;
     }
 
@@ -42,13 +49,15 @@ namespace ngl
     }
     if( m_allocated ==true)
     {
-        glDeleteBuffers(1,&m_buffer);
+        GLState::instance()->deleteBuffers(1,&m_buffer);
     }
 
     glGenBuffers(1, &m_buffer);
     // now we will bind an array buffer to the first one and load the data for the verts
-    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer);
     glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>( _data.m_size), &_data.m_data, _data.m_mode);
+    FrameStats::instance()->addBufferUpload(_data.m_size);
+    ResourceTracker::instance()->track(ResourceTracker::BUFFER,this,_data.m_size,"SimpleVAO");
     m_allocated=true;
 
   }
@@ -0,0 +1,168 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "SpatialHashGrid.h"
+#include "ParallelFor.h"
+#include "Util.h"
+#include "NGLassert.h"
+#include <algorithm>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SpatialHashGrid.cpp
+/// @brief implementation files for SpatialHashGrid class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+SpatialHashGrid::SpatialHashGrid(Real _cellSize) noexcept
+{
+  setCellSize(_cellSize);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SpatialHashGrid::setCellSize(Real _cellSize) noexcept
+{
+  NGL_ASSERT(_cellSize > 0.0f);
+  m_cellSize=_cellSize;
+  m_invCellSize=1.0f/_cellSize;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SpatialHashGrid::build(const Vec3 *_pos, size_t _size)
+{
+  buildImpl(_size,[_pos](size_t _i, Real &o_x, Real &o_y, Real &o_z)
+  {
+    o_x=_pos[_i].m_x;
+    o_y=_pos[_i].m_y;
+    o_z=_pos[_i].m_z;
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SpatialHashGrid::build(const Real *_x, const Real *_y, const Real *_z, size_t _size)
+{
+  buildImpl(_size,[_x,_y,_z](size_t _i, Real &o_x, Real &o_y, Real &o_z)
+  {
+    o_x=_x[_i];
+    o_y=_y[_i];
+    o_z=_z[_i];
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Getter>
+void SpatialHashGrid::buildImpl(size_t _size, const Getter &_get)
+{
+  // keep the table at least as big as the number of points to keep collisions low
+  unsigned int tableSize=nextPow2(static_cast<unsigned int>(std::max<size_t>(_size,64)));
+  m_tableMask=tableSize-1;
+  m_hash.resize(_size);
+  m_cellStart.resize(tableSize+1);
+  m_sortedIndex.resize(_size);
+  m_sortedX.resize(_size);
+  m_sortedY.resize(_size);
+  m_sortedZ.resize(_size);
+  if(_size == 0)
+  {
+    std::fill(m_cellStart.begin(),m_cellStart.end(),0u);
+    return;
+  }
+  // pass 1 hash every point
+  parallelFor(0,_size,[this,&_get](size_t _b, size_t _e)
+  {
+    for(size_t i=_b; i<_e; ++i)
+    {
+      Real x,y,z;
+      _get(i,x,y,z);
+      m_hash[i]=hashCell(cellCoord(x),cellCoord(y),cellCoord(z));
+    }
+  });
+  // pass 2 counting sort, each thread owns a contiguous range of the points and counts them into its own
+  // row of the histogram so it only touches its own points and needs no atomics
+  size_t numChunks=std::min<size_t>(numWorkerThreads(),std::max<size_t>(1,_size/8192));
+  m_cellCursor.resize(numChunks*tableSize);
+  parallelForChunks(0,_size,numChunks,[this,tableSize](size_t _c, size_t _b, size_t _e)
+  {
+    unsigned int *count=&m_cellCursor[_c*tableSize];
+    std::fill(count,count+tableSize,0u);
+    for(size_t i=_b; i<_e; ++i)
+    {
+      ++count[m_hash[i]];
+    }
+  });
+  // pass 3 exclusive scan over cells then chunks, so within a cell the points of chunk 0 come first and
+  // the points stay in input order whatever the thread timing. Each thread scans a range of the table
+  // and the ranges are joined up after.
+  std::vector<unsigned int> rangeOffset(numChunks,0);
+  parallelForChunks(0,tableSize,numChunks,[this,tableSize,numChunks,&rangeOffset](size_t _r, size_t _b, size_t _e)
+  {
+    unsigned int sum=0;
+    for(size_t h=_b; h<_e; ++h)
+    {
+      m_cellStart[h]=sum;
+      for(size_t c=0; c<numChunks; ++c)
+      {
+        unsigned int &count=m_cellCursor[c*tableSize+h];
+        unsigned int n=count;
+        count=sum;
+        sum+=n;
+      }
+    }
+    rangeOffset[_r]=sum;
+  });
+  unsigned int offset=0;
+  for(auto &r : rangeOffset)
+  {
+    unsigned int n=r;
+    r=offset;
+    offset+=n;
+  }
+  m_cellStart[tableSize]=static_cast<unsigned int>(_size);
+  parallelForChunks(0,tableSize,numChunks,[this,tableSize,numChunks,&rangeOffset](size_t _r, size_t _b, size_t _e)
+  {
+    unsigned int offset=rangeOffset[_r];
+    for(size_t h=_b; h<_e; ++h)
+    {
+      m_cellStart[h]+=offset;
+      for(size_t c=0; c<numChunks; ++c)
+      {
+        m_cellCursor[c*tableSize+h]+=offset;
+      }
+    }
+  });
+  // pass 4 each thread scatters its own points using its own row of offsets
+  parallelForChunks(0,_size,numChunks,[this,tableSize,&_get](size_t _c, size_t _b, size_t _e)
+  {
+    unsigned int *cursor=&m_cellCursor[_c*tableSize];
+    for(size_t i=_b; i<_e; ++i)
+    {
+      unsigned int dst=cursor[m_hash[i]]++;
+      m_sortedIndex[dst]=static_cast<unsigned int>(i);
+      _get(i,m_sortedX[dst],m_sortedY[dst],m_sortedZ[dst]);
+    }
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SpatialHashGrid::queryRadius(const Vec3 &_p, Real _radius, std::vector<size_t> &o_results) const
+{
+  forEachNeighbour(_p,_radius,[&o_results](size_t _index, Real )
+  {
+    o_results.push_back(_index);
+  });
+}
+
+} // end ngl namespace
@@ -159,6 +159,14 @@ void SpotLight::loadToShader( std::string _uniformName)const noexcept
     shader->setShaderParam4f(_uniformName+".specular",0,0,0,0);
   }
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+void SpotLight::writeStd140(Std140Writer &_w) const noexcept
+{
+  writeStd140Light(_w,m_dir,m_innerCutoffAngle,m_spotExponent);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 void SpotLight::setTransform(Mat4 &_t) noexcept
 {
   m_transform=_t;
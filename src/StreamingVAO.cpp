@@ -0,0 +1,252 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "StreamingVAO.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+
+namespace ngl
+{
+using namespace dispatch;
+  constexpr unsigned int StreamingVAO::NUMREGIONS;
+
+  namespace
+  {
+    // regions start on this boundary which covers the usual GL_MIN_MAP_BUFFER_ALIGNMENT
+    constexpr size_t c_regionAlign=256;
+  }
+
+  StreamingVAO::StreamingVAO(GLenum _mode) : AbstractVAO(_mode)
+  {
+#ifndef USINGIOS_
+    m_persistent= GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+#else
+    m_persistent=false;
+#endif
+  }
+
+  StreamingVAO::~StreamingVAO()
+  {
+    removeVAO();
+  }
+
+  void StreamingVAO::draw() const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    glDrawArrays(m_mode, 0, static_cast<GLsizei>(m_indicesCount));
+    FrameStats::instance()->addDraw(m_mode,m_indicesCount);
+    fenceRegion();
+  }
+
+  void StreamingVAO::drawInstanced(unsigned int _instances) const
+  {
+    AbstractVAO::drawInstanced(_instances);
+    fenceRegion();
+  }
+
+  void StreamingVAO::fenceRegion() const
+  {
+    if(m_persistent)
+    {
+      // the region can't be written again until the GPU is past this draw
+      if(m_fence[m_region] != nullptr)
+      {
+        glDeleteSync(m_fence[m_region]);
+      }
+      m_fence[m_region]=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    }
+  }
+
+  void StreamingVAO::freeBuffer()
+  {
+    if(m_allocated == false)
+    {
+      return;
+    }
+    if(m_mapped != nullptr || m_orphanMapped)
+    {
+      GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      m_mapped=nullptr;
+      m_orphanMapped=false;
+    }
+    for(auto &fence : m_fence)
+    {
+      if(fence != nullptr)
+      {
+        glDeleteSync(fence);
+        fence=nullptr;
+      }
+    }
+    GLState::instance()->deleteBuffers(1,&m_buffer);
+    m_buffer=0;
+    ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
+    m_allocated=false;
+  }
+
+  void StreamingVAO::removeVAO()
+  {
+    if(m_bound == true)
+    {
+      unbind();
+    }
+    freeBuffer();
+    GLState::instance()->deleteVertexArrays(1,&m_id);
+    m_attributes.clear();
+  }
+
+  void StreamingVAO::allocate(size_t _size)
+  {
+    freeBuffer();
+    glGenBuffers(1, &m_buffer);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    if(m_persistent)
+    {
+      m_regionSize=(_size+c_regionAlign-1) & ~(c_regionAlign-1);
+      GLbitfield flags=GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      GLsizeiptr size=static_cast<GLsizeiptr>(m_regionSize*NUMREGIONS);
+      glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+      m_mapped=static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+      if(m_mapped == nullptr)
+      {
+        // some drivers advertise the extension but fail the mapping so drop back to orphaning
+        std::cerr<<"StreamingVAO persistent mapping failed using buffer orphaning\n";
+        GLState::instance()->deleteBuffers(1,&m_buffer);
+        m_persistent=false;
+        allocate(_size);
+        return;
+      }
+    }
+    else
+    {
+      m_regionSize=_size;
+      glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_regionSize), nullptr, GL_STREAM_DRAW);
+    }
+    m_region=0;
+    m_allocated=true;
+    ResourceTracker::instance()->track(ResourceTracker::BUFFER,this,m_persistent ? m_regionSize*NUMREGIONS : m_regionSize,"StreamingVAO");
+  }
+
+  Real *StreamingVAO::mapNextRegion(size_t _size)
+  {
+    if(m_bound == false)
+    {
+      std::cerr<<"trying to set VOA data when unbound\n";
+    }
+    if(m_allocated == false || _size > m_regionSize)
+    {
+      // grow by half again so slowly growing data doesn't reallocate every frame
+      allocate(std::max(_size,m_regionSize+m_regionSize/2));
+    }
+    // the caller writes _size bytes into the region
+    FrameStats::instance()->addBufferUpload(_size);
+    if(m_persistent)
+    {
+      m_region=(m_region+1)%NUMREGIONS;
+      GLsync &fence=m_fence[m_region];
+      if(fence != nullptr)
+      {
+        GLenum result=glClientWaitSync(fence,0,0);
+        if(result == GL_TIMEOUT_EXPIRED)
+        {
+          ++m_stalls;
+          do
+          {
+            result=glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000);
+          }
+          while(result == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence);
+        fence=nullptr;
+      }
+      return reinterpret_cast<Real *>(m_mapped+m_region*m_regionSize);
+    }
+    // orphan the old storage, the driver hands back fresh memory while the GPU finishes with the old
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_regionSize), nullptr, GL_STREAM_DRAW);
+    m_orphanMapped=true;
+    return static_cast<Real *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(_size),
+                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  }
+
+  void StreamingVAO::unmapRegion()
+  {
+    if(m_orphanMapped)
+    {
+      GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      m_orphanMapped=false;
+    }
+    bindAttributes();
+  }
+
+  void StreamingVAO::setData(const VertexData &_data)
+  {
+    Real *ptr=mapNextRegion(_data.m_size);
+    if(ptr != nullptr)
+    {
+      std::memcpy(ptr,&_data.m_data,_data.m_size);
+    }
+    unmapRegion();
+  }
+
+  void StreamingVAO::setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise )
+  {
+    if(m_bound !=true)
+    {
+      std::cerr<<"Warning trying to set attribute on Unbound VOA\n";
+    }
+    Attribute attrib={_id,_size,_type,_stride,_dataOffset,_normalise};
+    auto it=std::find_if(m_attributes.begin(),m_attributes.end(),[_id](const Attribute &_a){return _a.id==_id;});
+    if(it != m_attributes.end())
+    {
+      *it=attrib;
+    }
+    else
+    {
+      m_attributes.push_back(attrib);
+    }
+    if(m_allocated)
+    {
+      bindAttributes();
+    }
+  }
+
+  void StreamingVAO::bindAttributes()
+  {
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    size_t base= m_persistent ? m_region*m_regionSize : 0;
+    for(auto &a : m_attributes)
+    {
+      glVertexAttribPointer(a.id,a.size,a.type,a.normalise,a.stride,
+                            reinterpret_cast<const GLvoid *>(base+a.dataOffset*sizeof(Real)));
+      glEnableVertexAttribArray(a.id);
+    }
+  }
+
+}
@@ -0,0 +1,77 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "StringID.h"
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file StringID.cpp
+/// @brief implementation files for StringID class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+namespace
+{
+  // function statics so ids can be interned while other statics are being constructed, entries are never
+  // removed so references to the names stay valid once the lock is released
+  std::unordered_map<StringID,std::string> &internTable()
+  {
+    static std::unordered_map<StringID,std::string> table;
+    return table;
+  }
+
+  std::mutex &internMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+StringID::StringID(const std::string &_name) noexcept : m_hash(2166136261u)
+{
+  // same as hashStringID but a loop as the length is known
+  for(unsigned char c : _name)
+  {
+    m_hash=(m_hash ^ c)*16777619u;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool StringID::intern(const std::string &_name, StringID &o_id)
+{
+  o_id=StringID(_name);
+  std::lock_guard<std::mutex> lock(internMutex());
+  auto entry=internTable().insert({o_id,_name});
+  if(!entry.second && entry.first->second != _name)
+  {
+    std::cerr<<"Warning StringID for "<<_name<<" is the same as for "<<entry.first->second<<" so it can't be registered\n";
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const std::string &StringID::getString() const noexcept
+{
+  static const std::string empty;
+  std::lock_guard<std::mutex> lock(internMutex());
+  auto entry=internTable().find(*this);
+  return entry != internTable().end() ? entry->second : empty;
+}
+
+} // end ngl namespace
@@ -25,10 +25,15 @@
 #include <array>
 #include <memory>
 #include "Text.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include "ShaderLib.h"
 
 namespace ngl
 {
+using namespace dispatch;
 
 
 //---------------------------------------------------------------------------
@@ -129,7 +134,7 @@ Text::Text( const QFont &_f)  noexcept
 
     // now we create the OpenGL texture ID and bind to make it active
     glGenTextures(1, &fc.textureID);
-    glBindTexture(GL_TEXTURE_2D, fc.textureID);
+    GLState::instance()->bindTexture(GL_TEXTURE_2D, fc.textureID);
    // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
    // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
     glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
@@ -158,6 +163,8 @@ Text::Text( const QFont &_f)  noexcept
 
     // the image in in RGBA format and unsigned byte load it ready for later
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, widthTexture, heightTexture,0, GL_RGBA, GL_UNSIGNED_BYTE, data.get());
+    FrameStats::instance()->add(FrameStats::TEXTUREBYTES,static_cast<uint64_t>(widthTexture)*heightTexture*4);
+    ResourceTracker::instance()->track(ResourceTracker::TEXTURE,static_cast<uintptr_t>(fc.textureID),static_cast<size_t>(widthTexture)*heightTexture*4,"Text");
     glGenerateMipmap(GL_TEXTURE_2D);
 
     // see if we have a Billboard of this width already
@@ -252,7 +259,7 @@ Text::~Text()
   // our dtor should clear out the textures and remove the VAO's
   for( auto &m : m_characters)
   {
-    glDeleteTextures(1,&m.textureID);
+    GLState::instance()->deleteTextures(1,&m.textureID);
     m.vao->removeVAO();
   }
 
@@ -266,7 +273,7 @@ void Text::renderText( float _x, float _y,  const QString &text ) const noexcept
 {
   // make sure we are in texture unit 0 as this is what the
   // shader expects
-  glActiveTexture(GL_TEXTURE0);
+  GLState::instance()->activeTexture(GL_TEXTURE0);
   // grab an instance of the shader manager
   ShaderLib *shader=ShaderLib::instance();
   // use the built in text rendering shader
@@ -276,8 +283,8 @@ void Text::renderText( float _x, float _y,  const QString &text ) const noexcept
   shader->setRegisteredUniform1f("ypos",_y);
   // now enable blending and disable depth sorting so the font renders
   // correctly
-  glEnable(GL_BLEND);
-  glDisable(GL_DEPTH_TEST);
+  GLState::instance()->enable(GL_BLEND);
+  GLState::instance()->disable(GL_DEPTH_TEST);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   // now loop for each of the char and draw our billboard
   int textLength=text.length();
@@ -292,7 +299,7 @@ void Text::renderText( float _x, float _y,  const QString &text ) const noexcept
     FontChar f = m_characters[text[i].toLatin1()];
 
     // bind the pre-generated texture
-    glBindTexture(GL_TEXTURE_2D, f.textureID);
+    GLState::instance()->bindTexture(GL_TEXTURE_2D, f.textureID);
     // bind the vao
     f.vao->bind();
     // draw
@@ -305,8 +312,8 @@ void Text::renderText( float _x, float _y,  const QString &text ) const noexcept
 
   }
   // finally disable the blend and re-enable depth sort
-  glDisable(GL_BLEND);
-  glEnable(GL_DEPTH_TEST);
+  GLState::instance()->disable(GL_BLEND);
+  GLState::instance()->enable(GL_DEPTH_TEST);
 
 }
 
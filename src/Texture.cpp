@@ -20,11 +20,17 @@
 //----------------------------------------------------------------------------------------------------------------------
 #include "NGLassert.h"
 #include "Texture.h"
+#include "FrameStats.h"
+#include "CPUProfiler.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include <iostream>
 #include "Util.h"
 
 namespace ngl
 {
+using namespace dispatch;
 
 //----------------------------------------------------------------------------------------------------------------------
 Texture::Texture( const std::string &_fname  )
@@ -63,14 +69,17 @@ bool Texture::loadImage( const std::string  &_fname )
 
 GLuint Texture::setTextureGL() const noexcept
 {
+  NGL_PROFILE_SCOPE("Texture::setTextureGL");
   GLuint textureName;
   glGenTextures(1,&textureName);
-  glActiveTexture(GL_TEXTURE0+m_multiTextureID);
-  glBindTexture(GL_TEXTURE_2D,textureName);
+  GLState::instance()->activeTexture(GL_TEXTURE0+m_multiTextureID);
+  GLState::instance()->bindTexture(GL_TEXTURE_2D,textureName);
   glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
 
   glTexImage2D(GL_TEXTURE_2D,0,m_format,m_width,m_height,0,m_format,GL_UNSIGNED_BYTE,m_image.getPixels());
+  FrameStats::instance()->add(FrameStats::TEXTUREBYTES,static_cast<uint64_t>(m_width)*m_height*m_channels);
+  ResourceTracker::instance()->track(ResourceTracker::TEXTURE,static_cast<uintptr_t>(textureName),static_cast<size_t>(m_width)*m_height*m_channels,"Texture");
 
   std::cout<<"texture GL set "<<textureName<<" Active Texture "<<m_multiTextureID<<"\n";
   glGenerateMipmap(GL_TEXTURE_2D);
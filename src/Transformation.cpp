@@ -16,6 +16,7 @@
 */
 #include "ShaderLib.h"
 #include "Transformation.h"
+#include "CPUProfiler.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Transformation.cpp
 /// @brief implementation files for Transformation class
@@ -195,6 +196,7 @@ void Transformation::computeMatrices() noexcept
 {
   if (!m_isMatrixComputed)       // need to recalculate
   {
+    NGL_PROFILE_SCOPE("Transformation::computeMatrices");
     Mat4 scale;
     Mat4 rX;
     Mat4 rY;
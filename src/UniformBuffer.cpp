@@ -0,0 +1,108 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "UniformBuffer.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
+#include <algorithm>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformBuffer.cpp
+/// @brief implementation files for UniformBuffer class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+using namespace dispatch;
+constexpr GLuint UniformBuffer::CAMERABINDING;
+constexpr GLuint UniformBuffer::LIGHTBINDING;
+constexpr GLuint UniformBuffer::MATERIALBINDING;
+
+//----------------------------------------------------------------------------------------------------------------------
+void Std140Writer::declare(const char *_type, const char *_name, size_t _count)
+{
+  if(m_declaration == nullptr)
+  {
+    return;
+  }
+  m_declaration->append("  ").append(_type).append(" ").append(_name);
+  if(_count != 0)
+  {
+    m_declaration->append("[").append(std::to_string(_count)).append("]");
+  }
+  m_declaration->append(";\n");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformBuffer::UniformBuffer(size_t _blockSize, size_t _numBlocks) noexcept :
+  m_blockSize(_blockSize), m_numBlocks(std::max<size_t>(_numBlocks,1))
+{
+  GLint alignment=256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+  m_stride=Std140Writer::align(m_blockSize,static_cast<size_t>(std::max(alignment,1)));
+  m_data.resize(m_stride*m_numBlocks,0);
+  m_firstDirty=m_numBlocks;
+
+  glGenBuffers(1,&m_id);
+  GLState::instance()->bindBuffer(GL_UNIFORM_BUFFER,m_id);
+  glBufferData(GL_UNIFORM_BUFFER,static_cast<GLsizeiptr>(m_data.size()),&m_data[0],GL_DYNAMIC_DRAW);
+  FrameStats::instance()->addBufferUpload(m_data.size());
+  ResourceTracker::instance()->track(ResourceTracker::BUFFER,this,m_data.size(),"UniformBuffer");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformBuffer::~UniformBuffer() noexcept
+{
+  GLState::instance()->deleteBuffers(1,&m_id);
+  ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Std140Writer UniformBuffer::getWriter(size_t _block) noexcept
+{
+  if(_block >= m_numBlocks)
+  {
+    return Std140Writer(nullptr,0);
+  }
+  m_firstDirty=std::min(m_firstDirty,_block);
+  m_lastDirty=std::max(m_lastDirty,_block);
+  return Std140Writer(&m_data[_block*m_stride],m_blockSize);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBuffer::upload() noexcept
+{
+  if(m_firstDirty > m_lastDirty)
+  {
+    return;
+  }
+  size_t offset=m_firstDirty*m_stride;
+  size_t size=(m_lastDirty-m_firstDirty)*m_stride+m_blockSize;
+  GLState::instance()->bindBuffer(GL_UNIFORM_BUFFER,m_id);
+  glBufferSubData(GL_UNIFORM_BUFFER,static_cast<GLintptr>(offset),static_cast<GLsizeiptr>(size),&m_data[offset]);
+  FrameStats::instance()->addBufferUpload(size);
+  m_firstDirty=m_numBlocks;
+  m_lastDirty=0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBuffer::bind(GLuint _bindingPoint, size_t _block) const noexcept
+{
+  glBindBufferRange(GL_UNIFORM_BUFFER,_bindingPoint,m_id,static_cast<GLintptr>(_block*m_stride),
+                    static_cast<GLsizeiptr>(m_blockSize));
+}
+
+} // end ngl namespace
@@ -15,6 +15,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "Types.h"
+#include "GLDispatch.h"
 #include "Mat4.h"
 #include "Vec4.h"
 #include <cmath>
@@ -26,6 +27,7 @@
 //----------------------------------------------------------------------------------------------------------------------
 namespace ngl
 {
+using namespace dispatch;
 
 //----------------------------------------------------------------------------------------------------------------------
 NGL_DLLEXPORT Vec3 calcNormal(const Vec4 &_p1, const Vec4 &_p2, const Vec4 &_p3 ) noexcept
@@ -1,24 +1,34 @@
 #include "VAOFactory.h"
+#include "CPUProfiler.h"
 #include <iostream>
 
 
 namespace ngl
 {
-  std::unordered_map<std::string, std::function<AbstractVAO *(GLenum _mode)>> VAOFactory::m_vaoCreators;
+  std::unordered_map<StringID, std::function<AbstractVAO *(GLenum _mode)>> VAOFactory::m_vaoCreators;
 
   void VAOFactory::registerVAOCreator(const std::string &_type,std::function<AbstractVAO *(GLenum _mode)> _cb)
   {
-    m_vaoCreators[_type] = _cb;
+    StringID id;
+    if(StringID::intern(_type,id))
+    {
+      m_vaoCreators[id] = _cb;
+    }
   }
 
   void VAOFactory::unregisterVAOCreator(const std::string &_type)
   {
-    m_vaoCreators.erase(_type);
+    m_vaoCreators.erase(StringID(_type));
   }
 
   AbstractVAO *VAOFactory::createVAO(const std::string &_type, GLenum _mode)
   {
+    return createVAO(StringID(_type),_mode);
+  }
 
+  AbstractVAO *VAOFactory::createVAO(StringID _type, GLenum _mode)
+  {
+    NGL_PROFILE_SCOPE("VAOFactory::createVAO");
     auto it = m_vaoCreators.find(_type);
     if (it != m_vaoCreators.end())
     {
@@ -36,7 +46,7 @@ namespace ngl
     std::cout<<"******************************\n";
     for(auto c : m_vaoCreators)
     {
-      std::cout<<"Creator "<<c.first<<" registered \n";
+      std::cout<<"Creator "<<c.first.getString()<<" registered \n";
     }
     std::cout<<"******************************\n";
   }
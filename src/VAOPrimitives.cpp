@@ -18,16 +18,25 @@
 #include <cmath>
 #include <cstdlib>
 #include "VAOPrimitives.h"
+#include "GLDispatch.h"
 #include "Util.h"
 #include <iostream>
+#include "ResourceTracker.h"
 #include "VAOFactory.h"
 #include "SimpleVAO.h"
+#include "InstancedVAO.h"
+#include "GeometryPool.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file VAOPrimitives.cpp
 /// @brief implementation files for VAOPrimitives class
 //----------------------------------------------------------------------------------------------------------------------
 namespace ngl
 {
+using namespace dispatch;
+namespace
+{
+  constexpr StringID c_instancedVAO("instancedVAO");
+}
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -40,6 +49,17 @@ VAOPrimitives::VAOPrimitives() noexcept
 //----------------------------------------------------------------------------------------------------------------------
 
 void VAOPrimitives::draw( const std::string &_name ) noexcept
+{
+  StringID id(_name);
+  if(m_createdVAOs.find(id) == m_createdVAOs.end())
+  {
+    std::cerr<<"Warning VAO not know in Primitive list "<<_name<<"\n";
+    return;
+  }
+  draw(id);
+}
+
+void VAOPrimitives::draw( StringID _name ) noexcept
 {
   // get an iterator to the VertexArrayObjects
   auto VAO=m_createdVAOs.find(_name);
@@ -51,11 +71,22 @@ void VAOPrimitives::draw( const std::string &_name ) noexcept
     VAO->second->draw();
     VAO->second->unbind();
   }
-  else {std::cerr<<"Warning VAO not know in Primitive list "<<_name.c_str()<<"\n";}
+  else {std::cerr<<"Warning VAO not know in Primitive list "<<_name.getString()<<"\n";}
 
 }
 
 void VAOPrimitives::draw( const std::string &_name, GLenum _mode ) noexcept
+{
+  StringID id(_name);
+  if(m_createdVAOs.find(id) == m_createdVAOs.end())
+  {
+    std::cerr<<"Warning VAO not know in Primitive list "<<_name<<"\n";
+    return;
+  }
+  draw(id,_mode);
+}
+
+void VAOPrimitives::draw( StringID _name, GLenum _mode ) noexcept
 {
   // get an iterator to the VertexArrayObjects
   auto vao=m_createdVAOs.find(_name);
@@ -68,13 +99,91 @@ void VAOPrimitives::draw( const std::string &_name, GLenum _mode ) noexcept
     vao->second->draw();
     vao->second->unbind();
   }
-  else {std::cerr<<"Warning VAO not know in Primitive list "<<_name.c_str()<<"\n";}
+  else {std::cerr<<"Warning VAO not know in Primitive list "<<_name.getString()<<"\n";}
+
+}
+
+void VAOPrimitives::drawInstanced( const std::string &_name, unsigned int _instances ) noexcept
+{
+  StringID id(_name);
+  if(m_createdVAOs.find(id) == m_createdVAOs.end())
+  {
+    std::cerr<<"Warning VAO not know in Primitive list "<<_name<<"\n";
+    return;
+  }
+  drawInstanced(id,_instances);
+}
 
+void VAOPrimitives::drawInstanced( StringID _name, unsigned int _instances ) noexcept
+{
+  auto vao=m_createdVAOs.find(_name);
+  if(vao!=m_createdVAOs.end())
+  {
+    vao->second->bind();
+    vao->second->drawInstanced(_instances);
+    vao->second->unbind();
+  }
+  else {std::cerr<<"Warning VAO not know in Primitive list "<<_name.getString()<<"\n";}
+}
+
+size_t VAOPrimitives::addToPool( const std::string &_name, GeometryPool &_pool ) noexcept
+{
+  auto vao=m_createdVAOs.find(StringID(_name));
+  if(vao==m_createdVAOs.end())
+  {
+    std::cerr<<"Warning VAO not know in Primitive list "<<_name.c_str()<<"\n";
+    return GeometryPool::INVALID;
+  }
+  GLenum mode=vao->second->getMode();
+  if(mode!=GL_TRIANGLES && mode!=GL_TRIANGLE_STRIP && mode!=GL_TRIANGLE_FAN)
+  {
+    std::cerr<<"Only triangle primitives can be added to a GeometryPool "<<_name.c_str()<<"\n";
+    return GeometryPool::INVALID;
+  }
+  size_t numVerts=vao->second->numIndices();
+  if(numVerts<3)
+  {
+    return GeometryPool::INVALID;
+  }
+  std::vector<Real> verts(numVerts*GeometryPool::VERTEXSIZE);
+#ifndef USINGIOS_
+  glBindBuffer(GL_COPY_READ_BUFFER,vao->second->getBufferID(0));
+  glGetBufferSubData(GL_COPY_READ_BUFFER,0,static_cast<GLsizeiptr>(verts.size()*sizeof(Real)),&verts[0]);
+  glBindBuffer(GL_COPY_READ_BUFFER,0);
+#endif
+  if(mode==GL_TRIANGLES)
+  {
+    return _pool.addMesh(&verts[0],numVerts,nullptr,0);
+  }
+  // unroll strips and fans into triangle list indices, strips flip every other triangle to keep the winding
+  std::vector<GLuint> indices;
+  indices.reserve((numVerts-2)*3);
+  for(GLuint i=2; i<numVerts; ++i)
+  {
+    if(mode==GL_TRIANGLE_FAN)
+    {
+      indices.insert(indices.end(),{0,i-1,i});
+    }
+    else if(i%2==0)
+    {
+      indices.insert(indices.end(),{i-2,i-1,i});
+    }
+    else
+    {
+      indices.insert(indices.end(),{i-1,i-2,i});
+    }
+  }
+  return _pool.addMesh(&verts[0],numVerts,&indices[0],indices.size());
 }
 
 void VAOPrimitives::createVAOFromHeader(const std::string &_name, const Real *_data,  unsigned int _size ) noexcept
 {
-    AbstractVAO *vao = VAOFactory::createVAO("simpleVAO",GL_TRIANGLES);
+    StringID id;
+    if(!StringID::intern(_name,id))
+    {
+      return;
+    }
+    AbstractVAO *vao = VAOFactory::createVAO(c_instancedVAO,GL_TRIANGLES);
 ;
     // next we bind it so it's active for setting data
     vao->bind();
@@ -104,7 +213,8 @@ void VAOPrimitives::createVAOFromHeader(const std::string &_name, const Real *_d
     vao->setNumIndices(_size/8);
     // finally we have finished for now so time to unbind the VAO
     vao->unbind();
-    m_createdVAOs[_name]=vao;
+    m_createdVAOs[id]=vao;
+    ResourceTracker::instance()->setTag(ResourceTracker::BUFFER,vao,_name);
    // std::cout<<_name<<" Num Triangles "<<data.size()/3<<"\n";
 
 }
@@ -334,8 +444,13 @@ void VAOPrimitives::createCapsule( const std::string &_name,  const Real _radius
 
 void VAOPrimitives::createVAO(const std::string &_name,const std::vector<vertData> &_data,	const GLenum _mode) noexcept
 {
+  StringID id;
+  if(!StringID::intern(_name,id))
+  {
+    return;
+  }
 
-  AbstractVAO *vao = VAOFactory::createVAO("simpleVAO",_mode);
+  AbstractVAO *vao = VAOFactory::createVAO(c_instancedVAO,_mode);
   // next we bind it so it's active for setting data
   vao->bind();
 
@@ -364,7 +479,8 @@ void VAOPrimitives::createVAO(const std::string &_name,const std::vector<vertDat
   vao->setNumIndices(_data.size());
   // finally we have finished for now so time to unbind the VAO
   vao->unbind();
-  m_createdVAOs[_name]=vao;
+  m_createdVAOs[id]=vao;
+  ResourceTracker::instance()->setTag(ResourceTracker::BUFFER,vao,_name);
  // std::cout<<_name<<" Num Triangles "<<_data.size()/3<<"\n";
 
 }
@@ -894,6 +1010,11 @@ void VAOPrimitives::clear() noexcept
 }
 
 AbstractVAO * VAOPrimitives::getVAOFromName(const std::string &_name)
+{
+  return getVAOFromName(StringID(_name));
+}
+
+AbstractVAO * VAOPrimitives::getVAOFromName(StringID _name)
 {
   // get an iterator to the VertexArrayObjects
   auto VAO=m_createdVAOs.find(_name);
@@ -905,4 +1026,9 @@ AbstractVAO * VAOPrimitives::getVAOFromName(const std::string &_name)
   else return nullptr;
 }
 
+InstancedVAO * VAOPrimitives::getInstancedVAO(const std::string &_name)
+{
+  return dynamic_cast<InstancedVAO *>(getVAOFromName(_name));
+}
+
 } // end ngl namespace
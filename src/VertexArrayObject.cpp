@@ -15,6 +15,10 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "VertexArrayObject.h"
+#include "FrameStats.h"
+#include "GLDispatch.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
 #include <iostream>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file VertexArrayObject.cpp
@@ -22,6 +26,7 @@
 //----------------------------------------------------------------------------------------------------------------------
 namespace ngl
 {
+using namespace dispatch;
 
 //----------------------------------------------------------------------------------------------------------------------
 VertexArrayObject::VertexArrayObject(GLenum _mode)
@@ -40,13 +45,13 @@ VertexArrayObject::VertexArrayObject(GLenum _mode)
 //----------------------------------------------------------------------------------------------------------------------
 void VertexArrayObject::bind()
 {
-  glBindVertexArray(m_id);
+  GLState::instance()->bindVertexArray(m_id);
   m_bound=true;
 }
 //----------------------------------------------------------------------------------------------------------------------
 void VertexArrayObject::unbind()
 {
-  glBindVertexArray(0);
+  GLState::instance()->bindVertexArray(0);
   m_bound=false;
 }
 //----------------------------------------------------------------------------------------------------------------------
@@ -60,10 +65,11 @@ void VertexArrayObject::removeVOA()
   {
     for(auto b : m_vboIDs)
     {
-      glDeleteBuffers(1,&b);
+      GLState::instance()->deleteBuffers(1,&b);
     }
-    glDeleteVertexArrays(1,&m_id);
+    GLState::instance()->deleteVertexArrays(1,&m_id);
     m_allocated=false;
+    ResourceTracker::instance()->release(ResourceTracker::BUFFER,this);
   }
 }
 //----------------------------------------------------------------------------------------------------------------------
@@ -77,8 +83,10 @@ void VertexArrayObject::setData(size_t _size,const GLfloat &_data,GLenum _mode)
   glGenBuffers(1, &vboID);
   m_vboIDs.push_back(vboID);
   // now we will bind an array buffer to the first one and load the data for the verts
-  glBindBuffer(GL_ARRAY_BUFFER, vboID);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, vboID);
   glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>( _size), &_data, _mode);
+  FrameStats::instance()->addBufferUpload(_size);
+  ResourceTracker::instance()->add(ResourceTracker::BUFFER,this,_size,"VertexArrayObject");
   m_allocated=true;
 
 }
@@ -101,8 +109,10 @@ void VertexArrayObject::setIndexedData(size_t _size, const GLfloat &_data, unsig
 
   //glEnableVertexAttribArray(0);
   // now we will bind an array buffer to the first one and load the data for the verts
-  glBindBuffer(GL_ARRAY_BUFFER, vboID);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, vboID);
   glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_size), &_data, _mode);
+  FrameStats::instance()->addBufferUpload(_size);
+  ResourceTracker::instance()->add(ResourceTracker::BUFFER,this,_size,"VertexArrayObject");
   // we need to determine the size of the data type before we set it
   // in default to a ushort
   int size=sizeof(GLushort);
@@ -114,8 +124,10 @@ void VertexArrayObject::setIndexedData(size_t _size, const GLfloat &_data, unsig
     default : std::cerr<<"wrong data type send for index value\n"; break;
   }
   // now for the indices
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
+  GLState::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indexSize * static_cast<GLsizeiptr>(size), const_cast<GLvoid *>(_indexData), _mode);
+  FrameStats::instance()->addBufferUpload(_indexSize*static_cast<size_t>(size));
+  ResourceTracker::instance()->add(ResourceTracker::BUFFER,this,_indexSize*static_cast<size_t>(size));
 
   m_allocated=true;
   m_indexed=true;
@@ -140,8 +152,10 @@ void VertexArrayObject::setRawIndexedData(size_t _size, const GLvoid *_data, uns
 
   //glEnableVertexAttribArray(0);
   // now we will bind an array buffer to the first one and load the data for the verts
-  glBindBuffer(GL_ARRAY_BUFFER, vboID);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, vboID);
   glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_size), _data, _mode);
+  FrameStats::instance()->addBufferUpload(_size);
+  ResourceTracker::instance()->add(ResourceTracker::BUFFER,this,_size,"VertexArrayObject");
   // we need to determine the size of the data type before we set it
   // in default to a ushort
   int size=sizeof(GLushort);
@@ -153,8 +167,10 @@ void VertexArrayObject::setRawIndexedData(size_t _size, const GLvoid *_data, uns
     default : std::cerr<<"wrong data type sent for index value\n"; break;
   }
   // now for the indices
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
+  GLState::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(_indexSize)*size , _indexData, _mode);
+  FrameStats::instance()->addBufferUpload(_indexSize*static_cast<size_t>(size));
+  ResourceTracker::instance()->add(ResourceTracker::BUFFER,this,_indexSize*static_cast<size_t>(size));
 
   m_allocated=true;
   m_indexed=true;
@@ -174,8 +190,9 @@ void VertexArrayObject::updateIndexedData( size_t _size, const GLfloat &_data,GL
 
   if(m_allocated && m_indexed)
   {
-    glBindBuffer(GL_ARRAY_BUFFER, getVBOid(0));
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, getVBOid(0));
     glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_size), &_data, _mode);
+    FrameStats::instance()->addBufferUpload(_size);
   }
 }
 
@@ -189,8 +206,9 @@ void VertexArrayObject::updateIndexedData(GLuint vboidx, size_t _size,const GLfl
 
     if(m_allocated && m_indexed)
     {
-      glBindBuffer(GL_ARRAY_BUFFER, getVBOid(vboidx));
+      GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, getVBOid(vboidx));
       glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_size), &_data, _mode);
+      FrameStats::instance()->addBufferUpload(_size);
     }
 }
 
@@ -206,8 +224,9 @@ void VertexArrayObject::updateData( unsigned int _size, const GLfloat &_data,GLe
 
   if(m_allocated )
   {
-    glBindBuffer(GL_ARRAY_BUFFER, getVBOid(0));
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, getVBOid(0));
     glBufferData(GL_ARRAY_BUFFER, _size, &_data, _mode);
+    FrameStats::instance()->addBufferUpload(_size);
   }
 }
 
@@ -221,8 +240,9 @@ void VertexArrayObject::updateData(GLuint vboidx, unsigned int _size,const GLflo
 
     if(m_allocated )
     {
-      glBindBuffer(GL_ARRAY_BUFFER, getVBOid(vboidx));
+      GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, getVBOid(vboidx));
       glBufferData(GL_ARRAY_BUFFER, _size, &_data, _mode);
+      FrameStats::instance()->addBufferUpload(_size);
     }
 }
 
@@ -280,10 +300,12 @@ void VertexArrayObject::draw() const
   if(m_indexed == false)
   {
     glDrawArrays(m_drawMode, 0, static_cast<GLsizei>(m_indicesCount));	// draw first object
+    FrameStats::instance()->addDraw(m_drawMode,m_indicesCount);
   }
   else
   {
     glDrawElements(m_drawMode,static_cast<GLsizei>(m_indicesCount),m_indexType,static_cast<GLvoid *>(nullptr));
+    FrameStats::instance()->addDraw(m_drawMode,m_indicesCount);
   }
 }
 
@@ -299,6 +321,7 @@ void VertexArrayObject::draw(unsigned int _startIndex, unsigned int _numVerts, G
     std::cerr<<"Warning trying to draw an unbound VOA\n";
   }
   glDrawArrays(_mode, static_cast<GLsizei>(_startIndex), static_cast<GLsizei>(_numVerts));	// draw first object
+  FrameStats::instance()->addDraw(_mode,_numVerts);
 }
 
 void VertexArrayObject::draw(GLenum _mode) const
@@ -315,10 +338,12 @@ void VertexArrayObject::draw(GLenum _mode) const
   if(m_indexed == false)
   {
     glDrawArrays(_mode, 0, static_cast<GLsizei>(m_indicesCount));	// draw first object
+    FrameStats::instance()->addDraw(_mode,m_indicesCount);
   }
   else
   {
     glDrawElements(_mode,static_cast<GLsizei>(m_indicesCount),m_indexType,static_cast<GLvoid *>(nullptr));//(GLvoid*)((char*)NULL));
+    FrameStats::instance()->addDraw(_mode,m_indicesCount);
   }
 }
 
@@ -336,11 +361,13 @@ void VertexArrayObject::drawInstanced(unsigned int _n) const
   if(m_indexed == false)
   {
     glDrawArraysInstanced(m_drawMode, 0, static_cast<GLsizei>(m_indicesCount),static_cast<GLsizei>(_n));	// draw first object
+    FrameStats::instance()->addDraw(m_drawMode,m_indicesCount,_n);
   }
   else
   {
 
     glDrawElementsInstanced(m_drawMode,static_cast<GLsizei>(m_indicesCount),m_indexType,nullptr,static_cast<GLsizei>(_n));
+    FrameStats::instance()->addDraw(m_drawMode,m_indicesCount,_n);
   }
 }
 
@@ -355,7 +382,7 @@ Real *VertexArrayObject::getDataPointer(unsigned int _vbo, GLenum _accessMode)
   if(_vbo<m_vboIDs.size())
   {
     bind();
-    glBindBuffer(GL_ARRAY_BUFFER, m_vboIDs[_vbo]);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_vboIDs[_vbo]);
     #ifndef USINGIOS_
       ptr = static_cast<Real *>(glMapBuffer(GL_ARRAY_BUFFER, _accessMode));
     #endif
@@ -0,0 +1,119 @@
+#include <ngl/CompressedPointBake.h>
+#include <ngl/Vec3.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// a synthetic cache of 100 frames of a 200x100 grid with a travelling wave
+constexpr unsigned int c_numFrames=100;
+constexpr unsigned int c_width=200;
+constexpr unsigned int c_depth=100;
+static const char *s_fileName="compressedBenchmark.pbc";
+static std::vector<std::vector<ngl::Vec3>> s_frames;
+static ngl::CompressedPointBake s_bake;
+static std::vector<ngl::Vec3> s_out(c_width*c_depth);
+
+void makeFrames()
+{
+  s_frames.resize(c_numFrames);
+  for(unsigned int f=0; f<c_numFrames; ++f)
+  {
+    float t=static_cast<float>(f)*0.1f;
+    for(unsigned int z=0; z<c_depth; ++z)
+    {
+      for(unsigned int x=0; x<c_width; ++x)
+      {
+        float px=static_cast<float>(x)*0.1f-10.0f;
+        float pz=static_cast<float>(z)*0.1f-5.0f;
+        s_frames[f].push_back(ngl::Vec3(px+t,std::sin(px*0.5f+t)*std::cos(pz*0.3f-t),pz));
+      }
+    }
+  }
+}
+
+void report()
+{
+  float maxError=0.0f;
+  for(unsigned int f=0; f<c_numFrames; ++f)
+  {
+    const std::vector<ngl::Vec3> &verts=s_bake.getFrame(f);
+    for(size_t i=0; i<verts.size(); ++i)
+    {
+      maxError=std::max(maxError,(verts[i]-s_frames[f][i]).length());
+    }
+  }
+  auto start=std::chrono::high_resolution_clock::now();
+  constexpr int c_passes=10;
+  for(int p=0; p<c_passes; ++p)
+  {
+    for(unsigned int f=0; f<c_numFrames; ++f)
+    {
+      s_bake.decodeFrame(f,&s_out[0]);
+    }
+  }
+  std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+  double rawMB=static_cast<double>(s_bake.getRawSize())*c_passes/(1024.0*1024.0);
+  std::cout<<"raw size "<<s_bake.getRawSize()<<" compressed size "<<s_bake.getCompressedSize()
+           <<" ratio "<<s_bake.getCompressionRatio()<<" max error "<<maxError<<"\n";
+  std::cout<<"sequential decode "<<rawMB/time.count()<<" MB/s "
+           <<c_numFrames*c_passes/time.count()<<" frames/s\n";
+}
+
+BENCHMARK(CompressedPointBake, RawFrameCopy, 10, 1)
+{
+  for(unsigned int f=0; f<c_numFrames; ++f)
+  {
+    std::copy(s_frames[f].begin(),s_frames[f].end(),s_out.begin());
+  }
+}
+
+BENCHMARK(CompressedPointBake, DecodeForward, 10, 1)
+{
+  for(unsigned int f=0; f<c_numFrames; ++f)
+  {
+    s_bake.decodeFrame(f,&s_out[0]);
+  }
+}
+
+BENCHMARK(CompressedPointBake, DecodeBackward, 10, 1)
+{
+  for(unsigned int f=c_numFrames; f>0; --f)
+  {
+    s_bake.decodeFrame(f-1,&s_out[0]);
+  }
+}
+
+BENCHMARK(CompressedPointBake, DecodeRandom, 10, 1)
+{
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<unsigned int> frame(0,c_numFrames-1);
+  for(unsigned int f=0; f<c_numFrames; ++f)
+  {
+    s_bake.decodeFrame(frame(gen),&s_out[0]);
+  }
+}
+
+int main(int argc, char **argv)
+{
+    makeFrames();
+    ngl::CompressedPointBake::save(s_fileName,s_frames,0);
+    s_bake.load(s_fileName);
+    report();
+    // Set up the main runner.
+    ::hayai::MainRunner runner;
+    // Parse the arguments.
+    int result = runner.ParseArgs(argc, argv);
+    if (result)
+        return result;
+
+    // Execute based on the selected mode.
+    result=runner.Run();
+    std::remove(s_fileName);
+    return result;
+}
@@ -0,0 +1,102 @@
+#include <ngl/DynamicAABBTree.h>
+#include <ngl/Camera.h>
+#include <ngl/Vec3.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <random>
+#include <vector>
+
+// 100k dynamic objects in a 200 unit cube
+constexpr size_t c_numObjects=100000;
+static std::vector<ngl::Vec3> s_pos;
+static std::vector<ngl::Vec3> s_vel;
+static std::vector<int> s_ids;
+static std::vector<size_t> s_results;
+static ngl::DynamicAABBTree s_tree(0.2f);
+static const ngl::Vec3 s_half(0.5f,0.5f,0.5f);
+
+void buildScene()
+{
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<float> pos(-100.0f,100.0f);
+  std::uniform_real_distribution<float> vel(-0.2f,0.2f);
+  s_tree.clear();
+  s_pos.resize(c_numObjects);
+  s_vel.resize(c_numObjects);
+  s_ids.resize(c_numObjects);
+  for(size_t i=0; i<c_numObjects; ++i)
+  {
+    s_pos[i].set(pos(gen),pos(gen),pos(gen));
+    s_vel[i].set(vel(gen),vel(gen),vel(gen));
+    s_ids[i]=s_tree.insert(s_pos[i]-s_half,s_pos[i]+s_half,i);
+  }
+}
+
+BENCHMARK(DynamicAABBTree, Insert100k, 5, 1)
+{
+  buildScene();
+}
+
+BENCHMARK(DynamicAABBTree, Update100k, 10, 1)
+{
+  if(s_tree.size()!=c_numObjects)
+  {
+    buildScene();
+  }
+  for(size_t i=0; i<c_numObjects; ++i)
+  {
+    s_pos[i]+=s_vel[i];
+    s_tree.update(s_ids[i],s_pos[i]-s_half,s_pos[i]+s_half,s_vel[i]);
+  }
+}
+
+BENCHMARK(DynamicAABBTree, FrustumQuery100k, 10, 10)
+{
+  ngl::Camera cam(ngl::Vec3(0.0f,0.0f,150.0f),ngl::Vec3::zero(),ngl::Vec3::up());
+  cam.setShape(45.0f,1.0f,0.1f,300.0f);
+  cam.calculateFrustum();
+  s_results.clear();
+  s_tree.queryFrustum(cam,s_results);
+}
+
+BENCHMARK(DynamicAABBTree, LinearFrustum100k, 10, 10)
+{
+  ngl::Camera cam(ngl::Vec3(0.0f,0.0f,150.0f),ngl::Vec3::zero(),ngl::Vec3::up());
+  cam.setShape(45.0f,1.0f,0.1f,300.0f);
+  cam.calculateFrustum();
+  s_results.clear();
+  for(size_t i=0; i<s_pos.size(); ++i)
+  {
+    if(cam.isSphereInFrustum(s_pos[i],0.87f) != ngl::CameraIntercept::OUTSIDE)
+    {
+      s_results.push_back(i);
+    }
+  }
+}
+
+BENCHMARK(DynamicAABBTree, RegionQuery, 10, 1000)
+{
+  s_results.clear();
+  s_tree.queryRegion(ngl::Vec3(-5.0f,-5.0f,-5.0f),ngl::Vec3(5.0f,5.0f,5.0f),s_results);
+}
+
+BENCHMARK(DynamicAABBTree, RayQuery, 10, 1000)
+{
+  s_results.clear();
+  s_tree.queryRay(ngl::Vec3(-200.0f,0.0f,0.0f),ngl::Vec3(1.0f,0.1f,0.0f),400.0f,s_results);
+}
+
+
+int main(int argc, char **argv)
+{
+    buildScene();
+    // Set up the main runner.
+    ::hayai::MainRunner runner;
+    // Parse the arguments.
+    int result = runner.ParseArgs(argc, argv);
+    if (result)
+        return result;
+
+    // Execute based on the selected mode.
+    return runner.Run();
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/GLMock.h>
+#include <ngl/GLState.h>
+#include <ngl/FrameStats.h>
+#include <ngl/ResourceTracker.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/SimpleIndexVAO.h>
+#include <memory>
+
+// these run with GLMock installed so no GL context is needed
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+TEST(NGLGLMock,GLStateSkipsRedundantBinds)
+{
+  ngl::GLMock mock;
+  ASSERT_TRUE(mock.install());
+  ngl::GLState *state=ngl::GLState::instance();
+  state->bindVertexArray(3);
+  state->bindVertexArray(3);
+  state->bindBuffer(GL_ARRAY_BUFFER,5);
+  state->bindBuffer(GL_ARRAY_BUFFER,5);
+  state->bindBuffer(GL_ARRAY_BUFFER,6);
+  state->useProgram(2);
+  state->useProgram(2);
+  EXPECT_EQ(mock.getCallCount("glBindVertexArray"),1u);
+  EXPECT_EQ(mock.getCallCount("glBindBuffer"),2u);
+  EXPECT_EQ(mock.getCallCount("glUseProgram"),1u);
+  // after invalidate the next bind must reach GL again
+  state->invalidate();
+  state->bindVertexArray(3);
+  EXPECT_EQ(mock.getCallCount("glBindVertexArray"),2u);
+}
+
+TEST(NGLGLMock,VAOLifetime)
+{
+  ngl::GLMock mock;
+  ASSERT_TRUE(mock.install());
+  ngl::ResourceTracker *tracker=ngl::ResourceTracker::instance();
+  tracker->reset();
+  float data[18]={0.0f};
+  {
+    std::unique_ptr<ngl::AbstractVAO> vao(ngl::SimpleVAO::create(GL_TRIANGLES));
+    vao->bind();
+    vao->setData(ngl::AbstractVAO::VertexData(sizeof(data),data[0]));
+    vao->unbind();
+    EXPECT_EQ(mock.getNumObjects(ngl::GLMock::VERTEXARRAY),1u);
+    EXPECT_EQ(mock.getNumObjects(ngl::GLMock::BUFFER),1u);
+    EXPECT_EQ(mock.getBufferBytes(),sizeof(data));
+    EXPECT_EQ(tracker->getCurrent(ngl::ResourceTracker::BUFFER),sizeof(data));
+  }
+  EXPECT_EQ(mock.getNumObjects(ngl::GLMock::VERTEXARRAY),0u);
+  EXPECT_EQ(mock.getNumObjects(ngl::GLMock::BUFFER),0u);
+  EXPECT_EQ(mock.getNumBadDeletes(),0u);
+  EXPECT_EQ(tracker->getCurrent(ngl::ResourceTracker::BUFFER),0u);
+  EXPECT_EQ(tracker->getPeak(ngl::ResourceTracker::BUFFER),sizeof(data));
+}
+
+TEST(NGLGLMock,FrameStatsDraws)
+{
+  ngl::GLMock mock;
+  ASSERT_TRUE(mock.install());
+  ngl::FrameStats *stats=ngl::FrameStats::instance();
+  stats->reset();
+  float data[18]={0.0f};
+  std::unique_ptr<ngl::AbstractVAO> vao(ngl::SimpleVAO::create(GL_TRIANGLES));
+  vao->bind();
+  vao->setData(ngl::AbstractVAO::VertexData(sizeof(data),data[0]));
+  vao->setNumIndices(6);
+  // start both frames together so the setup calls aren't counted
+  mock.endFrame();
+  stats->beginFrame();
+  for(int i=0; i<3; ++i)
+  {
+    vao->bind();
+    vao->draw();
+  }
+  vao->unbind();
+  stats->endFrame();
+  mock.endFrame();
+  EXPECT_EQ(mock.getLastFrameDrawCalls(),3u);
+  EXPECT_EQ(stats->getLastFrame(ngl::FrameStats::DRAWCALLS),3u);
+  EXPECT_EQ(stats->getLastFrame(ngl::FrameStats::TRIANGLES),6u);
+  // the VAO was still bound from the setup so only the unbind reaches GL
+  EXPECT_EQ(mock.getLastFrameCallCount("glBindVertexArray"),1u);
+  EXPECT_EQ(stats->getLastFrame(ngl::FrameStats::VAOBINDS),1u);
+}
+
+TEST(NGLGLMock,ResourceTrackerLeaks)
+{
+  ngl::GLMock mock;
+  ASSERT_TRUE(mock.install());
+  ngl::ResourceTracker *tracker=ngl::ResourceTracker::instance();
+  tracker->reset();
+  float data[18]={0.0f};
+  std::unique_ptr<ngl::AbstractVAO> kept(ngl::SimpleVAO::create(GL_TRIANGLES));
+  kept->bind();
+  kept->setData(ngl::AbstractVAO::VertexData(sizeof(data),data[0]));
+  kept->unbind();
+  tracker->setTag(ngl::ResourceTracker::BUFFER,kept.get(),"kept");
+  tracker->track(ngl::ResourceTracker::TEXTURE,static_cast<uintptr_t>(7),64,"texture");
+  GLuint texture=7;
+  ngl::GLState::instance()->deleteTextures(1,&texture);
+  EXPECT_EQ(tracker->getCurrent(ngl::ResourceTracker::TEXTURE),0u);
+  EXPECT_EQ(tracker->reportLeaks(),1u);
+  auto tags=tracker->getBytesByTag(ngl::ResourceTracker::BUFFER);
+  ASSERT_EQ(tags.size(),1u);
+  EXPECT_EQ(tags[0].first,"kept");
+  kept->removeVAO();
+  EXPECT_EQ(tracker->reportLeaks(),0u);
+}
@@ -0,0 +1,103 @@
+#include <ngl/NCCAPointBake.h>
+#include <ngl/Vec3.h>
+#include <ngl/rapidxml/rapidxml.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <cstdio>
+
+// a synthetic cache of 100 frames of 20k verts
+constexpr unsigned int c_numFrames=100;
+constexpr unsigned int c_numVerts=20000;
+static const char *s_fileName="pointBakeBenchmark.xml";
+
+void writeBake()
+{
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<float> pos(-100.0f,100.0f);
+  FILE *file=std::fopen(s_fileName,"w");
+  std::fprintf(file,"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<NCCAPointBake>\n");
+  std::fprintf(file,"\t<MeshName> bench </MeshName>\n\t<NumVerts> %u </NumVerts>\n",c_numVerts);
+  std::fprintf(file,"\t<StartFrame> 0 </StartFrame>\n\t<EndFrame> %u </EndFrame>\n",c_numFrames-1);
+  std::fprintf(file,"\t<NumFrames> %u </NumFrames>\n\t<TranslateMode> absolute </TranslateMode>\n",c_numFrames);
+  for(unsigned int f=0; f<c_numFrames; ++f)
+  {
+    std::fprintf(file,"\t<Frame number=\"%u\">\n",f);
+    for(unsigned int v=0; v<c_numVerts; ++v)
+    {
+      std::fprintf(file,"\t\t<Vertex number=\"%u\" attrib=\"translate\"> %f %f %f </Vertex>\n",v,pos(gen),pos(gen),pos(gen));
+    }
+    std::fprintf(file,"\t</Frame>\n");
+  }
+  std::fprintf(file,"</NCCAPointBake>\n");
+  std::fclose(file);
+}
+
+// the original rapidxml / tokenizer / lexical_cast loader (without the logging) for comparison
+void legacyLoad(std::vector<std::vector<ngl::Vec3>> &o_data)
+{
+  typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+  std::ifstream xmlFile(s_fileName);
+  std::vector<char> buffer((std::istreambuf_iterator<char>(xmlFile)), std::istreambuf_iterator<char>());
+  buffer.push_back('\0');
+  rapidxml::xml_document<> doc;
+  doc.parse<rapidxml::parse_trim_whitespace>(&buffer[0]);
+  rapidxml::xml_node<> *rootNode=doc.first_node();
+  unsigned int nVerts=boost::lexical_cast<unsigned int>(rootNode->first_node("NumVerts")->value());
+  unsigned int startFrame=boost::lexical_cast<unsigned int>(rootNode->first_node("StartFrame")->value());
+  unsigned int numFrames=boost::lexical_cast<unsigned int>(rootNode->first_node("NumFrames")->value());
+  o_data.resize(numFrames);
+  for(auto &data : o_data)
+  {
+    data.resize(nVerts);
+  }
+  std::string lineBuffer;
+  boost::char_separator<char> sep(" \t\r\n");
+  for(rapidxml::xml_node<> *child=rootNode->first_node("Frame"); child; child=child->next_sibling())
+  {
+    unsigned int currentFrame=boost::lexical_cast<unsigned int>(child->first_attribute("number")->value())-startFrame;
+    for(rapidxml::xml_node<> *vertex=child->first_node("Vertex"); vertex; vertex=vertex->next_sibling())
+    {
+      unsigned int index=boost::lexical_cast<unsigned int>(vertex->first_attribute("number")->value());
+      lineBuffer=vertex->value();
+      tokenizer tokens(lineBuffer, sep);
+      tokenizer::iterator firstWord=tokens.begin();
+      float x=boost::lexical_cast<float>(*firstWord++);
+      float y=boost::lexical_cast<float>(*firstWord++);
+      float z=boost::lexical_cast<float>(*firstWord++);
+      o_data[currentFrame][index].set(x,y,z);
+    }
+  }
+}
+
+BENCHMARK(NCCAPointBake, LegacyXMLLoad, 2, 1)
+{
+  std::vector<std::vector<ngl::Vec3>> data;
+  legacyLoad(data);
+}
+
+BENCHMARK(NCCAPointBake, LoadPointBake, 2, 1)
+{
+  ngl::NCCAPointBake bake;
+  bake.loadPointBake(s_fileName);
+}
+
+int main(int argc, char **argv)
+{
+    writeBake();
+    // Set up the main runner.
+    ::hayai::MainRunner runner;
+    // Parse the arguments.
+    int result = runner.ParseArgs(argc, argv);
+    if (result)
+        return result;
+
+    // Execute based on the selected mode.
+    result=runner.Run();
+    std::remove(s_fileName);
+    return result;
+}
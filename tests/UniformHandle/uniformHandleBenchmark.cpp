@@ -0,0 +1,187 @@
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QSurfaceFormat>
+#include <ngl/NGLInit.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/Light.h>
+#include <ngl/UniformHandle.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <iostream>
+
+// each benchmark sets the same uniforms c_numSets times so the difference is the per call overhead
+constexpr int c_numSets=10000;
+
+static const char *s_vertex=R"(
+#version 330 core
+struct Lights
+{
+  vec4 position;
+  vec4 ambient;
+  vec4 diffuse;
+  vec4 specular;
+};
+uniform mat4 MVP;
+uniform vec4 Colour;
+uniform Lights light;
+layout (location=0) in vec3 inVert;
+out vec4 colour;
+void main()
+{
+  colour=Colour*light.diffuse+light.ambient+light.specular*light.position.w;
+  gl_Position=MVP*vec4(inVert,1.0)+light.position;
+}
+)";
+
+static const char *s_fragment=R"(
+#version 330 core
+in vec4 colour;
+layout (location=0) out vec4 fragColour;
+void main()
+{
+  fragColour=colour;
+}
+)";
+
+static ngl::Mat4 s_mvp;
+static ngl::Vec4 s_colour(1.0f,0.5f,0.2f,1.0f);
+static ngl::Light s_light(ngl::Vec3(1.0f,2.0f,3.0f),ngl::Colour(1.0f,1.0f,1.0f,1.0f),ngl::LightModes::POINTLIGHT);
+
+BENCHMARK(Uniforms, SetShaderParam, 10, 1)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  for(int i=0; i<c_numSets; ++i)
+  {
+    shader->setShaderParamFromMat4("MVP",s_mvp);
+    shader->setShaderParamFromVec4("Colour",s_colour);
+  }
+}
+
+BENCHMARK(Uniforms, SetRegisteredUniform, 10, 1)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  for(int i=0; i<c_numSets; ++i)
+  {
+    shader->setRegisteredUniform("MVP",s_mvp);
+    shader->setRegisteredUniform("Colour",s_colour);
+  }
+}
+
+BENCHMARK(Uniforms, SetRegisteredUniformNoShadowing, 10, 1)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->setUniformShadowing(false);
+  for(int i=0; i<c_numSets; ++i)
+  {
+    shader->setRegisteredUniform("MVP",s_mvp);
+    shader->setRegisteredUniform("Colour",s_colour);
+  }
+  shader->setUniformShadowing(true);
+}
+
+BENCHMARK(Uniforms, UniformHandle, 10, 1)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  auto mvp=shader->getUniformHandle<ngl::Mat4>("MVP");
+  auto colour=shader->getUniformHandle<ngl::Vec4>("Colour");
+  for(int i=0; i<c_numSets; ++i)
+  {
+    mvp.set(s_mvp);
+    colour.set(s_colour);
+  }
+}
+
+BENCHMARK(Uniforms, HashedUniformHandle, 10, 1)
+{
+  constexpr ngl::UniformName c_mvp("MVP");
+  constexpr ngl::UniformName c_colour("Colour");
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  auto mvp=shader->getUniformHandle<ngl::Mat4>(c_mvp);
+  auto colour=shader->getUniformHandle<ngl::Vec4>(c_colour);
+  for(int i=0; i<c_numSets; ++i)
+  {
+    mvp.set(s_mvp);
+    colour.set(s_colour);
+  }
+}
+
+BENCHMARK(Lookup, UseByName, 10, 1)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  for(int i=0; i<c_numSets; ++i)
+  {
+    shader->use("Uniforms");
+  }
+}
+
+BENCHMARK(Lookup, UseByStringID, 10, 1)
+{
+  constexpr ngl::StringID c_uniforms("Uniforms");
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  for(int i=0; i<c_numSets; ++i)
+  {
+    shader->use(c_uniforms);
+  }
+}
+
+BENCHMARK(Light, LoadToShaderByName, 10, 1)
+{
+  for(int i=0; i<c_numSets; ++i)
+  {
+    s_light.loadToShader("light");
+  }
+}
+
+BENCHMARK(Light, LoadToShaderHandles, 10, 1)
+{
+  ngl::Light::Uniforms uniforms=ngl::Light::getUniforms("light");
+  for(int i=0; i<c_numSets; ++i)
+  {
+    s_light.loadToShader(uniforms);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  QGuiApplication app(argc,argv);
+  QSurfaceFormat format;
+  format.setVersion(4,1);
+  format.setProfile(QSurfaceFormat::CoreProfile);
+  QOpenGLContext context;
+  context.setFormat(format);
+  if(!context.create())
+  {
+    std::cerr<<"unable to create an OpenGL context\n";
+    return EXIT_FAILURE;
+  }
+  QOffscreenSurface surface;
+  surface.setFormat(context.format());
+  surface.create();
+  context.makeCurrent(&surface);
+  ngl::NGLInit::instance();
+
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->createShaderProgram("Uniforms");
+  shader->attachShader("UniformsVertex",ngl::ShaderType::VERTEX);
+  shader->attachShader("UniformsFragment",ngl::ShaderType::FRAGMENT);
+  shader->loadShaderSourceFromString("UniformsVertex",s_vertex);
+  shader->loadShaderSourceFromString("UniformsFragment",s_fragment);
+  shader->compileShader("UniformsVertex");
+  shader->compileShader("UniformsFragment");
+  shader->attachShaderToProgram("Uniforms","UniformsVertex");
+  shader->attachShaderToProgram("Uniforms","UniformsFragment");
+  shader->linkProgramObject("Uniforms");
+  shader->use("Uniforms");
+
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+  return result;
+}